@@ -231,6 +231,31 @@ public:
    */
   static bool transformPoint(geometry_msgs::PointStamped& point, const std::string& frame, const tf2_ros::Buffer& tf_buffer, float duration, int tries = 1);
 
+  /**
+   * @brief Finds the point that pure pursuit steers towards: the point on a path a set distance further along it than
+   *        the robot. The robot is projected onto the segment it was on last time, and moves on to the next segment
+   *        once it is past the end of this one.
+   * 
+   * @param path                The waypoints of the path, in driving order and in the same frame as position
+   * @param position            The robot position
+   * @param lookahead_distance  How far along the path to look ahead of the robot, in meters
+   * @param segment             The segment (from path[segment] to path[segment + 1]) the robot was on. Updated to the
+   *                            segment it is on now, it only ever moves forwards.
+   * @param fraction            Set to how far along that segment the robot is, from 0 to 1
+   * @return geometry_msgs::Point The lookahead point, or the last waypoint once it is closer than lookahead_distance
+   */
+  static geometry_msgs::Point getLookaheadPoint(const std::vector<geometry_msgs::PoseStamped>& path, const geometry_msgs::Point& position, double lookahead_distance, int& segment, double& fraction);
+
+  /**
+   * @brief Curvature of the circular arc from the robot through a target point, tangent to the robot's heading
+   *        (the pure pursuit steering law).
+   * 
+   * @param robot_pose  The current robot pose
+   * @param target      The point to steer towards, in the same frame as robot_pose
+   * @return double     The curvature in 1/m, positive for a turn to the left (counter-clockwise) and 0 for straight ahead
+   */
+  static double getPurePursuitCurvature(const geometry_msgs::PoseStamped& robot_pose, const geometry_msgs::Point& target);
+
   /**
    * @brief Returns the radius formed by three points formed in the X-Y plane
    * 
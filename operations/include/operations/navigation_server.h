@@ -4,21 +4,30 @@
 #include <std_msgs/Float64.h>
 #include <sensor_msgs/Imu.h>
 #include <operations/TrajectoryWithVelocities.h>
+#include <operations/WheelCommand.h>
+#include <planning/trajectory.h>
 #include <nav_msgs/Odometry.h>
 #include <srcp2_msgs/BrakeRoverSrv.h>
 
 #include <operations/navigation_algorithm.h>
+#include <utils/pose_store.h>
 #include <operations/NavigationAction.h> // Note: "Action" is appended
 #include <actionlib/server/simple_action_server.h>
 
+#include <algorithm>
 #include <math.h>
 #include <string>
 
 #include <tf2_ros/transform_listener.h>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.h>
 
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
 
+#include <ros/callback_queue.h>
+#include <boost/make_shared.hpp>
+
 // Create a type called `Server` that is a SimpleActionServer that uses the NavigationAction type
 typedef actionlib::SimpleActionServer<operations::NavigationAction> Server;
 
@@ -41,20 +50,43 @@ private:
     const float ANGLE_EPSILON = 0.2;
     const float SPIRAL_SPEED = 0.5;
 
-    // How far the robot should travel before it asks for a new trajectory, in meters. Used in automaticDriving.
+    // How far the robot should travel before it asks for a new trajectory, in meters. Used in automaticDriving and pursuitDriving.
     const double TRAJECTORY_RESET_DIST = 5;
 
+    // Size of a cell of the robot centered local map the planner searches, in meters. Matches obstacle_localmaps.
+    const double LOCAL_MAP_RESOLUTION = 0.05;
+    // How long to wait for the planner to come up before falling back to driving straight to the goal, in seconds
+    const double PLANNER_TIMEOUT = 1.0;
+
+    // Pure pursuit (pursuitDriving): how far along the trajectory to steer towards, in meters
+    const float LOOKAHEAD_DIST = 1.5;
+    // Tightest turn radius to steer into, in meters. Has to stay outside the wheels.
+    const float MIN_TURN_RADIUS = 1.0;
+    // Turns wider than this are driven straight, in meters
+    const float STRAIGHT_TURN_RADIUS = 50;
+    // If the lookahead point is further than this off the nose, the robot turns in place towards it first, in radians
+    const float MAX_PURSUIT_HEADING = M_PI / 2;
+    // Slowest speed to track at, so a zero speed at the end of the trajectory does not stall the robot short of it
+    const float MIN_PURSUIT_SPEED = 0.1;
+
     std::string robot_name_;
 
     // The actionlib server
     Server *server_;
 
-    // Rate limiter
-    ros::Rate *update_rate_;
+    // How long the control loops wait for odometry before checking for interruptions again, in seconds
+    const double ODOM_WAIT_TIMEOUT = 0.1;
+
+    // Number of wheels, and the size of each array in a WheelCommand
+    static const int WHEELS = 4;
 
-    // Publishers for each wheel velocity and steering controller
-    ros::Publisher front_left_vel_pub_, front_right_vel_pub_, back_left_vel_pub_, back_right_vel_pub_;
-    ros::Publisher front_left_steer_pub_, front_right_steer_pub_, back_left_steer_pub_, back_right_steer_pub_;
+    // Publishes the steering angles and velocities of all wheels together, see wheel_command_relay
+    ros::Publisher wheel_command_pub_;
+
+    // The last command sent. steerRobot and moveRobotWheels each change half of it, and the preempt callback steers
+    // from another thread, so it is only touched under the mutex.
+    operations::WheelCommand wheel_command_;
+    std::mutex wheel_command_mutex_;
 
     // Debug publisher. Can be used to publish any PoseStamped. Used to visualize in RViz
     ros::Publisher waypoint_pub_;
@@ -62,24 +94,36 @@ private:
     // Used to get the current robot pose
     ros::Subscriber update_current_robot_pose_;
 
+    // Odometry is handled on its own queue and thread, so the control loops in the action's execute thread can wait
+    // for it without spinning the global queue themselves
+    ros::CallbackQueue odom_queue_;
+    ros::AsyncSpinner *odom_spinner_;
+
     ros::ServiceClient brake_client_;
 
+    // Asks the planner for a trajectory through the local map, see sendGoalToPlanner
+    ros::ServiceClient planner_client_;
+
     // If true, use crab drive. If false, use point-and-go drive. Set in the constructor from a parameter
     bool CRAB_DRIVE_;
 
-    // Declare robot pose to be used globally
-    geometry_msgs::PoseStamped robot_pose_;
-    std::mutex pose_mutex_;
+    // Declare robot pose to be used globally. Written by the odometry callback, read without locks from anywhere.
+    PoseStore robot_pose_;
+
+    // Wakes up the control loops waiting for the next odometry message. The mutex is only for waiting, reading the
+    // pose doesn't need it.
+    std::mutex pose_wait_mutex_;
+    std::condition_variable pose_received_;
 
     // Used to perform transforms between the robot and map reference frames
     tf2_ros::Buffer buffer_;
     tf2_ros::TransformListener *listener_;
 
-    // Whether we are currently manually driving, or automatically following a trajectory
-    bool manual_driving_ = false;
+    // Whether we are currently manually driving, or automatically following a trajectory. Set from the preempt callback.
+    std::atomic<bool> manual_driving_{false};
 
     // Continue tracing spiral until this variable is true
-    bool spiral_motion_continue_ = true;
+    std::atomic<bool> spiral_motion_continue_{true};
 
     // How much distance the robot has traveled since the last planner call. Compared against TRAJECTORY_RESET_DIST.
     double total_distance_traveled_ = 0;
@@ -88,15 +132,9 @@ private:
     bool get_new_trajectory_ = false;
 
     /**
-     * @brief Initialize the publishers for wheel speeds
-     * 
-     */
-    void initVelocityPublisher(ros::NodeHandle &nh, const std::string &robot_name);
-
-    /**
-    * @brief Initialise the publishers for wheel steering angles
+    * @brief Initialise the publisher for the wheel commands
     */
-    void initSteerPublisher(ros::NodeHandle &nh, const std::string &robot_name);
+    void initWheelCommandPublisher(ros::NodeHandle &nh, const std::string &robot_name);
 
     /**
     * @brief Initialise publihers used to debug
@@ -116,7 +154,19 @@ private:
     */
     void updateRobotPose(const nav_msgs::Odometry::ConstPtr &msg);
 
-    geometry_msgs::PoseStamped *getRobotPose();
+    geometry_msgs::PoseStamped getRobotPose();
+
+    /**
+    * @brief Waits until an odometry message newer than the last one seen arrives. The control loops run once per
+    *        message this way, instead of polling at a fixed rate.
+    * 
+    * @param pose_count The number of messages seen so far, updated when a new one arrives. Start from 0 to take the
+    *                   latest pose straight away if there is one.
+    * @param pose Set to the new pose
+    * @return true A new pose arrived
+    * @return false Timed out after ODOM_WAIT_TIMEOUT, or the goal was interrupted
+    */
+    bool waitForRobotPose(uint64_t &pose_count, geometry_msgs::PoseStamped &pose);
 
     /**
     * @brief Initialize the subscriber for robot position
@@ -125,12 +175,9 @@ private:
     void initSubscribers(ros::NodeHandle &nh, std::string &robot_name);
 
     /**
-    * @brief Publish the message over rostopic
-    * 
-    * @param publisher   publisher over which message will be published
-    * @param data        data that will be published over the publisher
+    * @brief Publish the current wheel command. Call with wheel_command_mutex_ held.
     */
-    void publishMessage(ros::Publisher &publisher, float data);
+    void publishWheelCommand();
 
     /**
     * @brief Steers the robot wheels for the angles
@@ -175,12 +222,31 @@ private:
     void moveRobotWheels(const double velocity);
 
     /**
-     * @brief Sends a goal received from the Robot SM to the planner. Receives and returns the trajectory
+    * @brief Steers the wheels and sets their velocities in a single command, so they are applied together
+    * 
+    * @param angles Steering angles, in the same order as steerRobot
+    * @param velocity Wheel velocities, in the same order as moveRobotWheels
+    */
+    void driveRobot(const std::vector<double> &angles, const std::vector<double> &velocity);
+
+    /**
+    * @brief Steers all wheels to one angle and sets them all to one velocity in a single command
+    * 
+    * @param angle Steering angle for the wheels
+    * @param velocity Velocity for the wheels
+    */
+    void driveRobot(const double angle, const double velocity);
+
+    /**
+     * @brief Sends a goal received from the Robot SM to the planner. Receives and returns the trajectory, in the order
+     *        it is driven. If the planner can't be reached or finds no path, the trajectory is just the goal.
      * 
      * @param goal The end goal for the robot to go to
-     * @return operations::TrajectoryWithVelocities* 
+     * @param continuous True if the trajectory is followed without stopping (followTrajectory), to get it with rounded
+     *                   corners and evenly spaced waypoints. Otherwise only its corners are returned.
+     * @return operations::TrajectoryWithVelocities The trajectory, with every waypoint in the map frame
      */
-    operations::TrajectoryWithVelocities sendGoalToPlanner(const geometry_msgs::PoseStamped &goal);
+    operations::TrajectoryWithVelocities sendGoalToPlanner(const geometry_msgs::PoseStamped &goal, bool continuous);
 
     /**
      * @brief Used to transform each pose in the trajectory into the map frame.
@@ -197,6 +263,14 @@ private:
      */
     void brakeRobot(bool brake);
 
+    /**
+     * @brief Sets or releases the manual brake without stopping the wheels first like brakeRobot does. Used to keep
+     *        driving from one trajectory into the next.
+     * 
+     * @param brake True if the brake should be set, false, if it should be released.
+     */
+    void setBrake(bool brake);
+
     /**
      * @brief Rotates the wheels to point at a target pose.
      * 
@@ -224,6 +298,25 @@ private:
      */
     bool driveDistance(double delta_distance);
 
+    /**
+     * @brief Tracks a trajectory with pure pursuit, steering and setting the speed continuously without stopping at
+     *        the waypoints. Each cycle steers along the arc to the point LOOKAHEAD_DIST further along the trajectory
+     *        and drives at the trajectory's speed at the robot's position.
+     * 
+     * @param trajectory The trajectory to follow, in the map frame. The robot starts from where it is.
+     * @return true Reached the end of the trajectory, or traveled TRAJECTORY_RESET_DIST and set get_new_trajectory_.
+     * @return false Interrupted by manual driving.
+     */
+    bool followTrajectory(const operations::TrajectoryWithVelocities &trajectory);
+
+    /**
+     * @brief Turns the robot to the orientation of the goal once it is there, and sets the result of the action.
+     * 
+     * @param final_pose The goal pose, in the map frame.
+     * @param action_server The action server that this function is operating on.
+     */
+    void finishGoal(geometry_msgs::PoseStamped final_pose, Server *action_server);
+
     /**
      * @brief Drives to a goal, based on waypoints generated by the local planner. NAV_TYPE::GOAL
      * 
@@ -232,6 +325,15 @@ private:
      */
     void automaticDriving(const operations::NavigationGoalConstPtr &goal, Server *action_server);
 
+    /**
+     * @brief Drives to a goal like automaticDriving, but follows the whole trajectory continuously with
+     *        followTrajectory instead of stopping to turn at every waypoint. NAV_TYPE::PURSUIT
+     * 
+     * @param goal The goal of the action. Uses the PoseStamped member to pass to the planner.
+     * @param action_server The action server that this function is operating on.
+     */
+    void pursuitDriving(const operations::NavigationGoalConstPtr &goal, Server *action_server);
+
     /**
      * @brief Manually drive forwards or backwards. NAV_TYPE::MANUAL
      * 
@@ -58,7 +58,7 @@ const point A(480, 380), B(410, 320);
  * @param P - Point of interest
  * @return bool - True if the object is in left of the line 
  */
-bool directionOfPoint(point first, point second, point P)
+inline bool directionOfPoint(point first, point second, point P)
 {
     // subtracting co-ordinates of point A from
     // B and P, to make A as origin
@@ -84,7 +84,7 @@ bool directionOfPoint(point first, point second, point P)
  * @param obstacles - Vector having objects
  * @return direction magnitude for crab walk
  */
-float checkObstacle(const std::vector<perception::Object>& obstacles)
+inline float checkObstacle(const std::vector<perception::Object>& obstacles)
 { 
     float result = 0.0f;
 
@@ -14,6 +14,9 @@ Command Line Arguments Required:
 #include <string>
 #include <mutex>
 #include <ros/ros.h>
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <boost/make_shared.hpp>
 #include <std_msgs/Float64.h>
 #include <sensor_msgs/Imu.h>
 #include <geometry_msgs/PointStamped.h>
@@ -31,6 +34,10 @@ typedef actionlib::SimpleActionClient<operations::NavigationVisionAction> Vision
 typedef actionlib::SimpleActionServer<operations::ParkRobotAction> Server;
 typedef actionlib::SimpleActionClient<operations::NavigationAction> Client;
 
+// The state of the server is kept in this file, so only one can be loaded per nodelet manager (one per robot)
+namespace
+{
+
 enum OBJECT_PARKER
 {
     HOPPER = true,
@@ -39,6 +46,9 @@ enum OBJECT_PARKER
 
 Client *g_nav_client;
 VisionClient *g_navigation_vision_client;
+Server *g_server;
+ros::NodeHandle *g_nh;
+ros::Subscriber g_hauler_objects_sub;
 operations::NavigationGoal g_nav_goal;
 
 const float HOPPER_FORWARD_VELOCITY = 0.3, EXC_FORWARD_VELOCITY = 0.2;
@@ -59,7 +69,9 @@ const float PROCESSING_PLANT_RADIUS = 1.8, INIT_VALUE = -100.00;
 int g_times_reached = 0, g_center_image_x = 320, g_target_height = 385;
 
 bool g_execute_called = false;
-perception::ObjectArray g_hauler_objects, g_excavator_objects;
+// Swapped whole by the callbacks, so readers only hold the locks to copy the pointers
+perception::ObjectArray::ConstPtr g_hauler_objects = boost::make_shared<perception::ObjectArray>();
+perception::ObjectArray::ConstPtr g_excavator_objects = boost::make_shared<perception::ObjectArray>();
 std::string g_robot_name;
 
 /**
@@ -67,7 +79,7 @@ std::string g_robot_name;
  * 
  * @param objs 
  */
-void haulerObjectsCallback(const perception::ObjectArray &objs)
+void haulerObjectsCallback(const perception::ObjectArray::ConstPtr &objs)
 {
     const std::lock_guard<std::mutex> lock(g_hauler_objects_mutex);
     g_hauler_message_received = true;
@@ -79,7 +91,7 @@ void haulerObjectsCallback(const perception::ObjectArray &objs)
  * 
  * @param objs 
  */
-void excavatorObjectsCallback(const perception::ObjectArray &objs)
+void excavatorObjectsCallback(const perception::ObjectArray::ConstPtr &objs)
 {
     const std::lock_guard<std::mutex> lock(g_excavator_objects_mutex);
     g_excavator_message_received = true;
@@ -130,17 +142,20 @@ void centerFurnace()
 void parkWrtHopper()
 {
     //parsing the objects message to extract the necessary information of required object
-    const std::lock_guard<std::mutex> lock(g_hauler_objects_mutex);
-    perception::ObjectArray objects = g_hauler_objects;
+    perception::ObjectArray::ConstPtr objects;
+    {
+        const std::lock_guard<std::mutex> lock(g_hauler_objects_mutex);
+        objects = g_hauler_objects;
+    }
 
-    int n = objects.number_of_objects;
+    int n = objects->number_of_objects;
     float processing_plant_z = INIT_VALUE, hopper_x = INIT_VALUE, hopper_z = INIT_VALUE, hopper_height = INIT_VALUE, furnace_z = INIT_VALUE, furnace_x = INIT_VALUE, furnace_size_x = INIT_VALUE;
     float furnace_center_y = INIT_VALUE, processing_plant_x = INIT_VALUE;
     static bool centering = true;
 
     for (int i = 0; i < n; i++)
     {
-        perception::Object object = objects.obj.at(i);
+        perception::Object object = objects->obj.at(i);
 
         if (object.label == COMMON_NAMES::OBJECT_DETECTION_HOPPER_CLASS)
         {
@@ -271,7 +286,7 @@ void findExcavator()
  * @param hauler_objects 
  * @param exc_objects 
  */
-void getObjects(perception::ObjectArray &hauler_objects, perception::ObjectArray &exc_objects)
+void getObjects(perception::ObjectArray::ConstPtr &hauler_objects, perception::ObjectArray::ConstPtr &exc_objects)
 {
     const std::lock_guard<std::mutex> lock_hauler(g_hauler_objects_mutex);
     const std::lock_guard<std::mutex> lock_excavator(g_excavator_objects_mutex);
@@ -318,8 +333,8 @@ void setRevolveDirection(float hauler_center, float exc_center, float exc_arm_ce
  */
 void parkWrtExcavator()
 {
-    perception::ObjectArray hauler_objects;
-    perception::ObjectArray exc_objects;
+    perception::ObjectArray::ConstPtr hauler_objects;
+    perception::ObjectArray::ConstPtr exc_objects;
 
     getObjects(hauler_objects, exc_objects);
 
@@ -328,9 +343,9 @@ void parkWrtExcavator()
     static bool prev_centered = false;
 
     //parsing the objects message to extract the necessary information of required hauler's objects
-    for (int i = 0; i < hauler_objects.number_of_objects; i++)
+    for (int i = 0; i < hauler_objects->number_of_objects; i++)
     {
-        perception::Object object = hauler_objects.obj.at(i);
+        perception::Object object = hauler_objects->obj.at(i);
         if (object.label == COMMON_NAMES::OBJECT_DETECTION_EXCAVATOR_CLASS)
         {
             center_exc = object.center.x;
@@ -344,9 +359,9 @@ void parkWrtExcavator()
     }
 
     //parsing the objects message to extract the necessary information of required excavator's objects
-    for (int i = 0; i < exc_objects.number_of_objects; i++)
+    for (int i = 0; i < exc_objects->number_of_objects; i++)
     {
-        perception::Object object = exc_objects.obj.at(i);
+        perception::Object object = exc_objects->obj.at(i);
         bool is_hauler = (object.label == COMMON_NAMES::OBJECT_DETECTION_HAULER_CLASS), is_scout = (object.label == COMMON_NAMES::OBJECT_DETECTION_SCOUT_CLASS), is_hauler_big_enough = (object.size_y > HAULER_HEIGHT_THRESH);
         if ((is_hauler || is_scout) && is_hauler_big_enough)
         {
@@ -460,7 +475,6 @@ void execute(const operations::ParkRobotGoalConstPtr &goal, Server *as)
 
     ROS_INFO("Got the parking goal");
 
-    ros::NodeHandle nh;
     ros::Subscriber excavator_objects_sub;
 
     if (goal->hopper_or_excavator == COMMON_NAMES::OBJECT_DETECTION_HOPPER_CLASS)
@@ -494,7 +508,7 @@ void execute(const operations::ParkRobotGoalConstPtr &goal, Server *as)
             excavator_name = goal->hopper_or_excavator;
         }
 
-        excavator_objects_sub = nh.subscribe(COMMON_NAMES::CAPRICORN_TOPIC + excavator_name + COMMON_NAMES::OBJECT_DETECTION_OBJECTS_TOPIC, 1, &excavatorObjectsCallback);
+        excavator_objects_sub = g_nh->subscribe(COMMON_NAMES::CAPRICORN_TOPIC + excavator_name + COMMON_NAMES::OBJECT_DETECTION_OBJECTS_TOPIC, 1, &excavatorObjectsCallback);
 
         // initialize all the necessary variables
         g_times_excavator = 0;
@@ -502,9 +516,9 @@ void execute(const operations::ParkRobotGoalConstPtr &goal, Server *as)
         g_revolve_direction_set = false;
     }
 
+    // The object callbacks run on the nodelet manager's threads, nothing needs spinning here
     while (ros::ok() && !g_parked && !g_cancel_called)
     {
-        ros::spinOnce();
         if (park_mode == OBJECT_PARKER::HOPPER && g_hauler_message_received)
             parkWrtHopper();
         else if (g_hauler_message_received && g_excavator_message_received)
@@ -529,37 +543,55 @@ void execute(const operations::ParkRobotGoalConstPtr &goal, Server *as)
     as->setSucceeded(result);
     g_execute_called = false;
 
-    g_hauler_objects = perception::ObjectArray();
-    g_excavator_objects = perception::ObjectArray();
+    const std::lock_guard<std::mutex> lock_hauler(g_hauler_objects_mutex);
+    const std::lock_guard<std::mutex> lock_excavator(g_excavator_objects_mutex);
+    g_hauler_objects = boost::make_shared<perception::ObjectArray>();
+    g_excavator_objects = boost::make_shared<perception::ObjectArray>();
 }
 
-int main(int argc, char *argv[])
+} // namespace
+
+/**
+ * @brief Runs the park hauler server in the navigation nodelet manager of its robot, so its goals reach the
+ *        navigation and navigation vision servers without serialization. Takes the robot name as its only argument.
+ */
+class ParkHaulerServerNodelet : public nodelet::Nodelet
 {
-    if (argc < 2)
+private:
+    void onInit() override
     {
-        ROS_ERROR_STREAM("This node must be launched with the robotname and target passed as a command line argument!");
-        return -1;
-    }
+        if (getMyArgv().empty())
+        {
+            NODELET_ERROR_STREAM("This nodelet must be loaded with the robotname and target passed as an argument!");
+            return;
+        }
 
-    //take in robot name as arg1, usually small_hauler_1
-    g_robot_name = argv[1];
+        //take in robot name as arg1, usually small_hauler_1
+        g_robot_name = getMyArgv()[0];
+        g_nh = &getNodeHandle();
 
-    //initialize node and node handler
-    ros::init(argc, argv, g_robot_name + COMMON_NAMES::PARK_HAULER_HOPPER_SERVER_NODE_NAME);
-    ros::NodeHandle nh;
+        //subscriber for object detection
+        g_hauler_objects_sub = g_nh->subscribe(COMMON_NAMES::CAPRICORN_TOPIC + g_robot_name + COMMON_NAMES::OBJECT_DETECTION_OBJECTS_TOPIC, 1, &haulerObjectsCallback);
 
-    //subscriber for object detection
-    ros::Subscriber hauler_objects_sub = nh.subscribe(COMMON_NAMES::CAPRICORN_TOPIC + g_robot_name + COMMON_NAMES::OBJECT_DETECTION_OBJECTS_TOPIC, 1, &haulerObjectsCallback);
+        g_nav_client = new Client(*g_nh, COMMON_NAMES::CAPRICORN_TOPIC + g_robot_name + "/" + COMMON_NAMES::NAVIGATION_ACTIONLIB, true);
+        g_navigation_vision_client = new VisionClient(*g_nh, g_robot_name + COMMON_NAMES::NAVIGATION_VISION_ACTIONLIB, true);
 
-    g_nav_client = new Client(COMMON_NAMES::CAPRICORN_TOPIC + g_robot_name + "/" + COMMON_NAMES::NAVIGATION_ACTIONLIB, true);
-    g_navigation_vision_client = new VisionClient(g_robot_name + COMMON_NAMES::NAVIGATION_VISION_ACTIONLIB, true);
+        // g_server is bound by reference, it is only set once the server is constructed
+        g_server = new Server(*g_nh, g_robot_name + COMMON_NAMES::PARK_HAULER_ACTIONLIB, boost::bind(&execute, _1, boost::ref(g_server)), false);
+        g_server->registerPreemptCallback(&cancelGoal);
+        g_server->start();
+        NODELET_INFO("Starting Park Hauler Server");
+    }
 
-    Server server(nh, g_robot_name + COMMON_NAMES::PARK_HAULER_ACTIONLIB, boost::bind(&execute, _1, &server), false);
-    server.registerPreemptCallback(&cancelGoal);
-    server.start();
-    ROS_INFO("Starting Park Hauler Server");
-    ros::spin();
+public:
+    ~ParkHaulerServerNodelet()
+    {
+        // The server waits for a running goal to finish, so the clients it uses go last
+        delete g_server;
+        g_hauler_objects_sub.shutdown();
+        delete g_navigation_vision_client;
+        delete g_nav_client;
+    }
+};
 
-    ROS_INFO("Exiting");
-    return 0;
-}
\ No newline at end of file
+PLUGINLIB_EXPORT_CLASS(ParkHaulerServerNodelet, nodelet::Nodelet)
@@ -1,5 +1,7 @@
 #include <operations/navigation_algorithm.h>
 
+#include <algorithm>
+
 NavigationAlgo::NavigationAlgo(/* args */)
 {
 }
@@ -290,6 +292,69 @@ bool NavigationAlgo::transformPoint(geometry_msgs::PointStamped& point, const st
   return ret;
 }
 
+geometry_msgs::Point NavigationAlgo::getLookaheadPoint(const std::vector<geometry_msgs::PoseStamped>& path, const geometry_msgs::Point& position, double lookahead_distance, int& segment, double& fraction)
+{
+  fraction = 1;
+  int last = path.size() - 1;
+  if (last <= 0)
+  {
+    segment = 0;
+    return last == 0 ? path[0].pose.position : position;
+  }
+  segment = std::max(0, std::min(segment, last - 1));
+
+  // Project the robot onto its segment, moving on while it is past the end of it
+  double length = 0;
+  while (true)
+  {
+    const geometry_msgs::Point &a = path[segment].pose.position, &b = path[segment + 1].pose.position;
+    length = std::hypot(b.x - a.x, b.y - a.y);
+    fraction = length > 0 ? ((position.x - a.x) * (b.x - a.x) + (position.y - a.y) * (b.y - a.y)) / (length * length) : 1;
+    fraction = std::max(0.0, std::min(1.0, fraction));
+
+    if (fraction < 1 || segment == last - 1)
+      break;
+    ++segment;
+  }
+
+  // Walk the rest of the way along the path from the projection
+  double remaining = lookahead_distance + fraction * length;
+  for (int i = segment; i < last; ++i)
+  {
+    const geometry_msgs::Point &a = path[i].pose.position, &b = path[i + 1].pose.position;
+    double segment_length = std::hypot(b.x - a.x, b.y - a.y);
+    if (remaining < segment_length)
+    {
+      geometry_msgs::Point point;
+      point.x = a.x + (b.x - a.x) * remaining / segment_length;
+      point.y = a.y + (b.y - a.y) * remaining / segment_length;
+      point.z = a.z;
+      return point;
+    }
+    remaining -= segment_length;
+  }
+
+  return path[last].pose.position;
+}
+
+double NavigationAlgo::getPurePursuitCurvature(const geometry_msgs::PoseStamped& robot_pose, const geometry_msgs::Point& target)
+{
+  double yaw = fromQuatToEuler(robot_pose)[2];
+  double delta_x = target.x - robot_pose.pose.position.x;
+  double delta_y = target.y - robot_pose.pose.position.y;
+
+  // The target in the robot's frame, x forwards and y to the left
+  double forward = cos(yaw) * delta_x + sin(yaw) * delta_y;
+  double left = -sin(yaw) * delta_x + cos(yaw) * delta_y;
+
+  double distance_squared = forward * forward + left * left;
+  if (distance_squared == 0)
+    return 0;
+
+  // The arc through the robot and the target, tangent to the heading, has its center on the robot's y axis
+  return 2 * left / distance_squared;
+}
+
 /**
  * @brief 
  *          http://www.ambrsoft.com/TrigoCalc/Circle3D.htm
@@ -22,47 +22,34 @@ NavigationServer::NavigationServer(ros::NodeHandle& nh, std::string robot_name)
 
 	listener_ = new tf2_ros::TransformListener(buffer_);
 
-	// Initialize the rate limiter to 100 HZ
-	update_rate_ = new ros::Rate(100);
+	// Odometry callbacks run on their own thread from here on
+	odom_spinner_ = new ros::AsyncSpinner(1, &odom_queue_);
+	odom_spinner_->start();
 
-	moveRobotWheels(0);
-	steerRobot(0);
+	driveRobot(0, 0);
 }
 
 NavigationServer::~NavigationServer()
 {
+	// Stop the odometry callbacks before anything they use goes away
+	odom_spinner_->stop();
+	delete odom_spinner_;
+
 	// Cleanup the TransformListener
 	delete listener_;
 
 	// Cleanup the actionlib server
 	delete server_;
-
-	// Cleanup the rate limiter
-	delete update_rate_;
 }
 
 /**
- * @brief Initialise the publishers for wheel velocities
+ * @brief Initialise the publisher for the wheel commands
  * 
  */
-void NavigationServer::initVelocityPublisher(ros::NodeHandle& nh, const std::string& robot_name)
+void NavigationServer::initWheelCommandPublisher(ros::NodeHandle& nh, const std::string& robot_name)
 {
-	front_left_vel_pub_ = nh.advertise<std_msgs::Float64>("/" + robot_name + FRONT_LEFT_WHEEL + VELOCITY_TOPIC, 1000);
-	front_right_vel_pub_ = nh.advertise<std_msgs::Float64>("/" + robot_name + FRONT_RIGHT_WHEEL + VELOCITY_TOPIC, 1000);
-	back_left_vel_pub_ = nh.advertise<std_msgs::Float64>("/" + robot_name + BACK_LEFT_WHEEL + VELOCITY_TOPIC, 1000);
-	back_right_vel_pub_ = nh.advertise<std_msgs::Float64>("/" + robot_name + BACK_RIGHT_WHEEL + VELOCITY_TOPIC, 1000);
-}
-
-/**
- * @brief Initialise the publishers for wheel steering angles
- * 
- */
-void NavigationServer::initSteerPublisher(ros::NodeHandle& nh, const std::string& robot_name)
-{
-	front_left_steer_pub_ = nh.advertise<std_msgs::Float64>("/" + robot_name + FRONT_LEFT_WHEEL + STEERING_TOPIC, 1000);
-	front_right_steer_pub_ = nh.advertise<std_msgs::Float64>("/" + robot_name + FRONT_RIGHT_WHEEL + STEERING_TOPIC, 1000);
-	back_left_steer_pub_ = nh.advertise<std_msgs::Float64>("/" + robot_name + BACK_LEFT_WHEEL + STEERING_TOPIC, 1000);
-	back_right_steer_pub_ = nh.advertise<std_msgs::Float64>("/" + robot_name + BACK_RIGHT_WHEEL + STEERING_TOPIC, 1000);
+	// Every message holds the whole command, so only the latest one is worth sending
+	wheel_command_pub_ = nh.advertise<operations::WheelCommand>(CAPRICORN_TOPIC + robot_name + WHEEL_COMMAND_TOPIC, 1);
 }
 
 /**
@@ -80,8 +67,7 @@ void NavigationServer::initDebugPublishers(ros::NodeHandle& nh, const std::strin
  */
 void NavigationServer::initPublishers(ros::NodeHandle& nh, const std::string& robot_name)
 {
-	initVelocityPublisher(nh, robot_name);
-	initSteerPublisher(nh, robot_name);
+	initWheelCommandPublisher(nh, robot_name);
 	initDebugPublishers(nh, robot_name);
 }
 
@@ -92,16 +78,35 @@ void NavigationServer::initPublishers(ros::NodeHandle& nh, const std::string& ro
  */
 void NavigationServer::updateRobotPose(const nav_msgs::Odometry::ConstPtr& msg)
 {
-	std::lock_guard<std::mutex> pose_lock(pose_mutex_);
-	robot_pose_.header = msg->header;
-	robot_pose_.pose = msg->pose.pose;
-	return;
+	robot_pose_.set(*msg);
+
+	// Taking the lock makes sure a loop that just found no new pose is already waiting, so it can't miss this
+	{
+		std::lock_guard<std::mutex> wait_lock(pose_wait_mutex_);
+	}
+	pose_received_.notify_all();
+}
+
+geometry_msgs::PoseStamped NavigationServer::getRobotPose()
+{
+	return robot_pose_.get();
 }
 
-geometry_msgs::PoseStamped* NavigationServer::getRobotPose()
+bool NavigationServer::waitForRobotPose(uint64_t &pose_count, geometry_msgs::PoseStamped &pose)
 {
-	std::lock_guard<std::mutex> pose_lock(pose_mutex_);
-	return &robot_pose_;
+	std::unique_lock<std::mutex> wait_lock(pose_wait_mutex_);
+
+	// cancelGoal also wakes us up, so interruptions are handled without waiting for odometry
+	pose_received_.wait_for(wait_lock, std::chrono::duration<double>(ODOM_WAIT_TIMEOUT),
+							[&]() { return robot_pose_.count() != pose_count || manual_driving_; });
+
+	uint64_t count = robot_pose_.count();
+	if (count == pose_count)
+		return false;
+
+	pose_count = count;
+	pose = robot_pose_.get();
+	return true;
 }
 
 /**
@@ -114,18 +119,23 @@ void NavigationServer::initSubscribers(ros::NodeHandle& nh, std::string& robot_n
 	
 	nh.getParam("cheat_odom", odom_flag);
 
+	// Subscribe on the odometry queue, see odom_spinner_
+	ros::NodeHandle odom_nh(nh);
+	odom_nh.setCallbackQueue(&odom_queue_);
+
 	if (odom_flag)
 	{
-		update_current_robot_pose_ = nh.subscribe(CAPRICORN_TOPIC + robot_name + CHEAT_ODOM_TOPIC, 1000, &NavigationServer::updateRobotPose, this);
+		update_current_robot_pose_ = odom_nh.subscribe(CAPRICORN_TOPIC + robot_name + CHEAT_ODOM_TOPIC, 1000, &NavigationServer::updateRobotPose, this);
 		ROS_INFO("Currently using cheat odom from Gazebo\n");
 	}
 	else
 	{
-		update_current_robot_pose_ = nh.subscribe("/" + robot_name + RTAB_ODOM_TOPIC, 1000, &NavigationServer::updateRobotPose, this);
+		update_current_robot_pose_ = odom_nh.subscribe("/" + robot_name + RTAB_ODOM_TOPIC, 1000, &NavigationServer::updateRobotPose, this);
 		ROS_INFO("Currently using odom from rtabmap\n");
 	}
 	
 	brake_client_ = nh.serviceClient<srcp2_msgs::BrakeRoverSrv>("/" + robot_name + BRAKE_ROVER);
+	planner_client_ = nh.serviceClient<planning::trajectory>(CAPRICORN_TOPIC + robot_name + "/" + TRAJECTORY_SERVICE);
 }
 
 /*********************************************************************/
@@ -133,17 +143,13 @@ void NavigationServer::initSubscribers(ros::NodeHandle& nh, std::string& robot_n
 /*********************************************************************/
 
 /**
- * @brief Publish the message over rostopic
+ * @brief Publish the current wheel command. Call with wheel_command_mutex_ held.
  * 
- * @param publisher   publisher over which message will be published
- * @param data        data that will be published over the publisher
  */
-void NavigationServer::publishMessage(ros::Publisher& publisher, float data)
+void NavigationServer::publishWheelCommand()
 {
-	std_msgs::Float64 pub_data;
-	pub_data.data = data;
-
-	publisher.publish(pub_data);
+	// Published as a new shared pointer, so a relay in the same nodelet manager gets it without serialization
+	wheel_command_pub_.publish(boost::make_shared<operations::WheelCommand>(wheel_command_));
 }
 
 /**
@@ -160,10 +166,14 @@ void NavigationServer::publishMessage(ros::Publisher& publisher, float data)
  */
 void NavigationServer::steerRobot(const std::vector<double>& angles)
 {
-	publishMessage(front_left_steer_pub_, angles.at(0));
-	publishMessage(front_right_steer_pub_, angles.at(1));
-	publishMessage(back_right_steer_pub_, angles.at(2));
-	publishMessage(back_left_steer_pub_, angles.at(3));
+	std::lock_guard<std::mutex> command_lock(wheel_command_mutex_);
+
+	for(int i = 0; i < WHEELS; i++)
+	{
+		wheel_command_.steering[i] = angles.at(i);
+	}
+
+	publishWheelCommand();
 }
 
 /**
@@ -173,10 +183,7 @@ void NavigationServer::steerRobot(const std::vector<double>& angles)
  */
 void NavigationServer::steerRobot(const double angle)
 {
-	publishMessage(front_left_steer_pub_, angle);
-	publishMessage(front_right_steer_pub_, angle);
-	publishMessage(back_right_steer_pub_, angle);
-	publishMessage(back_left_steer_pub_, angle);
+	steerRobot(std::vector<double>(WHEELS, angle));
 }
 
 /**
@@ -193,17 +200,14 @@ void NavigationServer::steerRobot(const double angle)
  */
 void NavigationServer::moveRobotWheels(const std::vector<double> velocity)
 {
-	std::vector<double> angular_vels;
+	std::lock_guard<std::mutex> command_lock(wheel_command_mutex_);
 
-	for(int i = 0; i < velocity.size(); i++)
+	for(int i = 0; i < WHEELS; i++)
 	{
-		angular_vels.push_back(NavigationAlgo::linearToAngularVelocity(velocity.at(i)));
+		wheel_command_.velocity[i] = NavigationAlgo::linearToAngularVelocity(velocity.at(i));
 	}
 
-	publishMessage(front_left_vel_pub_, angular_vels.at(0));
-	publishMessage(front_right_vel_pub_, angular_vels.at(1));
-	publishMessage(back_right_vel_pub_, angular_vels.at(2));
-	publishMessage(back_left_vel_pub_, angular_vels.at(3));
+	publishWheelCommand();
 }
 
 /**
@@ -213,29 +217,89 @@ void NavigationServer::moveRobotWheels(const std::vector<double> velocity)
  */
 void NavigationServer::moveRobotWheels(const double velocity)
 {
-	double angular_velocity = NavigationAlgo::linearToAngularVelocity(velocity);
+	moveRobotWheels(std::vector<double>(WHEELS, velocity));
+}
+
+/**
+ * @brief Steers the wheels and sets their velocities in a single command, so they are applied together
+ * 
+ * @param angles Steering angles, in the same order as steerRobot
+ * @param velocity Wheel velocities, in the same order as moveRobotWheels
+ */
+void NavigationServer::driveRobot(const std::vector<double>& angles, const std::vector<double>& velocity)
+{
+	std::lock_guard<std::mutex> command_lock(wheel_command_mutex_);
+
+	for(int i = 0; i < WHEELS; i++)
+	{
+		wheel_command_.steering[i] = angles.at(i);
+		wheel_command_.velocity[i] = NavigationAlgo::linearToAngularVelocity(velocity.at(i));
+	}
 
-	publishMessage(front_left_vel_pub_, angular_velocity);
-	publishMessage(front_right_vel_pub_, angular_velocity);
-	publishMessage(back_left_vel_pub_, angular_velocity);
-	publishMessage(back_right_vel_pub_, angular_velocity);
+	publishWheelCommand();
+}
+
+/**
+ * @brief Steers all wheels to one angle and sets them all to one velocity in a single command
+ * 
+ * @param angle Steering angle for the wheels
+ * @param velocity Velocity for the wheels
+ */
+void NavigationServer::driveRobot(const double angle, const double velocity)
+{
+	driveRobot(std::vector<double>(WHEELS, angle), std::vector<double>(WHEELS, velocity));
 }
 
 /*******************************************************************/
 /****************** P U B L I S H E R   L O G I C ******************/
 /*******************************************************************/
 
-operations::TrajectoryWithVelocities NavigationServer::sendGoalToPlanner(const geometry_msgs::PoseStamped& goal)
+operations::TrajectoryWithVelocities NavigationServer::sendGoalToPlanner(const geometry_msgs::PoseStamped& goal, bool continuous)
 {
 	// Declare a trajectory message
 	operations::TrajectoryWithVelocities traj;
 
-	// Temporary, replace with service call once the planner is complete
 	std_msgs::Float64 speed;
 	speed.data = BASE_DRIVE_SPEED;
 
-	traj.waypoints.push_back(goal);
-	traj.velocities.push_back(speed);
+	// The local map is centered on the robot and aligned with its base frame, so the planner takes the goal in that
+	// frame, in cells. Targets off the map are moved to its edge by the planner.
+	geometry_msgs::PoseStamped target = goal;
+	target.header.stamp = ros::Time(0);
+
+	planning::trajectory srv;
+	srv.request.planner = planning::trajectory::Request::ASTAR;
+	srv.request.continuous = continuous;
+
+	if (NavigationAlgo::transformPose(target, robot_name_ + ROBOT_BASE, buffer_, 0.1))
+	{
+		srv.request.targetPose.header = target.header;
+		srv.request.targetPose.pose.position.x = lround(target.pose.position.x / LOCAL_MAP_RESOLUTION);
+		srv.request.targetPose.pose.position.y = lround(target.pose.position.y / LOCAL_MAP_RESOLUTION);
+
+		if (planner_client_.waitForExistence(ros::Duration(PLANNER_TIMEOUT)) && planner_client_.call(srv))
+		{
+			// The planner lists the waypoints from the goal back to the robot, in meters from the center of the map
+			const planning::TrajectoryWithVelocities &planned = srv.response.trajectory;
+			for (int pt = planned.waypoints.size() - 1; pt >= 0; pt--)
+			{
+				geometry_msgs::PoseStamped waypoint = planned.waypoints[pt];
+				waypoint.header.frame_id = target.header.frame_id;
+				waypoint.header.stamp = ros::Time(0);
+
+				traj.waypoints.push_back(waypoint);
+				traj.velocities.push_back(pt < (int)planned.velocities.size() ? planned.velocities[pt] : speed);
+			}
+		}
+	}
+
+	// Without a planned path, drive straight to the goal
+	if (traj.waypoints.empty())
+	{
+		ROS_WARN("No trajectory from the planner, driving straight to the goal.\n");
+		traj.waypoints.push_back(goal);
+		traj.velocities.push_back(speed);
+	}
 
 	// Make sure that all trajectory waypoints are in the map frame before returning it
 	return getTrajInMapFrame(traj);
@@ -263,8 +327,13 @@ operations::TrajectoryWithVelocities NavigationServer::getTrajInMapFrame(const o
 
 void NavigationServer::brakeRobot(bool brake)
 {
-	srcp2_msgs::BrakeRoverSrv srv;
 	moveRobotWheels(0); // Its better to stop wheels from rotating if we are braking
+	setBrake(brake);
+}
+
+void NavigationServer::setBrake(bool brake)
+{
+	srcp2_msgs::BrakeRoverSrv srv;
 
 	if(brake)
 		srv.request.brake_force = 1000;
@@ -279,7 +348,7 @@ bool NavigationServer::rotateWheels(const geometry_msgs::PoseStamped& target_rob
 	brakeRobot(false);
 
 	// Calculate the change in heading between the current and target pose
-	double delta_heading = NavigationAlgo::changeInHeading(*getRobotPose(), target_robot_pose, robot_name_, buffer_);
+	double delta_heading = NavigationAlgo::changeInHeading(getRobotPose(), target_robot_pose, robot_name_, buffer_);
 	
 	ROS_INFO("Steering wheels to %frad\n", delta_heading);
 	steerRobot(delta_heading);
@@ -300,7 +369,7 @@ bool NavigationServer::rotateRobot(const geometry_msgs::PoseStamped& target_robo
 	std::vector<double> wheel_speeds_left = NavigationAlgo::getDrivingVelocitiesRadialTurn(center_of_robot, BASE_SPIN_SPEED);
 
 	// Save starting robot pose to track the change in heading
-	geometry_msgs::PoseStamped starting_pose = *getRobotPose();
+	geometry_msgs::PoseStamped starting_pose = getRobotPose();
 
 	double delta_heading = NavigationAlgo::changeInHeading(starting_pose, target_robot_pose, robot_name_, buffer_);
 	
@@ -312,9 +381,21 @@ bool NavigationServer::rotateRobot(const geometry_msgs::PoseStamped& target_robo
 	printf("Turning %frad\n", delta_heading);
 	steerRobot(wheel_angles);
 
-	// While we have not turned the desired amount
-	while (abs(NavigationAlgo::changeInHeading(starting_pose, target_robot_pose, robot_name_, buffer_)) > ANGLE_EPSILON && ros::ok())
+	// Check the heading each time new odometry arrives, until we have turned the desired amount
+	uint64_t pose_count = 0;
+	geometry_msgs::PoseStamped robot_pose;
+	while (ros::ok())
 	{
+		if(manual_driving_)
+		{
+			return false;
+		}
+
+		if (!waitForRobotPose(pose_count, robot_pose))
+			continue;
+
+		if (abs(NavigationAlgo::changeInHeading(starting_pose, target_robot_pose, robot_name_, buffer_)) <= ANGLE_EPSILON)
+			break;
 
 		// target_robot_pose in the robot's frame of reference
 		geometry_msgs::PoseStamped target_in_robot_frame = target_robot_pose;
@@ -322,13 +403,6 @@ bool NavigationServer::rotateRobot(const geometry_msgs::PoseStamped& target_robo
 		
 		waypoint_pub_.publish(target_in_robot_frame);
 
-		if(manual_driving_)
-		{
-			return false;
-		}
-
-		//printf("Heading remaining: %frad\n", abs(NavigationAlgo::changeInHeading(&starting_pose, target_robot_pose, robot_name, &buffer)));
-
 		if (delta_heading < 0)
 		{
 			// Turn clockwise	
@@ -339,12 +413,6 @@ bool NavigationServer::rotateRobot(const geometry_msgs::PoseStamped& target_robo
 			// Turn counter-clockwise
 			moveRobotWheels(wheel_speeds_left);
 		}
-
-		// Allow ROS to catch up and update our subscribers
-		ros::spinOnce();
-
-		// Slow this loop down a bit
-		update_rate_->sleep();
 	}
 
 	printf("Done rotating\n");
@@ -366,12 +434,15 @@ bool NavigationServer::driveDistance(double delta_distance)
 	ROS_INFO("Driving forwards %fm\n", delta_distance);
 
 	// Save the starting robot pose so we can track delta distance
-	geometry_msgs::PoseStamped starting_pose = *getRobotPose();
+	geometry_msgs::PoseStamped starting_pose = getRobotPose();
 
 	// Initialize the current traveled distance to 0. Used to terminate the loop, and to request a new trajectory.
 	double distance_traveled = 0;
 
-	// While we have not traveled the desired distance, keep driving.
+	uint64_t pose_count = 0;
+	geometry_msgs::PoseStamped robot_pose;
+
+	// While we have not traveled the desired distance, keep driving. The distance is checked each time new odometry arrives.
 	while (abs(distance_traveled - delta_distance) > DIST_EPSILON && ros::ok())
 	{
 		if(manual_driving_)
@@ -383,7 +454,10 @@ bool NavigationServer::driveDistance(double delta_distance)
 			return false;
 		}
 
-		distance_traveled = abs(NavigationAlgo::changeInPosition(starting_pose, *getRobotPose()));
+		if (!waitForRobotPose(pose_count, robot_pose))
+			continue;
+
+		distance_traveled = abs(NavigationAlgo::changeInPosition(starting_pose, robot_pose));
 
 		// If the current distance we've traveled plus the distance since the last reset is greater than the set constant, then
 		// we want to get a new trajectory from the planner.
@@ -403,12 +477,6 @@ bool NavigationServer::driveDistance(double delta_distance)
 
 		// Move the wheels forward at a constant speed
 		moveRobotWheels(BASE_DRIVE_SPEED);
-
-		// Allow ROS to catch up and update our subscribers
-		ros::spinOnce();
-
-		// Slow this loop down a bit
-		update_rate_->sleep();
 	}
 
 	// Update the total traveled distance with the total distance we just traveled.
@@ -438,7 +506,7 @@ void NavigationServer::automaticDriving(const operations::NavigationGoalConstPtr
 	while(get_new_trajectory_)
 	{
 		// Forward goal to local planner, and save the returned trajectory
-		operations::TrajectoryWithVelocities trajectory = sendGoalToPlanner(goal->pose);
+		operations::TrajectoryWithVelocities trajectory = sendGoalToPlanner(final_pose, false);
 
 		// We got the new trajectory, so we should reset the new trajectory flag.
 		get_new_trajectory_ = false;
@@ -510,7 +578,7 @@ void NavigationServer::automaticDriving(const operations::NavigationGoalConstPtr
 			}
 
 			//Get current pose + position from odometry
-			geometry_msgs::PoseStamped current_robot_pose = *getRobotPose();
+			geometry_msgs::PoseStamped current_robot_pose = getRobotPose();
 
 			//Calculate delta distance
 			float delta_distance = NavigationAlgo::changeInPosition(current_robot_pose, current_waypoint);
@@ -549,8 +617,12 @@ void NavigationServer::automaticDriving(const operations::NavigationGoalConstPtr
 	}
 
 	// This final logic shouldn't be run more than once, so it is outside of the get_new_trajectory_ loop.
+	finishGoal(final_pose, action_server);
+}
 
-	geometry_msgs::PoseStamped current_robot_pose = *getRobotPose();
+void NavigationServer::finishGoal(geometry_msgs::PoseStamped final_pose, Server *action_server)
+{
+	geometry_msgs::PoseStamped current_robot_pose = getRobotPose();
 
 	// The final pose is on top of the robot, we only care about orientation
 	final_pose.pose.position.x = current_robot_pose.pose.position.x;
@@ -595,12 +667,157 @@ void NavigationServer::automaticDriving(const operations::NavigationGoalConstPtr
 	printf("setSucceeded on server_\n");
 }
 
+bool NavigationServer::followTrajectory(const operations::TrajectoryWithVelocities &trajectory)
+{
+	// Only releases the brake, the wheels keep the speed the previous trajectory left them at
+	setBrake(false);
+
+	// The path starts where the robot is, so the first waypoint is approached along a line like the others
+	std::vector<geometry_msgs::PoseStamped> path;
+	path.push_back(getRobotPose());
+	path.insert(path.end(), trajectory.waypoints.begin(), trajectory.waypoints.end());
+
+	std::vector<double> speeds;
+	for (const std_msgs::Float64 &velocity : trajectory.velocities)
+		speeds.push_back(velocity.data);
+	if (speeds.size() != trajectory.waypoints.size())
+		speeds.assign(trajectory.waypoints.size(), BASE_DRIVE_SPEED);
+	if (speeds.empty())
+		return true;
+	speeds.insert(speeds.begin(), speeds.front());
+
+	geometry_msgs::PoseStamped starting_pose = path.front();
+	int segment = 0;
+	double fraction = 0;
+
+	// The controller runs once for each new odometry message
+	uint64_t pose_count = 0;
+	geometry_msgs::PoseStamped robot_pose;
+
+	while (ros::ok())
+	{
+		if(manual_driving_)
+		{
+			// Stop moving the robot, as we were interrupted.
+			moveRobotWheels(0);
+			brakeRobot(true);
+
+			return false;
+		}
+
+		if (!waitForRobotPose(pose_count, robot_pose))
+			continue;
+
+		// Done once the robot is at the last waypoint
+		if (NavigationAlgo::changeInPosition(robot_pose, path.back()) < DIST_EPSILON)
+			break;
+
+		double distance_traveled = NavigationAlgo::changeInPosition(starting_pose, robot_pose);
+		if(distance_traveled + total_distance_traveled_ > TRAJECTORY_RESET_DIST)
+		{
+			ROS_INFO("followTrajectory detected total distance > trajectory reset, setting trajectory flag.\n");
+
+			// Keep driving, the next trajectory picks up from here
+			total_distance_traveled_ = 0;
+			get_new_trajectory_ = true;
+			return true;
+		}
+
+		geometry_msgs::PoseStamped lookahead;
+		lookahead.header = path.back().header;
+		lookahead.pose.position = NavigationAlgo::getLookaheadPoint(path, robot_pose.pose.position, LOOKAHEAD_DIST, segment, fraction);
+		lookahead.pose.orientation.w = 1;
+		waypoint_pub_.publish(lookahead);
+
+		// or once it has driven past it
+		if (segment == (int)path.size() - 2 && fraction >= 1)
+			break;
+
+		// Pure pursuit can't steer towards points behind the robot, so turn in place towards them first
+		double yaw = NavigationAlgo::fromQuatToEuler(robot_pose)[2];
+		double bearing = atan2(lookahead.pose.position.y - robot_pose.pose.position.y, lookahead.pose.position.x - robot_pose.pose.position.x);
+		if (std::abs(remainder(bearing - yaw, 2 * M_PI)) > MAX_PURSUIT_HEADING)
+		{
+			ROS_INFO("Lookahead point is behind the robot, turning in place.\n");
+			lookahead.header.stamp = ros::Time(0);
+			if (!rotateRobot(lookahead))
+				return false;
+
+			setBrake(false);
+			continue;
+		}
+
+		// Speed from the trajectory at the robot's position
+		double speed = speeds[segment] + (speeds[segment + 1] - speeds[segment]) * fraction;
+		speed = std::max<double>(speed, MIN_PURSUIT_SPEED);
+
+		double curvature = NavigationAlgo::getPurePursuitCurvature(robot_pose, lookahead.pose.position);
+		if (std::abs(curvature) * STRAIGHT_TURN_RADIUS < 1)
+		{
+			driveRobot(0, speed);
+		}
+		else
+		{
+			// Center of the turn on the robot's y axis, positive to the left
+			geometry_msgs::Point center_of_rotation;
+			center_of_rotation.y = std::copysign(std::max<double>(1 / std::abs(curvature), MIN_TURN_RADIUS), curvature);
+
+			driveRobot(NavigationAlgo::getSteeringAnglesRadialTurn(center_of_rotation),
+					   NavigationAlgo::getDrivingVelocitiesRadialTurn(center_of_rotation, speed));
+		}
+	}
+
+	total_distance_traveled_ += NavigationAlgo::changeInPosition(starting_pose, getRobotPose());
+
+	// Stop moving the robot once it is at the end of the trajectory
+	driveRobot(0, 0);
+
+	return true;
+}
+
+void NavigationServer::pursuitDriving(const operations::NavigationGoalConstPtr &goal, Server *action_server)
+{
+	ROS_INFO("Beginning pure pursuit drive\n");
+
+	get_new_trajectory_ = true;
+
+	// Save the goal pose in the MAP frame, so that trajectory updates will use a goal relative to the map.
+	geometry_msgs::PoseStamped final_pose = goal->pose;
+	NavigationAlgo::transformPose(final_pose, MAP, buffer_, 0.1);
+
+	// Each new trajectory is followed on from where the last one was left, without stopping
+	while(get_new_trajectory_)
+	{
+		operations::TrajectoryWithVelocities trajectory = sendGoalToPlanner(final_pose, true);
+		get_new_trajectory_ = false;
+
+		if (!followTrajectory(trajectory))
+		{
+			operations::NavigationResult res;
+			if(manual_driving_)
+			{
+				ROS_ERROR_STREAM("Overridden by manual driving! Exiting.\n");
+				res.result = COMMON_RESULT::INTERRUPTED;
+			}
+			else
+			{
+				ROS_ERROR_STREAM("Following the trajectory did not succeed. Exiting.\n");
+				res.result = COMMON_RESULT::FAILED;
+			}
+			action_server->setSucceeded(res);
+
+			return;
+		}
+	}
+
+	finishGoal(final_pose, action_server);
+}
+
 void NavigationServer::linearDriving(const operations::NavigationGoalConstPtr &goal, Server *action_server)
 {
 	printf("Manual drive: Linear velocity\n");
 	brakeRobot(false);
-	steerRobot(goal->direction);
-	moveRobotWheels(goal->forward_velocity);
+	driveRobot(goal->direction, goal->forward_velocity);
 
 	if(0 == goal->forward_velocity)
 	{
@@ -623,8 +840,7 @@ void NavigationServer::angularDriving(const operations::NavigationGoalConstPtr &
 	std::vector<double> wheel_angles = {-M_PI/4, M_PI/4, -M_PI/4, M_PI/4};
 	std::vector<double> wheel_speeds = {-angular_velocity, angular_velocity, angular_velocity, -angular_velocity};
 
-	steerRobot(wheel_angles);
-	moveRobotWheels(wheel_speeds);
+	driveRobot(wheel_angles, wheel_speeds);
 	
 	operations::NavigationResult res;
 	res.result = COMMON_RESULT::SUCCESS;
@@ -639,8 +855,7 @@ void NavigationServer::revolveRobot(geometry_msgs::PointStamped &revolve_about,
 	std::vector<double> angles = NavigationAlgo::getSteeringAnglesRadialTurn(revolve_about.point);
 	std::vector<double> speeds = NavigationAlgo::getDrivingVelocitiesRadialTurn(revolve_about.point, forward_velocity);
 
-	steerRobot(angles);
-	moveRobotWheels(speeds);
+	driveRobot(angles, speeds);
 }
 
 void NavigationServer::revolveDriving(const operations::NavigationGoalConstPtr &goal, Server *action_server)
@@ -684,7 +899,7 @@ void NavigationServer::spiralDriving(const operations::NavigationGoalConstPtr &g
 	ROS_INFO("Starting spiral motion");
 	brakeRobot(false);
   
-	geometry_msgs::PoseStamped robot_start_pose = *getRobotPose();
+	geometry_msgs::PoseStamped robot_start_pose = getRobotPose();
 
 	// Stamp must be set to 0 for the latest transform
 	robot_start_pose.header.stamp = ros::Time(0);
@@ -695,7 +910,7 @@ void NavigationServer::spiralDriving(const operations::NavigationGoalConstPtr &g
 	double current_yaw;
 
 	geometry_msgs::PointStamped rotation_point;
-	rotation_point.header = getRobotPose()->header;
+	rotation_point.header = getRobotPose().header;
 
 	/**
 	 * @brief Continue loop until interrupted externally (through cancel goal)
@@ -774,6 +989,13 @@ void NavigationServer::execute(const operations::NavigationGoalConstPtr &goal)
 
 			break;
 
+		case NAV_TYPE::PURSUIT:
+
+			manual_driving_ = false;
+			pursuitDriving(goal, server_);
+
+			break;
+
 		case NAV_TYPE::REVOLVE:
 			manual_driving_ = true;
 			revolveDriving(goal, server_);
@@ -802,8 +1024,15 @@ void NavigationServer::execute(const operations::NavigationGoalConstPtr &goal)
 
 void NavigationServer::cancelGoal()
 {
-	manual_driving_ = true;
+	{
+		// Set under the wait lock, so a control loop about to wait for odometry can't miss the wake up below
+		std::lock_guard<std::mutex> wait_lock(pose_wait_mutex_);
+		manual_driving_ = true;
+	}
 	spiral_motion_continue_ = false;
+
+	// Wake up any control loop waiting for odometry, so it stops straight away
+	pose_received_.notify_all();
 	steerRobot(0);
 	brakeRobot(true);
 	printf("Clearing current goal, got a new one\n");
@@ -0,0 +1,32 @@
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <operations/navigation_server.h>
+
+/**
+ * @brief Runs a NavigationServer in a nodelet manager, so the clients loaded next to it send their goals without
+ *        serializing them. Takes the robot name as its only argument.
+ */
+class NavigationServerNodelet : public nodelet::Nodelet
+{
+private:
+    NavigationServer *server_ = nullptr;
+
+    void onInit() override
+    {
+        if (getMyArgv().empty())
+        {
+            NODELET_ERROR_STREAM("This nodelet must be loaded with the robotname passed as an argument!");
+            return;
+        }
+
+        server_ = new NavigationServer(getNodeHandle(), getMyArgv()[0]);
+    }
+
+public:
+    ~NavigationServerNodelet()
+    {
+        delete server_;
+    }
+};
+
+PLUGINLIB_EXPORT_CLASS(NavigationServerNodelet, nodelet::Nodelet)
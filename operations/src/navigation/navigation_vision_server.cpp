@@ -13,12 +13,16 @@
  */
 
 #include <operations/NavigationAction.h> // Note: "Action" is appended
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <boost/make_shared.hpp>
 #include <actionlib/client/simple_action_client.h>
 #include <actionlib/server/simple_action_server.h>
 #include <operations/NavigationVisionAction.h>
 #include <operations/obstacle_avoidance.h>
 #include <operations/navigation_algorithm.h>
 #include <nav_msgs/Odometry.h>
+#include <utils/pose_store.h>
 
 #define UPDATE_HZ 10
 
@@ -27,18 +31,25 @@ typedef actionlib::SimpleActionServer<operations::NavigationVisionAction> Server
 
 using namespace COMMON_NAMES;
 
+// The state of the server is kept in this file, so only one can be loaded per nodelet manager (one per robot)
+namespace
+{
+
 Client *g_client;
+Server *g_server;
+ros::Subscriber g_objects_sub, g_robot_odom_sub;
 
 operations::NavigationGoal g_nav_goal;
-perception::ObjectArray g_objects;
+// Swapped whole by the callback, so readers only hold the lock to copy the pointer
+perception::ObjectArray::ConstPtr g_objects = boost::make_shared<perception::ObjectArray>();
 
 std::string g_robot_name;
-geometry_msgs::PoseStamped g_robot_pose;
+PoseStore g_robot_pose;
 
 const int ANGLE_THRESHOLD_NARROW = 10, ANGLE_THRESHOLD_WIDE = 80, HEIGHT_IMAGE = 480, FOUND_FRAME_THRESHOLD = 3, LOST_FRAME_THRESHOLD = 5;
 const float PROPORTIONAL_ANGLE = 0.0010, ANGULAR_VELOCITY = 0.35, INIT_VALUE = -100.00, FORWARD_VELOCITY = 0.8, g_angular_vel_step_size = 0.05;
 const double NOT_AVOID_OBSTACLE_THRESHOLD = 5.0;
-std::mutex g_objects_mutex, g_cancel_goal_mutex, g_odom_mutex;
+std::mutex g_objects_mutex, g_cancel_goal_mutex;
 std::string g_desired_label;
 bool g_reached_goal = false, g_cancel_called = false, g_send_nav_goal = false, g_previous_state_is_go_to = false, g_message_received = false;
 int g_height_threshold = 400;
@@ -116,13 +127,22 @@ bool check_class()
  * 
  * @param objs 
  */
-void objectsCallback(const perception::ObjectArray &objs)
+void objectsCallback(const perception::ObjectArray::ConstPtr &objs)
 {
     const std::lock_guard<std::mutex> lock(g_objects_mutex);
     g_message_received = true;
     g_objects = objs;
 }
 
+/**
+ * @brief The latest objects message
+ */
+perception::ObjectArray::ConstPtr getObjects()
+{
+    const std::lock_guard<std::mutex> lock(g_objects_mutex);
+    return g_objects;
+}
+
 /**
  * @brief Function for centering robot wrt object
  * 
@@ -131,8 +151,7 @@ void objectsCallback(const perception::ObjectArray &objs)
  */
 bool center()
 {
-    const std::lock_guard<std::mutex> lock(g_objects_mutex);
-    perception::ObjectArray objects = g_objects;
+    perception::ObjectArray::ConstPtr objects = getObjects();
     // Initialize location and size variables
     float center_obj = INIT_VALUE, error_angle = WIDTH_IMAGE;
 
@@ -148,9 +167,9 @@ bool center()
     }
 
     // Find the desired objects
-    for (int i = 0; i < objects.number_of_objects; i++)
+    for (int i = 0; i < objects->number_of_objects; i++)
     {
-        perception::Object object = objects.obj.at(i);
+        perception::Object object = objects->obj.at(i);
         if (object.label == g_desired_label)
         {
             // Store the object's center
@@ -285,8 +304,7 @@ void undock()
  */
 void visionNavigation()
 {
-    const std::lock_guard<std::mutex> lock(g_objects_mutex);
-    perception::ObjectArray objects = g_objects;
+    perception::ObjectArray::ConstPtr objects = getObjects();
 
     static float prev_angular_velocity;
     static bool prev_centered, centered = false;
@@ -304,9 +322,9 @@ void visionNavigation()
     bool target_excavator = (g_desired_label == OBJECT_DETECTION_EXCAVATOR_CLASS);
 
     // Find the desired objects
-    for (int i = 0; i < objects.number_of_objects; i++)
+    for (int i = 0; i < objects->number_of_objects; i++)
     {
-        perception::Object object = objects.obj.at(i);
+        perception::Object object = objects->obj.at(i);
         bool object_is_furnace = (object.label == OBJECT_DETECTION_FURNACE_CLASS);
         bool object_is_excavator_arm = (object.label == OBJECT_DETECTION_EXCAVATOR_ARM_CLASS);
         if (object.label == g_desired_label)
@@ -435,18 +453,15 @@ void visionNavigation()
  */
 void goToGoalObsAvoid(const geometry_msgs::PoseStamped &goal_loc)
 {
-    const std::lock_guard<std::mutex> obj_lock(g_objects_mutex);
-    const std::lock_guard<std::mutex> odom_lock(g_odom_mutex);
-
-    perception::ObjectArray objects = g_objects;
+    perception::ObjectArray::ConstPtr objects = getObjects();
 
     std::vector<perception::Object> obstacles;
 
-    for (int i = 0; i < objects.number_of_objects; i++)
-        obstacles.push_back(objects.obj.at(i));
+    for (int i = 0; i < objects->number_of_objects; i++)
+        obstacles.push_back(objects->obj.at(i));
 
     float direction = checkObstacle(obstacles);
-    double distance = NavigationAlgo::changeInPosition(g_robot_pose, goal_loc);
+    double distance = NavigationAlgo::changeInPosition(g_robot_pose.get(), goal_loc);
 
     if (abs(direction) > 0.0 && distance > NOT_AVOID_OBSTACLE_THRESHOLD)
     {
@@ -535,7 +550,11 @@ void execute(const operations::NavigationVisionGoalConstPtr &goal, Server *as)
     while (ros::ok() && !g_reached_goal && !g_cancel_called)
     {
         if (!g_message_received)
+        {
+            // Wait for the first objects message at the loop rate instead of spinning on the CPU
+            update_rate.sleep();
             continue;
+        }
 
         switch (mode)
         {
@@ -597,34 +616,52 @@ void execute(const operations::NavigationVisionGoalConstPtr &goal, Server *as)
  */
 void odomCallback(const nav_msgs::Odometry::ConstPtr &msg)
 {
-  const std::lock_guard<std::mutex> lock(g_odom_mutex);
-  g_robot_pose.header = msg->header;
-  g_robot_pose.pose = msg->pose.pose;
+  g_robot_pose.set(*msg);
 }
 
-int main(int argc, char **argv)
+} // namespace
+
+/**
+ * @brief Runs the navigation vision server in the navigation nodelet manager of its robot, so its goals reach the
+ *        navigation server without serialization. Takes the robot name as its only argument.
+ */
+class NavigationVisionServerNodelet : public nodelet::Nodelet
 {
-    if (argc != 2 && argc != 4)
+private:
+    void onInit() override
     {
-        ROS_ERROR_STREAM("This node must be launched with the robotname passed as a command line argument!");
-        return -1;
-    }
+        if (getMyArgv().empty())
+        {
+            NODELET_ERROR_STREAM("This nodelet must be loaded with the robotname passed as an argument!");
+            return;
+        }
+
+        g_robot_name = getMyArgv()[0];
+        ros::NodeHandle &nh = getNodeHandle();
 
-    g_robot_name = argv[1];
-    ros::init(argc, argv, g_robot_name + NAVIGATION_VISION_SERVER_NODE_NAME);
-    ros::NodeHandle nh;
+        g_nav_goal.drive_mode = NAV_TYPE::MANUAL;
+        g_client = new Client(nh, CAPRICORN_TOPIC + g_robot_name + "/" + NAVIGATION_ACTIONLIB, true);
 
-    g_nav_goal.drive_mode = NAV_TYPE::MANUAL;
-    g_client = new Client(CAPRICORN_TOPIC + g_robot_name + "/" + NAVIGATION_ACTIONLIB, true);
+        g_objects_sub = nh.subscribe(CAPRICORN_TOPIC + g_robot_name + OBJECT_DETECTION_OBJECTS_TOPIC, 1, &objectsCallback);
 
-    ros::Subscriber objects_sub = nh.subscribe(CAPRICORN_TOPIC + g_robot_name + OBJECT_DETECTION_OBJECTS_TOPIC, 1, &objectsCallback);
+        g_robot_odom_sub = nh.subscribe(CAPRICORN_TOPIC + g_robot_name + CHEAT_ODOM_TOPIC, 1, &odomCallback);
 
-    ros::Subscriber robot_odom_sub = nh.subscribe(CAPRICORN_TOPIC + g_robot_name + CHEAT_ODOM_TOPIC, 1, &odomCallback);
+        // g_server is bound by reference, it is only set once the server is constructed
+        g_server = new Server(nh, g_robot_name + NAVIGATION_VISION_ACTIONLIB, boost::bind(&execute, _1, boost::ref(g_server)), false);
+        g_server->registerPreemptCallback(&cancelGoal);
+        g_server->start();
+        NODELET_INFO("Starting Navigation Vision Server");
+    }
 
-    Server server(nh, g_robot_name + NAVIGATION_VISION_ACTIONLIB, boost::bind(&execute, _1, &server), false);
-    server.registerPreemptCallback(&cancelGoal);
-    server.start();
-    ROS_INFO("Starting Navigation Vision Server");
-    ros::spin();
-    return 0;
-}
+public:
+    ~NavigationVisionServerNodelet()
+    {
+        // The server waits for a running goal to finish, so the client it uses goes last
+        delete g_server;
+        g_objects_sub.shutdown();
+        g_robot_odom_sub.shutdown();
+        delete g_client;
+    }
+};
+
+PLUGINLIB_EXPORT_CLASS(NavigationVisionServerNodelet, nodelet::Nodelet)
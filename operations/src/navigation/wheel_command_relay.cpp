@@ -0,0 +1,109 @@
+#include <ros/ros.h>
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <utils/common_names.h>
+#include <operations/WheelCommand.h>
+#include <std_msgs/Float64.h>
+
+#include <boost/bind.hpp>
+
+#define WHEELS 4
+
+using namespace COMMON_NAMES;
+
+/**
+ * @brief Splits the wheel commands of the navigation server into the steering and velocity topics of each wheel.
+ *        Loaded in the same nodelet manager as the navigation server, the commands reach it without serialization.
+ *        Takes the robot name as its only argument.
+ */
+class WheelCommandRelayNodelet : public nodelet::Nodelet
+{
+private:
+  // Simulator controller publishers, clockwise from the front left wheel like the command
+  ros::Publisher steer_pubs_[WHEELS], velocity_pubs_[WHEELS];
+
+  ros::Subscriber command_sub_;
+
+  // The last command forwarded. The simulator controllers hold their last value, so only changes are sent on.
+  operations::WheelCommand last_command_;
+  bool command_received_ = false;
+
+  void onInit() override
+  {
+    if (getMyArgv().empty())
+    {
+      NODELET_ERROR_STREAM("This nodelet must be loaded with the robotname passed as an argument!");
+      return;
+    }
+
+    std::string robot_name = getMyArgv()[0];
+    ros::NodeHandle &nh = getNodeHandle();
+
+    const std::string wheels[WHEELS] = {FRONT_LEFT_WHEEL, FRONT_RIGHT_WHEEL, BACK_RIGHT_WHEEL, BACK_LEFT_WHEEL};
+    for (int i = 0; i < WHEELS; i++)
+    {
+      steer_pubs_[i] = nh.advertise<std_msgs::Float64>("/" + robot_name + wheels[i] + STEERING_TOPIC, 1,
+                                                       boost::bind(&WheelCommandRelayNodelet::resendSteering, this, i, _1));
+      velocity_pubs_[i] = nh.advertise<std_msgs::Float64>("/" + robot_name + wheels[i] + VELOCITY_TOPIC, 1,
+                                                          boost::bind(&WheelCommandRelayNodelet::resendVelocity, this, i, _1));
+    }
+
+    command_sub_ = nh.subscribe(CAPRICORN_TOPIC + robot_name + WHEEL_COMMAND_TOPIC, 1, &WheelCommandRelayNodelet::commandCallback, this);
+  }
+
+  static void publishValue(const ros::Publisher &publisher, double value)
+  {
+    std_msgs::Float64 msg;
+    msg.data = value;
+    publisher.publish(msg);
+  }
+
+  /**
+   * @brief Forwards the values of a wheel command that changed
+   *
+   * @param command The command for all four wheels, sent by the navigation server
+   */
+  void commandCallback(const operations::WheelCommand::ConstPtr &command)
+  {
+    for (int i = 0; i < WHEELS; i++)
+    {
+      if (!command_received_ || command->steering[i] != last_command_.steering[i])
+        publishValue(steer_pubs_[i], command->steering[i]);
+
+      if (!command_received_ || command->velocity[i] != last_command_.velocity[i])
+        publishValue(velocity_pubs_[i], command->velocity[i]);
+    }
+
+    last_command_ = *command;
+    command_received_ = true;
+  }
+
+  /**
+   * @brief Sends the last value to a controller that connects after it was forwarded, since it would not be sent
+   *        again until it changes
+   *
+   * @param value The last value of the topic the controller connected to
+   * @param subscriber The controller that connected
+   */
+  void resendLastValue(double value, const ros::SingleSubscriberPublisher &subscriber)
+  {
+    if (!command_received_)
+      return;
+
+    std_msgs::Float64 msg;
+    msg.data = value;
+    subscriber.publish(msg);
+  }
+
+  void resendSteering(int wheel, const ros::SingleSubscriberPublisher &subscriber)
+  {
+    resendLastValue(last_command_.steering[wheel], subscriber);
+  }
+
+  void resendVelocity(int wheel, const ros::SingleSubscriberPublisher &subscriber)
+  {
+    resendLastValue(last_command_.velocity[wheel], subscriber);
+  }
+};
+
+PLUGINLIB_EXPORT_CLASS(WheelCommandRelayNodelet, nodelet::Nodelet)
@@ -2,6 +2,8 @@
 #include <operations/ResourceLocaliserAction.h>
 #include <actionlib/server/simple_action_server.h>
 #include <actionlib/client/simple_action_client.h>
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
 
 #include <tf2/utils.h>
 #include <tf2/LinearMath/Quaternion.h>
@@ -16,10 +18,17 @@
 // typedef for the Action Server and Client
 typedef actionlib::SimpleActionServer<operations::ResourceLocaliserAction> ResourceLocaliserServer;
 typedef actionlib::SimpleActionClient<operations::NavigationAction> NavigationClient_;
-NavigationClient_ *navigation_client_;
 
 using namespace COMMON_NAMES;
 
+// The state of the localiser is kept in this file, so only one can be loaded per nodelet manager (one per robot)
+namespace
+{
+
+NavigationClient_ *navigation_client_;
+ResourceLocaliserServer *resource_localiser_server_;
+ros::Subscriber sensor_subscriber_;
+
 double ROTATION_VELOCITY = 0.2;
 double DRIVING_VELOCITY = 0.2;
 double MAX_DETECT_DIST = 2.0;
@@ -228,6 +237,10 @@ void getBestPose()
 void localiseResource(const operations::ResourceLocaliserGoalConstPtr &localiser_goal, ResourceLocaliserServer *server)
 {
   ROS_INFO("Starting locating volatile sequence");
+
+  // Connecting here rather than when loading, which must not block the nodelet manager
+  navigation_client_->waitForServer();
+
   if (near_volatile_)
   {
     stopRobot();
@@ -266,39 +279,47 @@ void updateSensorData(const srcp2_msgs::VolSensorMsg::ConstPtr &msg)
   }
 }
 
-int main(int argc, char **argv)
+} // namespace
+
+/**
+ * @brief Runs the resource localiser in the navigation nodelet manager of its robot, so its goals reach the navigation
+ *        server without serialization. Takes the robot name as its only argument.
+ */
+class ResourceLocaliserNodelet : public nodelet::Nodelet
 {
-  // Ensure the robot name is passed in
-  if (argc != 2 && argc != 4)
+private:
+  void onInit() override
   {
-    // Displaying an error message for correct usage of the script, and returning error.
-    ROS_ERROR_STREAM("Not enough arguments! Please pass in robot name with number.");
-    return -1;
-  }
-  else
-  {
-    // Robot Name from argument
-    robot_name_ = std::string(argv[1]);
-    std::string node_name = robot_name_ + "_resource_localiser_action_server";
-    ros::init(argc, argv, node_name);
-    ros::NodeHandle nh;
-
-    ros::Subscriber subscriber = nh.subscribe("/" + robot_name_ + VOLATILE_SENSOR_TOPIC, 1000, updateSensorData);
+    // Ensure the robot name is passed in
+    if (getMyArgv().empty())
+    {
+      NODELET_ERROR_STREAM("Not enough arguments! Please pass in robot name with number.");
+      return;
+    }
 
-    ResourceLocaliserServer resource_localiser_server(nh, RESOURCE_LOCALISER_ACTIONLIB, boost::bind(&localiseResource, _1, &resource_localiser_server), false);
-    resource_localiser_server.start();
+    // Robot Name from argument
+    robot_name_ = getMyArgv()[0];
+    ros::NodeHandle &nh = getNodeHandle();
 
-    ROS_INFO("Connecting to nav server...");
+    navigation_client_ = new NavigationClient_(nh, CAPRICORN_TOPIC + robot_name_ + "/" + NAVIGATION_ACTIONLIB, true);
 
-    navigation_client_ = new NavigationClient_(CAPRICORN_TOPIC + robot_name_ + "/" + NAVIGATION_ACTIONLIB, true);
-    navigation_client_->waitForServer();
+    sensor_subscriber_ = nh.subscribe("/" + robot_name_ + VOLATILE_SENSOR_TOPIC, 1000, updateSensorData);
 
-    ROS_INFO("Connected. Waiting for a localization request.");
+    // resource_localiser_server_ is bound by reference, it is only set once the server is constructed
+    resource_localiser_server_ = new ResourceLocaliserServer(nh, RESOURCE_LOCALISER_ACTIONLIB, boost::bind(&localiseResource, _1, boost::ref(resource_localiser_server_)), false);
+    resource_localiser_server_->start();
 
-    ros::spin();
+    NODELET_INFO("Waiting for a localization request.");
+  }
 
+public:
+  ~ResourceLocaliserNodelet()
+  {
+    // The server waits for a running goal to finish, so the client it uses goes last
+    delete resource_localiser_server_;
+    sensor_subscriber_.shutdown();
     delete navigation_client_;
-
-    return 0;
   }
-}
\ No newline at end of file
+};
+
+PLUGINLIB_EXPORT_CLASS(ResourceLocaliserNodelet, nodelet::Nodelet)
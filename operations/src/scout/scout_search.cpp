@@ -8,7 +8,13 @@ NASA SPACE ROBOTICS CHALLENGE
 Command Line Arguments Required:
 1. robot_name: eg. small_scout_1, small_excavator_2
 */
+#include <atomic>
 #include <mutex>
+#include <thread>
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <boost/make_shared.hpp>
+#include <ros/callback_queue.h>
 #include <operations/NavigationAction.h>
 #include <actionlib/client/simple_action_client.h>
 #include <actionlib/server/simple_action_server.h>
@@ -19,22 +25,32 @@ Command Line Arguments Required:
 #include <nav_msgs/Odometry.h>
 #include <operations/navigation_algorithm.h>
 #include <operations/Spiral.h>
+#include <utils/pose_store.h>
 
 #define UPDATE_HZ 10
 
 typedef actionlib::SimpleActionClient<operations::NavigationAction> Client;
 
+// The state of the search is kept in this file, so only one can be loaded per nodelet manager (one per robot)
+namespace
+{
+
 Client *g_client;
 
+// The callbacks are queued here and called from the search loop between steps, like ros::spinOnce() did when this
+// was a node, so they never run while a step is using the state they change
+ros::CallbackQueue g_queue;
+std::thread g_search_thread;
+std::atomic<bool> g_stop_search{false};
+
 operations::NavigationGoal g_nav_goal;
-perception::ObjectArray g_objects;
+perception::ObjectArray::ConstPtr g_objects = boost::make_shared<perception::ObjectArray>();
 
 const float INIT_VALUE = -100.00, FORWARD_VELOCITY = 0.8;
 std::mutex g_objects_mutex;
 int g_lost_detection_times = 0, g_true_detection_times = 0, g_revolve_direction = -1;
 
-geometry_msgs::PoseStamped g_robot_pose;
-bool cb_init = false; // Used to check if the callback has been initiated yet or not
+PoseStore g_robot_pose; // Its count() tells whether the callback has been initiated yet or not
 static std::vector<geometry_msgs::PointStamped> g_spiral_points;
 
 double g_last_dist = 0.0;
@@ -52,9 +68,7 @@ bool was_driving = false;
  */
 void updateRobotPose(const nav_msgs::Odometry::ConstPtr &msg)
 {
-  g_robot_pose.header = msg->header;
-  g_robot_pose.pose = msg->pose.pose;
-  cb_init = true;
+  g_robot_pose.set(*msg);
 }
 
 /**
@@ -105,7 +119,7 @@ geometry_msgs::PointStamped getCenterOfRotation(const std::vector<geometry_msgs:
  * 
  * @param objs 
  */
-void objectsCallback(const perception::ObjectArray &objs)
+void objectsCallback(const perception::ObjectArray::ConstPtr &objs)
 {
   const std::lock_guard<std::mutex> lock(g_objects_mutex);
   g_objects = objs;
@@ -119,7 +133,7 @@ void driveSprial()
 {
   if (g_spiral_points.size() >= 3)
   {
-    double dist = NavigationAlgo::changeInPosition(g_robot_pose, g_spiral_points.at(1));
+    double dist = NavigationAlgo::changeInPosition(g_robot_pose.get(), g_spiral_points.at(1));
     bool done_driving = g_client->getState() == actionlib::SimpleClientGoalState::SUCCEEDED;
     if (g_going_to_goal && !done_driving)
     {
@@ -175,13 +189,16 @@ void driveSprial()
  */
 void spiralSearch()
 {
-  const std::lock_guard<std::mutex> lock(g_objects_mutex);
-  perception::ObjectArray objects = g_objects;
+  perception::ObjectArray::ConstPtr objects;
+  {
+    const std::lock_guard<std::mutex> lock(g_objects_mutex);
+    objects = g_objects;
+  }
 
   std::vector<perception::Object> obstacles;
 
-  for (int i = 0; i < objects.number_of_objects; i++)
-    obstacles.push_back(objects.obj.at(i));
+  for (int i = 0; i < objects->number_of_objects; i++)
+    obstacles.push_back(objects->obj.at(i));
 
   float direction = checkObstacle(obstacles);
 
@@ -209,7 +226,7 @@ void execute()
 {
   ros::Rate update_rate(UPDATE_HZ);
 
-  while (ros::ok())
+  while (ros::ok() && !g_stop_search)
   {
     if (resume_spiral)
     {
@@ -232,7 +249,7 @@ void execute()
     }
 
     update_rate.sleep();
-    ros::spinOnce();
+    g_queue.callAvailable();
   }
 }
 
@@ -251,52 +268,83 @@ bool serviceCB(operations::Spiral::Request &req,
   return true;
 }
 
-int main(int argc, char **argv)
+/**
+ * @brief Waits for the navigation server and the first pose, then runs the search. Runs on its own thread, so loading
+ *        the nodelet does not block its manager.
+ */
+void startSearch(ros::NodeHandle nh, std::string robot_name)
 {
-  if (argc != 2 && argc != 4)
+  // Waits in short steps, so unloading the nodelet is not held up by a server or pose that never comes
+  while (ros::ok() && !g_stop_search && (!g_client->waitForServer(ros::Duration(0.1)) || g_robot_pose.count() == 0))
   {
-    ROS_ERROR_STREAM("This node must be launched with the robotname passed as a command line argument!");
-    return -1;
+    ros::Duration(0.1).sleep();
+    g_queue.callAvailable();
   }
 
-  std::string robot_name(argv[1]);
-  ros::init(argc, argv, robot_name + COMMON_NAMES::SCOUT_SEARCH_NODE_NAME);
-  ros::NodeHandle nh;
+  ros::Subscriber objects_sub = nh.subscribe(COMMON_NAMES::CAPRICORN_TOPIC + robot_name + COMMON_NAMES::OBJECT_DETECTION_OBJECTS_TOPIC, 1, &objectsCallback);
 
-  bool odom_flag;
-	nh.getParam("cheat_odom", odom_flag);
+  ros::ServiceServer service = nh.advertiseService(COMMON_NAMES::SCOUT_SEARCH_SERVICE, serviceCB);
+  ROS_INFO_STREAM("Starting Searching - " << robot_name);
+  execute();
+}
 
-  ros::Subscriber odom_sub;
+} // namespace
 
-	if (odom_flag)
-	{
-		odom_sub = nh.subscribe(CAPRICORN_TOPIC + robot_name + CHEAT_ODOM_TOPIC, 1000, updateRobotPose);
-		ROS_INFO("Currently using cheat odom from Gazebo\n");
-	}
-	else
-	{
-		odom_sub = nh.subscribe("/" + robot_name + RTAB_ODOM_TOPIC, 1000, updateRobotPose);
-		ROS_INFO("Currently using odom from rtabmap\n");
-	}
+/**
+ * @brief Runs the scout search in the navigation nodelet manager of its robot, so its goals reach the navigation
+ *        server without serialization. Takes the robot name as its only argument.
+ */
+class ScoutSearchNodelet : public nodelet::Nodelet
+{
+private:
+  ros::Subscriber odom_sub_;
 
-  g_client = new Client(COMMON_NAMES::CAPRICORN_TOPIC + robot_name + "/" + COMMON_NAMES::NAVIGATION_ACTIONLIB, true);
-  g_client->waitForServer();
-  g_nav_goal.drive_mode = COMMON_NAMES::NAV_TYPE::MANUAL;
+  void onInit() override
+  {
+    if (getMyArgv().empty())
+    {
+      NODELET_ERROR_STREAM("This nodelet must be loaded with the robotname passed as an argument!");
+      return;
+    }
 
-  geometry_msgs::PointStamped zero_point;
-  zero_point.header.frame_id = MAP;
-  g_spiral_points = NavigationAlgo::getNArchimedeasSpiralPoints(zero_point, 400, 12);
+    std::string robot_name = getMyArgv()[0];
+    ros::NodeHandle nh(getNodeHandle());
+    nh.setCallbackQueue(&g_queue);
 
-  while (ros::ok() && !cb_init)
-  {
-    ros::Duration(0.1).sleep();
-    ros::spinOnce();
+    bool odom_flag = true;
+    nh.getParam("cheat_odom", odom_flag);
+
+    if (odom_flag)
+    {
+      odom_sub_ = nh.subscribe(CAPRICORN_TOPIC + robot_name + CHEAT_ODOM_TOPIC, 1000, updateRobotPose);
+      NODELET_INFO("Currently using cheat odom from Gazebo\n");
+    }
+    else
+    {
+      odom_sub_ = nh.subscribe("/" + robot_name + RTAB_ODOM_TOPIC, 1000, updateRobotPose);
+      NODELET_INFO("Currently using odom from rtabmap\n");
+    }
+
+    g_client = new Client(nh, COMMON_NAMES::CAPRICORN_TOPIC + robot_name + "/" + COMMON_NAMES::NAVIGATION_ACTIONLIB, true);
+    g_nav_goal.drive_mode = COMMON_NAMES::NAV_TYPE::MANUAL;
+
+    geometry_msgs::PointStamped zero_point;
+    zero_point.header.frame_id = MAP;
+    g_spiral_points = NavigationAlgo::getNArchimedeasSpiralPoints(zero_point, 400, 12);
+
+    g_search_thread = std::thread(startSearch, nh, robot_name);
   }
 
-  ros::Subscriber objects_sub = nh.subscribe(COMMON_NAMES::CAPRICORN_TOPIC + robot_name + COMMON_NAMES::OBJECT_DETECTION_OBJECTS_TOPIC, 1, &objectsCallback);
+public:
+  ~ScoutSearchNodelet()
+  {
+    g_stop_search = true;
+    if (g_search_thread.joinable())
+      g_search_thread.join();
 
-  ros::ServiceServer service = nh.advertiseService(COMMON_NAMES::SCOUT_SEARCH_SERVICE, serviceCB);
-  ROS_INFO_STREAM("Starting Searching - " << robot_name);
-  execute();
-  return 0;
-}
\ No newline at end of file
+    odom_sub_.shutdown();
+    delete g_client;
+  }
+};
+
+PLUGINLIB_EXPORT_CLASS(ScoutSearchNodelet, nodelet::Nodelet)
@@ -145,6 +145,48 @@ INSTANTIATE_TEST_CASE_P(
                 std::make_tuple(59.545,-74.1052,0,-15.144,-0.007,0,105.20926748266999))
 );
 
+TEST(PurePursuitTests, LooksAheadAlongThePathAndSteersOntoIt) {
+    // An L shaped path: 2m along x, then 2m along y
+    std::vector<geometry_msgs::PoseStamped> path(3);
+    path[1].pose.position.x = 2;
+    path[2].pose.position.x = 2;
+    path[2].pose.position.y = 2;
+
+    geometry_msgs::Point position;
+    position.x = 1;
+    position.y = 0.5;
+    int segment = 0;
+    double fraction = 0;
+
+    // Halfway along the first segment, the lookahead point is around the corner
+    geometry_msgs::Point lookahead = NavigationAlgo::getLookaheadPoint(path, position, 1.5, segment, fraction);
+    ASSERT_EQ(0, segment);
+    ASSERT_NEAR(0.5, fraction, 1e-9);
+    ASSERT_NEAR(2, lookahead.x, 1e-9);
+    ASSERT_NEAR(0.5, lookahead.y, 1e-9);
+
+    // Past the corner the robot moves on to the second segment, and the end of the path is closer than the lookahead
+    position.x = 2.3;
+    position.y = 1;
+    lookahead = NavigationAlgo::getLookaheadPoint(path, position, 1.5, segment, fraction);
+    ASSERT_EQ(1, segment);
+    ASSERT_NEAR(0.5, fraction, 1e-9);
+    ASSERT_NEAR(2, lookahead.x, 1e-9);
+    ASSERT_NEAR(2, lookahead.y, 1e-9);
+
+    // A robot 1m to the left of the path, facing along it, steers right onto a 1m radius arc
+    geometry_msgs::PoseStamped robot;
+    robot.pose.orientation.w = 1;
+    robot.pose.position.y = 1;
+    geometry_msgs::Point target;
+    target.x = 1;
+    ASSERT_NEAR(-1, NavigationAlgo::getPurePursuitCurvature(robot, target), 1e-9);
+
+    // Straight ahead needs no steering
+    target.y = 1;
+    ASSERT_NEAR(0, NavigationAlgo::getPurePursuitCurvature(robot, target), 1e-9);
+}
+
 // Run all the tests that were declared with TEST()
 int main(int argc, char **argv){
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <astar.h>
+#include <indexed_heap.h>
+
+#include <ros/ros.h>
+
+#include <vector>
+
+/**
+ * @brief Anytime planner (ARA*) that finds a path quickly and then improves it for as long as it is given.
+ *
+ * The search runs as A* with the heuristic inflated by epsilon, which finds a path at most epsilon times longer than
+ * the shortest one while expanding far fewer cells. Each time a search finishes its path is kept, epsilon is lowered
+ * and the search goes on from where it was, only reexpanding the cells whose cost improved. Once epsilon reaches 1 the
+ * path is the shortest one. The search can be stopped at a deadline and resumed later, so it can be spread over several
+ * calls. Moves are 8-connected like AStar.
+ * Based off Likhachev, Gordon and Thrun, "ARA*: Anytime A* with Provable Bounds on Sub-Optimality" (NIPS 2003).
+ */
+class ARAStar : public AStar
+{
+private:
+  int width_ = 0;
+  int threshold_ = 0;
+
+  int start_ = -1;
+  int goal_ = -1;
+  geometry_msgs::Point target_;
+
+  // Epsilon of the search in progress, and how much it drops after each search
+  double epsilon_ = 1;
+  double epsilon_step_ = 0;
+
+  std::vector<double> g_;
+  std::vector<int> came_from_;
+
+  // Cells expanded in the search in progress are tagged with its number
+  std::vector<uint32_t> closed_in_;
+  uint32_t search_ = 0;
+
+  // Cells whose cost improved after they were expanded, they go back in the open list for the next search
+  std::vector<int> inconsistent_;
+  std::vector<bool> is_inconsistent_;
+
+  IndexedHeap open_;
+
+  // Best path so far, and the bound it was found with
+  nav_msgs::Path path_;
+  double path_epsilon_ = INFINITY;
+  double path_cost_ = INFINITY;
+
+  bool done_ = true;
+  int expansions_ = 0;
+
+  /**
+   * @brief Key of a cell in the open list, its g-score plus the inflated heuristic
+   */
+  double key(int cell) const;
+
+  /**
+   * @brief Expands cells until the search with the current epsilon is over or the deadline passes
+   *
+   * @return Whether the search is over
+   */
+  bool improvePath(const nav_msgs::OccupancyGrid &oGrid, const ros::WallTime &deadline);
+
+  /**
+   * @brief Keeps the path found by the search that just finished
+   */
+  void publishPath(const nav_msgs::OccupancyGrid &oGrid);
+
+public:
+  /**
+   * @brief Starts a new search from the center of the grid (the robot) to the target. Nothing is expanded until
+   * improve() is called.
+   *
+   * @param oGrid The occupancy grid, ranging 0 (unoccupied) to 100 (completely blocked)
+   * @param target The target Point for the algorithm, same as AStar::findPathOccGrid
+   * @param epsilon The suboptimality bound of the first path, at least 1
+   * @param epsilonStep How much the bound drops after each path
+   * @param threshold The threshold above which we consider a node occupied. default = 50
+   */
+  void start(const nav_msgs::OccupancyGrid &oGrid, geometry_msgs::Point target, double epsilon, double epsilonStep, int threshold = 50);
+
+  /**
+   * @brief Carries on with the search until the shortest path is found or the deadline passes. The deadline is
+   * checked every few hundred expansions, so every call makes some progress.
+   *
+   * @param oGrid The same grid the search was started on
+   * @param deadline When to stop
+   * @return Whether the search is done: the path is the shortest one, or there is none
+   */
+  bool improve(const nav_msgs::OccupancyGrid &oGrid, const ros::WallTime &deadline);
+
+  /**
+   * @brief The best path found so far, in the same format as AStar::findPathOccGrid. Empty if none was found yet.
+   */
+  const nav_msgs::Path &path() const
+  {
+    return path_;
+  }
+
+  /**
+   * @brief How much longer than the shortest path path() can be, INFINITY if there is no path yet
+   */
+  double epsilon() const
+  {
+    return path_epsilon_;
+  }
+
+  /**
+   * @brief Length of path() in cells, INFINITY if there is no path yet
+   */
+  double cost() const
+  {
+    return path_cost_;
+  }
+
+  bool done() const
+  {
+    return done_;
+  }
+
+  /**
+   * @brief The target of the search, as passed to start()
+   */
+  const geometry_msgs::Point &target() const
+  {
+    return target_;
+  }
+
+  /**
+   * @brief Number of cells expanded since the search started
+   */
+  int expansions() const
+  {
+    return expansions_;
+  }
+};
@@ -6,12 +6,12 @@
 #include <nav_msgs/Path.h>
 #include <geometry_msgs/Point.h>
 #include <geometry_msgs/PoseStamped.h>
-#include <set>
-#include <unordered_map>
+#include <padded_grid.h>
+#include <search_space.h>
 
 class AStar
 {
-private:
+protected:
   /**
    * @brief Create a geometry_msgs::Point object
    * 
@@ -62,14 +62,33 @@ private:
   static geometry_msgs::PoseStamped poseStampedFromIndex(int ind, nav_msgs::OccupancyGrid const &oGrid);
 
   /**
-   * @brief Reconstructs the path from map of least costly nodes
+   * @brief Header for the paths and poses the planners return on a grid
+   * 
+   * @param oGrid The occupancy grid the path is on
+   * @return The grid's header, in the frame the planners report their paths in
+   */
+  static std_msgs::Header pathHeader(nav_msgs::OccupancyGrid const &oGrid);
+
+  /**
+   * @brief Reconstructs the path from the parents recorded during the search
    * @param current The node to start the reverse list of
    * @param last The target node
-   * @param reverse_list The list of nodes and associated closest nodes
+   * @param space The search space holding the closest node to each node
    * @param oGrid The occupancy grid (only for header and other metadata)
    * @return A Path message of the shortest path, including the current robot location and the target location.
    */
-  static nav_msgs::Path reconstructPath(int current, int last, std::unordered_map<int, int> &reverse_list, const nav_msgs::OccupancyGrid &oGrid);
+  static nav_msgs::Path reconstructPath(int current, int last, const SearchSpace &space, const nav_msgs::OccupancyGrid &oGrid);
+
+  /**
+   * @brief Same as above, for a search that ran on the padded grid
+   * @param current The node to start the reverse list of, a padded index
+   * @param last The target node, a padded index
+   * @param space The search space holding the closest node to each node
+   * @param grid The padded grid the search ran on
+   * @param oGrid The occupancy grid (only for header and other metadata)
+   * @return A Path message in the same format as above
+   */
+  static nav_msgs::Path reconstructPath(int current, int last, const SearchSpace &space, const PaddedGrid &grid, const nav_msgs::OccupancyGrid &oGrid);
 
   /**
    * @brief Gets distance between an index and a point
@@ -81,6 +100,15 @@ private:
    */
   static float distGridToPoint(int index, geometry_msgs::Point p1, int width, int height);
 
+  /**
+   * @brief Gets the grid index to plan to. Targets off the grid are moved to the closest free cell on the grid's edge.
+   * @param oGrid The occupancy grid
+   * @param target The target, in cells relative to the center of the grid
+   * @param threshold The threshold above which we consider a node occupied
+   * @return The index of the target cell
+   */
+  static int getTargetIndex(const nav_msgs::OccupancyGrid &oGrid, geometry_msgs::Point target, int threshold);
+
 public:
   /**
      * @brief Calculated the shortest path using an occupancy grid based approach.
@@ -94,4 +122,16 @@ public:
     **/
 
   static nav_msgs::Path findPathOccGrid(const nav_msgs::OccupancyGrid &oGrid, geometry_msgs::Point target, int threshold = 50);
+
+  /**
+     * @brief Same as above, but runs the search in a caller owned search space so its memory is reused between calls.
+     * 
+     * @param oGrid The occupancy grid, ranging 0 (unoccupied) to 100 (completely blocked)
+     * @param target The target Point for the algorithm.
+     * @param space The search space to run in. It is reset at the start of the search and holds the expansion count after it.
+     * @param threshold The threshold above which we consider a node occupied. default = 50
+     *
+     * @return A ROS Path message containing the points in the shortest path, including the robot's current location.
+    **/
+  static nav_msgs::Path findPathOccGrid(const nav_msgs::OccupancyGrid &oGrid, geometry_msgs::Point target, SearchSpace &space, int threshold = 50);
 };
\ No newline at end of file
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <astar.h>
+#include <thread_pool.h>
+
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Plans several robots on one map together, so they don't drive through each other (prioritized WHCA*).
+ *
+ * Time advances in steps, and a robot moves to one of the 8 neighboring cells or waits in place every step. First the
+ * shortest path of every robot is found on its own, in parallel: a Dijkstra sweep from each goal gives both the path
+ * and the heuristic used below. Then the robots are taken one at a time in priority order. A robot whose path keeps
+ * clear of the robots before it within the window keeps it, the others are planned with a space-time A* that avoids
+ * the cells reserved by the robots before them. Only the first window steps are checked, the rest of each path is the robot's own shortest path,
+ * which is fine as long as the paths are replanned before the window runs out.
+ * Based off Silver, "Cooperative Pathfinding" (AIIDE 2005).
+ */
+class CooperativePlanner : public AStar
+{
+private:
+  /**
+   * @brief Cells taken by each robot at each step, grown by the separation the robots keep
+   */
+  class ReservationTable
+  {
+  private:
+    int width_, height_, radius_;
+
+    // (step, cell) to the robot holding it
+    std::unordered_map<int64_t, int> reserved_;
+
+    // Cells around the goals of the robots that arrived, to the robot and the step it parked there from
+    std::unordered_map<int, std::pair<int, int>> parked_;
+
+  public:
+    ReservationTable(int width, int height, int radius) : width_(width), height_(height), radius_(radius)
+    {
+    }
+
+    /**
+     * @brief Reserves the cells around a robot's path for the first steps, and around its goal after it arrives
+     *
+     * @param path One cell per step, ending on the goal
+     * @param robot The robot
+     * @param steps How many steps to reserve
+     */
+    void reserve(const std::vector<int> &path, int robot, int steps);
+
+    /**
+     * @brief Whether a cell is free for a robot at a step
+     */
+    bool free(int cell, int step, int robot) const;
+  };
+
+  /**
+   * @brief Space-time A* for one robot against the reservations of the robots planned before it
+   *
+   * @param oGrid The occupancy grid
+   * @param start The robot's cell
+   * @param goal The robot's goal
+   * @param robot The robot, to skip its own reservations
+   * @param toGoal Sweep from the robot's goal, used as the heuristic and for the path past the window
+   * @param reservations The cells taken by the other robots
+   * @param window Number of steps checked against the reservations
+   * @param threshold The threshold above which we consider a node occupied
+   * @return One cell per step from the start to the goal, empty if no path keeps clear of the other robots
+   */
+  static std::vector<int> planWindow(const nav_msgs::OccupancyGrid &oGrid, int start, int goal, int robot, const SearchSpace &toGoal,
+                                     const ReservationTable &reservations, int window, int threshold);
+
+  /**
+   * @brief Follows a sweep's parents from a cell to the source of the sweep
+   *
+   * @param path Gets the cells appended, from after the cell to the source
+   */
+  static void followSweep(int cell, const SearchSpace &toGoal, std::vector<int> &path);
+
+public:
+  /**
+   * @brief Finds paths that keep the robots apart
+   *
+   * @param oGrid The occupancy grid, ranging 0 (unoccupied) to 100 (completely blocked)
+   * @param starts Grid index of each robot, in priority order
+   * @param goals Grid index of each robot's goal
+   * @param pool Thread pool that the robots' sweeps run on
+   * @param separation Robots are kept more than this many cells apart along x or y
+   * @param window Number of steps in which the robots are kept apart
+   * @param threshold The threshold above which we consider a node occupied. default = 50
+   * @return One cell per step for each robot, from its start until it reaches its goal, empty if it can't reach it.
+   * A robot that has to wait stays on the same cell for several steps. A robot that can't keep clear of the others
+   * gets its own shortest path.
+   */
+  static std::vector<std::vector<int>> planPaths(const nav_msgs::OccupancyGrid &oGrid, const std::vector<int> &starts, const std::vector<int> &goals,
+                                                 ThreadPool &pool, int separation, int window, int threshold = 50);
+};
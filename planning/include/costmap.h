@@ -0,0 +1,67 @@
+#pragma once
+
+#include <nav_msgs/OccupancyGrid.h>
+
+#include <vector>
+
+/**
+ * @brief Layered traversal costs for the terrain aware planner, in the same layout as the occupancy grid.
+ *
+ * Every layer is a grid of costs from 0 (free to drive on) to LETHAL_COST (never drive on). The layers are combined by
+ * taking the highest cost of each cell, like costmap_2d, so a cell is lethal if any layer says so:
+ * - obstacle layer: the padded occupancy grid, lethal from the occupancy threshold up
+ * - inflation layer: a cost that decays with the distance to the closest obstacle, so paths keep some room when
+ *   they can
+ * - slope layer: the slope and roughness of a height map, lethal past the steepest slope or roughest ground the rovers
+ *   can drive on
+ */
+class Costmap
+{
+public:
+  // Cells at this cost are never entered
+  static const int LETHAL_COST = 100;
+
+  /**
+   * @brief Obstacle layer, from an occupancy grid
+   *
+   * @param oGrid The occupancy grid, usually padded already (see CSpace)
+   * @param threshold The threshold at which a cell is occupied
+   * @return Lethal where the grid is occupied, the occupancy value elsewhere and 0 where it is unknown
+   */
+  static nav_msgs::OccupancyGrid obstacleLayer(const nav_msgs::OccupancyGrid &oGrid, int threshold);
+
+  /**
+   * @brief Inflation layer, from a distance field
+   *
+   * @param oGrid The grid the distance field belongs to, for its size
+   * @param distanceField Distance from each cell to the closest obstacle in cells, see CSpace::getDistanceField
+   * @param inscribedRadius Cells closer than this to an obstacle get maxCost, in cells
+   * @param inflationRadius Cells further than this from any obstacle cost nothing, in cells
+   * @param maxCost The highest cost of the layer, below LETHAL_COST
+   * @return maxCost next to the obstacles, decaying exponentially down to 0 at the inflation radius
+   */
+  static nav_msgs::OccupancyGrid inflationLayer(const nav_msgs::OccupancyGrid &oGrid, const std::vector<float> &distanceField, double inscribedRadius,
+                                                double inflationRadius, int maxCost);
+
+  /**
+   * @brief Slope and roughness layer, from a height map
+   *
+   * @param oGrid The grid the height map is aligned with, for its size and resolution
+   * @param heights Height of each cell in meters, NAN where it is unknown
+   * @param maxSlope Slopes from this angle up are lethal, in radians
+   * @param maxRoughness Cells that stick out this far from the average of their neighbors are lethal, in meters
+   * @param maxCost The highest cost of the layer below lethal
+   * @return The higher of the two costs, each growing linearly up to maxCost just below its limit. Unknown cells cost
+   * nothing.
+   */
+  static nav_msgs::OccupancyGrid slopeLayer(const nav_msgs::OccupancyGrid &oGrid, const std::vector<float> &heights, double maxSlope, double maxRoughness,
+                                            int maxCost);
+
+  /**
+   * @brief Adds a layer to a costmap, keeping the highest cost of each cell
+   *
+   * @param costmap The costmap, updated in place
+   * @param layer The layer, the same size as the costmap
+   */
+  static void combine(nav_msgs::OccupancyGrid &costmap, const nav_msgs::OccupancyGrid &layer);
+};
@@ -1,32 +1,46 @@
 #pragma once
 
 #include <nav_msgs/OccupancyGrid.h>
+#include <vector>
 
 class CSpace
 {
 private:
 	/**
-	 * @brief Get the neighbors indicies of a point in the occupancy Grid
+	 * @brief 1D squared euclidean distance transform of a sampled function (Felzenszwalb and Huttenlocher, 2012)
 	 * 
-	 * @param pt the index that you want to find the neighbors of
-	 * @param widthOfGrid width of the map 
-	 * @param sizeOfGrid total number of elements in the map
-	 * @return std::vector<int> the indexes of the neighbors of pt
+	 * @param f the sampled function, 0 at obstacles and a large value everywhere else
+	 * @param d output, the squared distance transform of f
+	 * @param n the number of samples
+	 * @param v scratch space for the locations of the parabolas in the lower envelope, at least n long
+	 * @param z scratch space for the boundaries between the parabolas, at least n + 1 long
 	 */
-	static std::array<int, 8> getNeighborsIndiciesArray(int pt, int widthOfGrid, int sizeOfGrid);
+	static void distanceTransform1D(const float *f, float *d, int n, int *v, float *z);
 
 	/**
-	 * @brief recursivly searches for obstacles and edits its neighbors to also be obstacles
+	 * @brief Exact euclidean distance transform of a rectangular window of the grid, only obstacles inside the window count
 	 * 
-	 * @param pt the inital point for which the neighbor are around 
-	 * @param radius the radius of the search area
-	 * @param threshold the value at which a cell is considered an obstacle
-	 * @param editGrid the edited searchGrid
-	 * @param searchGrid the original grid passed to the funciton
+	 * @param oGrid The Occupancy Grid to compute the distances on
+	 * @param threshold The threshold to classify a point as an obstacle
+	 * @param x0 the left column of the window
+	 * @param y0 the top row of the window
+	 * @param w the width of the window in cells
+	 * @param h the height of the window in cells
+	 * @param field output, w * h distances in row major order
 	 */
-	static void recursiveSearchNeighbors(int pt, int radius, int threshold, nav_msgs::OccupancyGrid &editGrid, nav_msgs::OccupancyGrid &searchGrid);
+	static void distanceFieldWindow(const nav_msgs::OccupancyGrid &oGrid, int threshold, int x0, int y0, int w, int h, float *field);
 
 public:
+	/**
+	 * @brief Computes the exact euclidean distance from every cell to the closest obstacle in linear time
+	 * 
+	 * @param oGrid The Occupancy Grid to compute the distances on
+	 * @param threshold The threshold to classify a point as an obstacle
+	 * @return std::vector<float> distance to the closest obstacle in cell units for every cell, 0 on obstacles
+	 * and INFINITY everywhere if there are no obstacles
+	 */
+	static std::vector<float> getDistanceField(const nav_msgs::OccupancyGrid &oGrid, int threshold);
+
 	/**
 	 * @brief This will return a modified oGrid to include the CSpace
 	 * 
@@ -35,5 +49,46 @@ public:
 	 * @param radius the radius in cell units of the CSpace
 	 * @return OccupancyGrid The Occupancy Grid with the CSpace included
 	 */
-	static nav_msgs::OccupancyGrid getCSpace(nav_msgs::OccupancyGrid &grid, int threshold, int paddingRadius);
+	static nav_msgs::OccupancyGrid getCSpace(const nav_msgs::OccupancyGrid &grid, int threshold, int paddingRadius);
+
+	/**
+	 * @brief Same as above, but also hands back the distance field the CSpace was built from,
+	 * so planners can use it for clearance costs without computing it again
+	 * 
+	 * @param oGrid The Occupancy Grid that you want to modify
+	 * @param threshold The threshold to classify a point as an obstacle 
+	 * @param radius the radius in cell units of the CSpace
+	 * @param distanceField output, the distance field of oGrid (see getDistanceField)
+	 * @return OccupancyGrid The Occupancy Grid with the CSpace included
+	 */
+	static nav_msgs::OccupancyGrid getCSpace(const nav_msgs::OccupancyGrid &grid, int threshold, int paddingRadius, std::vector<float> &distanceField);
+
+	/**
+	 * @brief Brings a CSpace up to date with a new map, only recomputing the areas around the cells that changed.
+	 * The cells that changed obstacle state are grouped into tiles, and the bounding boxes of the dirty tiles padded
+	 * by the radius are inflated again. The cost scales with how much of the map changed instead of the map size,
+	 * apart from one pass comparing the two maps. Falls back to getCSpace if the map size changed or most of it is dirty.
+	 * 
+	 * @param previousGrid The Occupancy Grid cspace and distanceField were built from
+	 * @param oGrid The new Occupancy Grid
+	 * @param threshold The threshold to classify a point as an obstacle, same as the one used to build cspace
+	 * @param radius the radius in cell units of the CSpace, same as the one used to build cspace
+	 * @param cspace the CSpace of previousGrid, updated in place to the CSpace of oGrid
+	 * @param distanceField the distance field of previousGrid, updated in place. Distances up to
+	 * max(radius, exactDistance) stay exact, larger ones are only guaranteed to be larger than that.
+	 * @param exactDistance how far distances have to stay exact, the default only keeps the padding exact
+	 * @return int The number of cells that were recomputed
+	 */
+	static int updateCSpace(const nav_msgs::OccupancyGrid &previousGrid, const nav_msgs::OccupancyGrid &oGrid, int threshold, int radius,
+													nav_msgs::OccupancyGrid &cspace, std::vector<float> &distanceField, int exactDistance = 0);
+
+	/**
+	 * @brief Square max filter (dilation) of the occupancy values, every cell takes the highest value within radius cells
+	 * in x and y. Cheaper than the euclidean CSpace when a conservative square padding is good enough.
+	 * 
+	 * @param oGrid The Occupancy Grid to dilate
+	 * @param radius the half width of the square window in cell units
+	 * @return OccupancyGrid The dilated Occupancy Grid
+	 */
+	static nav_msgs::OccupancyGrid getDilatedGrid(const nav_msgs::OccupancyGrid &grid, int radius);
 };
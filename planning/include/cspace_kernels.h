@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Byte-wise kernels used to build the CSpace, with SSE4.1 and AVX2 versions picked at runtime.
+ *
+ * The kernels work on the raw int8_t occupancy values of a nav_msgs::OccupancyGrid. get() checks the CPU once (CPUID)
+ * and returns the fastest table it supports, falling back to plain scalar code. All versions give identical results.
+ */
+class CSpaceKernels
+{
+public:
+  enum Isa
+  {
+    SCALAR = 0,
+    SSE41,
+    AVX2
+  };
+
+  struct Table
+  {
+    Isa isa;
+
+    /**
+     * @brief mask[i] = src[i] > threshold ? 1 : 0
+     */
+    void (*obstacleMask)(const int8_t *src, uint8_t *mask, int n, int threshold);
+
+    /**
+     * @brief Final CSpace pass. Obstacles (src > threshold) keep their value, cells within the radius of one
+     * (distance <= radius) become 100, unknown cells (-1) become 0 and everything else is copied.
+     */
+    void (*padFromDistance)(const int8_t *src, const float *distance, int8_t *dst, int n, int threshold, float radius);
+
+    /**
+     * @brief 1D sliding window max, dst[i] = max(src[i - radius], ..., src[i + radius]) clamped to [0, n)
+     */
+    void (*maxFilterRow)(const int8_t *src, int8_t *dst, int n, int radius);
+
+    /**
+     * @brief Element-wise max of two rows, dst[i] = max(a[i], b[i]). dst may be the same as a or b.
+     */
+    void (*maxRows)(const int8_t *a, const int8_t *b, int8_t *dst, int n);
+  };
+
+  /**
+   * @brief The best instruction set this CPU supports
+   */
+  static Isa detectIsa();
+
+  /**
+   * @brief Kernels for the best instruction set this CPU supports. Detection only runs on the first call.
+   */
+  static const Table &get();
+
+  /**
+   * @brief Kernels for a specific instruction set, for tests and benchmarks. Falls back to the best supported one
+   * if the CPU can't run the requested instruction set.
+   */
+  static const Table &get(Isa isa);
+
+  static const char *name(Isa isa);
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <astar.h>
+#include <indexed_heap.h>
+
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Incremental planner (D* Lite) that keeps its search between planning requests.
+ *
+ * The search runs backwards from the target, so the costs to reach the target from every expanded cell stay valid while
+ * the robot moves. When cells of the map change, only the cells whose cost is affected by the change are repaired
+ * instead of searching the whole grid again. The search is thrown away and started over whenever the target cell,
+ * threshold or the size of the map changes, since none of the old costs are valid anymore.
+ * Based off Koenig and Likhachev, "D* Lite" (AAAI 2002), the optimized version.
+ */
+class DStarLite : public AStar
+{
+private:
+  // Priority of a cell in the open list, compared lexicographically
+  typedef std::pair<double, double> Key;
+
+  int width_ = 0;
+  int height_ = 0;
+  int threshold_ = 0;
+
+  int start_ = -1;
+  int goal_ = -1;
+
+  // Accumulated heuristic offset from the robot moving (km in the paper)
+  double km_ = 0;
+
+  std::vector<double> g_;
+  std::vector<double> rhs_;
+  std::vector<bool> blocked_;
+  BasicIndexedHeap<Key> open_;
+
+  int expansions_ = 0;
+  bool initialized_ = false;
+
+  /**
+   * @brief Octile distance between two cells, used as the heuristic
+   */
+  double heuristic(int ind1, int ind2) const;
+
+  /**
+   * @brief Cost of moving between two neighboring cells, INFINITY if either is blocked
+   */
+  double cost(int from, int to) const;
+
+  /**
+   * @brief Gets the up to 8 neighbors of a cell that are on the grid, without wrapping around rows
+   *
+   * @param pt The index of the cell
+   * @param neighbors Output array of neighbor indexes
+   * @return The number of neighbors written to the array
+   */
+  int getNeighbors(int pt, std::array<int, 8> &neighbors) const;
+
+  Key calculateKey(int s) const;
+
+  /**
+   * @brief Recomputes the one step lookahead cost of a cell from its neighbors
+   */
+  double lookahead(int s) const;
+
+  /**
+   * @brief Puts a cell in or takes it out of the open list depending on whether it is locally consistent
+   */
+  void updateVertex(int s);
+
+  /**
+   * @brief Expands cells until the start's cost is correct
+   */
+  void computeShortestPath();
+
+  /**
+   * @brief Starts a new search on the given grid
+   */
+  void initialize(const nav_msgs::OccupancyGrid &oGrid, int goal, int threshold);
+
+  /**
+   * @brief Walks from the start to the goal along the cheapest neighbors and turns it into a Path
+   */
+  nav_msgs::Path extractPath(const nav_msgs::OccupancyGrid &oGrid) const;
+
+public:
+  /**
+   * @brief Plans from the center of the grid (the robot) to the target, repairing the previous search if possible.
+   *
+   * @param oGrid The occupancy grid, ranging 0 (unoccupied) to 100 (completely blocked)
+   * @param target The target Point for the algorithm, same as AStar::findPathOccGrid
+   * @param changedCells Indexes of the cells that may have changed since the last call. Cells that did not change
+   *                     can be included, they are checked against the previous grid.
+   * @param threshold The threshold above which we consider a node occupied. default = 50
+   * @return A ROS Path message in the same format as AStar::findPathOccGrid
+   */
+  nav_msgs::Path findPathOccGrid(const nav_msgs::OccupancyGrid &oGrid, geometry_msgs::Point target, const std::vector<int> &changedCells, int threshold = 50);
+
+  /**
+   * @brief Forgets the previous search, the next call plans from scratch
+   */
+  void reset();
+
+  /**
+   * @brief Number of cells expanded by the last call
+   */
+  int expansions() const
+  {
+    return expansions_;
+  }
+};
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <astar.h>
+#include <geometry_msgs/Pose.h>
+
+#include <vector>
+
+/**
+ * @brief Hierarchical planner (HPA*) for targets outside the robot centred occupancy grid.
+ *
+ * Keeps a coarse map of the whole arena in the odom frame, built up from every local map it is given. The coarse map
+ * is split into square clusters. Wherever two neighboring clusters share free border cells there are entrances, and
+ * the costs between the entrances of each cluster are precomputed. A route across the arena is then a search over
+ * the entrances only. When the map changes, only the clusters that changed and their neighbors are rebuilt.
+ *
+ * The route is refined with fine A* on the local grid up to the last point of the route inside the local grid. The rest
+ * of the route is added as coarse waypoints, so the robot heads the right way and replans as it gets there.
+ * Based off Botea, Müller and Schaeffer, "Near Optimal Hierarchical Path-Finding" (JOGD 2004).
+ */
+class HPAStar : public AStar
+{
+private:
+  struct Cluster
+  {
+    // Coarse cell indexes of the entrances on the border of the cluster
+    std::vector<int> entrances;
+
+    // Cost between every pair of entrances, entrances.size() squared, INFINITY if not connected inside the cluster
+    std::vector<float> costs;
+
+    bool dirty = true;
+  };
+
+  // Coarse map of the arena, centred on the odom origin
+  nav_msgs::OccupancyGrid global_map_;
+  int threshold_;
+  int cluster_size_;
+  int clusters_x_;
+  int clusters_y_;
+
+  std::vector<Cluster> clusters_;
+
+  // Position of each coarse cell in the entrance list of its cluster, -1 if it isn't an entrance
+  std::vector<int> entrance_slot_;
+
+  // Scratch space for merging a local map into the coarse map, tagged so it never has to be cleared
+  std::vector<int8_t> merged_;
+  std::vector<uint32_t> merged_generation_;
+  uint32_t generation_ = 0;
+
+  // Scratch space for the searches
+  SearchSpace abstract_space_;
+  std::vector<float> cluster_costs_;
+  std::vector<int> cluster_parents_;
+  BasicIndexedHeap<float> cluster_open_;
+
+  int expansions_ = 0;
+
+  bool blocked(int cell) const;
+
+  int clusterOf(int cell) const;
+
+  /**
+   * @brief Octile distance between two coarse cells
+   */
+  double octileDistance(int cell1, int cell2) const;
+
+  /**
+   * @brief Finds the entrances on the borders of a cluster. A run of border cells that is free on both sides gets
+   * one entrance in the middle, or one at each end if it is long. Both clusters of a border find the same runs.
+   */
+  void findEntrances(int cluster);
+
+  /**
+   * @brief Dijkstra from one cell, only moving through free cells of the given cluster
+   *
+   * @param cluster The cluster to search in
+   * @param from The coarse cell to start from
+   * @return The cost to every cell of the cluster in cluster_costs_ and the parents in cluster_parents_, both indexed
+   * by the position of the cell inside the cluster
+   */
+  void searchCluster(int cluster, int from);
+
+  /**
+   * @brief Position of a coarse cell inside its cluster, for indexing the results of searchCluster
+   */
+  int localIndex(int cluster, int cell) const;
+
+  /**
+   * @brief Recomputes the entrances and entrance costs of the dirty clusters. The neighbors of a dirty cluster share
+   * its borders, so they get rebuilt too.
+   */
+  void rebuildClusters();
+
+  /**
+   * @brief Searches the abstract graph and refines the result into coarse cells
+   *
+   * @param start The coarse start cell
+   * @param goal The coarse goal cell
+   * @return The coarse cells from start to goal, empty if there is no route
+   */
+  std::vector<int> findCoarsePath(int start, int goal);
+
+  /**
+   * @brief Coarse cell that holds a point in the odom frame, -1 if the point is outside the arena
+   */
+  int coarseIndex(double x, double y) const;
+
+  /**
+   * @brief Centre of a coarse cell in the odom frame
+   */
+  geometry_msgs::Point coarseCenter(int cell) const;
+
+public:
+  /**
+   * @brief Creates an empty (all unknown) arena map
+   *
+   * @param arenaSize The width and height of the arena in meters, centred on the odom origin
+   * @param resolution The size of a coarse cell in meters
+   * @param clusterSize The width and height of a cluster in coarse cells
+   * @param threshold The threshold above which we consider a coarse cell occupied
+   */
+  HPAStar(double arenaSize = 200, double resolution = 0.5, int clusterSize = 10, int threshold = 50);
+
+  /**
+   * @brief Copies a robot centred occupancy grid into the arena map. Known cells overwrite what was there before,
+   * unknown cells (-1) leave the arena map as it was.
+   *
+   * @param oGrid The robot centred occupancy grid, in the robot's base frame
+   * @param robotPose The pose of the robot in the odom frame when the grid was made
+   */
+  void updateGlobalMap(const nav_msgs::OccupancyGrid &oGrid, const geometry_msgs::Pose &robotPose);
+
+  /**
+   * @brief Plans to a target that may be outside the local grid. Targets on the local grid are planned with plain A*.
+   *
+   * @param oGrid The robot centred occupancy grid, ranging 0 (unoccupied) to 100 (completely blocked)
+   * @param target The target, in cells relative to the center of the grid like AStar::findPathOccGrid
+   * @param robotPose The pose of the robot in the odom frame
+   * @param threshold The threshold above which we consider a node of oGrid occupied. default = 50
+   * @return A ROS Path message in the same format as AStar::findPathOccGrid, the waypoints past the local grid come
+   * from the coarse route
+   */
+  nav_msgs::Path findPathOccGrid(const nav_msgs::OccupancyGrid &oGrid, geometry_msgs::Point target, const geometry_msgs::Pose &robotPose, int threshold = 50);
+
+  /**
+   * @brief The coarse arena map
+   */
+  const nav_msgs::OccupancyGrid &globalMap() const
+  {
+    return global_map_;
+  }
+
+  /**
+   * @brief Number of abstract nodes expanded by the last route search
+   */
+  int expansions() const
+  {
+    return expansions_;
+  }
+};
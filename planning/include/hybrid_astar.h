@@ -0,0 +1,102 @@
+#pragma once
+
+#include <astar.h>
+#include <reeds_shepp.h>
+
+#include <geometry_msgs/Pose.h>
+
+/**
+ * @brief Hybrid A* over (x, y, heading) for the four wheel steered rover, so paths can be driven without stopping.
+ *
+ * States keep a continuous position, and are binned on a coarse grid of positions and headings so each bin is expanded
+ * once. A state is expanded with a fixed set of motion primitives that the rover can drive (see
+ * NavigationAlgo::getSteeringAnglesRadialTurn): radial turns and straight drives forwards and backwards, crab drives at
+ * 45 degrees and point turns. Reversing, crabbing, point turns and changes of steering or direction all cost extra, so
+ * they are only used when they save a longer drive. The primitives are precomputed for every heading bin.
+ *
+ * Every few expansions, and every expansion close to the target, the Reeds-Shepp curve to the target is tried, and
+ * the search ends as soon as one is free. The heuristic is the larger of the Reeds-Shepp length (ignores obstacles)
+ * and the 8-connected grid distance to the target (ignores the turning radius).
+ * Based off Dolgov, Thrun, Montemerlo and Diebel, "Practical Search Techniques in Path Planning for Autonomous
+ * Driving" (2008).
+ */
+class HybridAStar : public AStar
+{
+private:
+  /**
+   * @brief One motion primitive, for one heading bin. Distances are in cells.
+   */
+  struct Primitive
+  {
+    // Change of position and heading bin at the end of the motion
+    double dx, dy;
+    int dheading;
+
+    // Cost of the motion, in cells
+    double cost;
+
+    // 1 forwards, -1 backwards, 0 for point turns
+    int direction;
+
+    // Heading bins turned per step (radial turn), crab or point turn. Changing it costs extra.
+    int steering;
+
+    // Positions along the motion relative to its start, at most a cell apart, for collision checking
+    std::vector<std::pair<double, double>> samples;
+  };
+
+  /**
+   * @brief The primitives of every heading bin, for the given grid resolution. Built on the first call and whenever
+   * the resolution changes.
+   *
+   * @param resolution The grid resolution, in meters per cell
+   * @return The primitives, indexed by heading bin
+   */
+  static const std::vector<std::vector<Primitive>> &primitives(double resolution);
+
+  /**
+   * @brief Checks if a position is inside the grid and on a free cell. The start and target cells are always free.
+   *
+   * @param x X coordinate, in cells
+   * @param y Y coordinate, in cells
+   * @param oGrid The occupancy grid
+   * @param threshold The threshold at which we consider a node occupied
+   * @param startIndex The robot's cell
+   * @param endIndex The target cell
+   * @return Whether the position is free
+   */
+  static bool free(double x, double y, const nav_msgs::OccupancyGrid &oGrid, int threshold, int startIndex, int endIndex);
+
+  /**
+   * @brief Converts a position and heading on the grid to a pose in the robot frame, like poseStampedFromIndex
+   */
+  static geometry_msgs::PoseStamped poseStamped(double x, double y, double yaw, const nav_msgs::OccupancyGrid &oGrid);
+
+public:
+  /**
+     * @brief Calculates a path that the rover can drive without stopping, that also ends at the target heading if one
+     * is given.
+     *
+     * @param oGrid The occupancy grid, ranging 0 (unoccupied) to 100 (completely blocked)
+     * @param target The target, position in cells relative to the center of the grid like the other planners, heading
+     * in the robot frame. The heading is free if the orientation is all zeros.
+     * @param threshold The threshold above which we consider a node occupied. default = 50
+     *
+     * @return A ROS Path message of poses along the path about half a meter apart, target first and the robot's current
+     * location last. Each pose has the robot's heading at that point, opposite to the direction of travel when driving
+     * backwards.
+    **/
+  static nav_msgs::Path findPathOccGrid(const nav_msgs::OccupancyGrid &oGrid, const geometry_msgs::Pose &target, int threshold = 50);
+
+  /**
+     * @brief Same as above, but runs the search in a caller owned search space so its memory is reused between calls.
+     *
+     * @param oGrid The occupancy grid, ranging 0 (unoccupied) to 100 (completely blocked)
+     * @param target The target pose, as above
+     * @param space The search space to run in, indexed by state bin. It holds the expansion count after the search.
+     * @param threshold The threshold above which we consider a node occupied. default = 50
+     *
+     * @return The path, as above. Empty if there is none.
+    **/
+  static nav_msgs::Path findPathOccGrid(const nav_msgs::OccupancyGrid &oGrid, const geometry_msgs::Pose &target, SearchSpace &space, int threshold = 50);
+};
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <vector>
+
+/**
+ * @brief Binary min-heap over grid indices with O(log n) decrease-key.
+ *
+ * Key is the priority type. It only needs operator< and operator<=, so lexicographic keys such as std::pair work too.
+ *
+ * Every grid index can be in the heap at most once. The position of each index inside the heap is tracked in a flat
+ * array sized to the grid, so pushing an index that is already queued just moves it up instead of inserting a duplicate.
+ * The storage is kept between searches, so a heap that is reused does not allocate once it has grown to the map size.
+ */
+template <typename Key>
+class BasicIndexedHeap
+{
+private:
+  struct Entry
+  {
+    Key key;
+    int index;
+  };
+
+  // The heap itself, ordered by key
+  std::vector<Entry> heap_;
+
+  // Position of each grid index inside heap_, -1 if it is not queued
+  std::vector<int> position_;
+
+  void siftUp(int pos)
+  {
+    Entry moving = heap_[pos];
+    while (pos > 0)
+    {
+      int parent = (pos - 1) / 2;
+      if (heap_[parent].key <= moving.key)
+        break;
+
+      heap_[pos] = heap_[parent];
+      position_[heap_[pos].index] = pos;
+      pos = parent;
+    }
+    heap_[pos] = moving;
+    position_[moving.index] = pos;
+  }
+
+  void siftDown(int pos)
+  {
+    Entry moving = heap_[pos];
+    int size = heap_.size();
+    while (true)
+    {
+      int child = 2 * pos + 1;
+      if (child >= size)
+        break;
+
+      if (child + 1 < size && heap_[child + 1].key < heap_[child].key)
+        ++child;
+
+      if (moving.key <= heap_[child].key)
+        break;
+
+      heap_[pos] = heap_[child];
+      position_[heap_[pos].index] = pos;
+      pos = child;
+    }
+    heap_[pos] = moving;
+    position_[moving.index] = pos;
+  }
+
+public:
+  /**
+   * @brief Empties the heap and makes room for indices in [0, size)
+   *
+   * @param size The number of cells in the grid that will be searched
+   */
+  void reset(int size)
+  {
+    // Only the indices still queued from the last search need to be cleared
+    for (const Entry &e : heap_)
+      position_[e.index] = -1;
+    heap_.clear();
+
+    if ((int)position_.size() < size)
+      position_.resize(size, -1);
+  }
+
+  bool empty() const
+  {
+    return heap_.empty();
+  }
+
+  int size() const
+  {
+    return heap_.size();
+  }
+
+  bool contains(int index) const
+  {
+    return position_[index] != -1;
+  }
+
+  /**
+   * @brief Key of the minimum element. The heap must not be empty.
+   */
+  const Key &topKey() const
+  {
+    return heap_.front().key;
+  }
+
+  /**
+   * @brief Index of the minimum element. The heap must not be empty.
+   */
+  int top() const
+  {
+    return heap_.front().index;
+  }
+
+  /**
+   * @brief Inserts an index, or updates its key if it is already queued.
+   *
+   * @param index The grid index
+   * @param key The priority of the index, lower comes out first
+   */
+  void push(int index, const Key &key)
+  {
+    int pos = position_[index];
+    if (pos == -1)
+    {
+      heap_.push_back({key, index});
+      siftUp(heap_.size() - 1);
+    }
+    else if (key < heap_[pos].key)
+    {
+      heap_[pos].key = key;
+      siftUp(pos);
+    }
+    else
+    {
+      heap_[pos].key = key;
+      siftDown(pos);
+    }
+  }
+
+  /**
+   * @brief Removes an index from the heap if it is queued.
+   *
+   * @param index The grid index
+   */
+  void remove(int index)
+  {
+    int pos = position_[index];
+    if (pos == -1)
+      return;
+
+    position_[index] = -1;
+    Entry last = heap_.back();
+    heap_.pop_back();
+    if (pos == (int)heap_.size())
+      return;
+
+    heap_[pos] = last;
+    position_[last.index] = pos;
+    siftUp(pos);
+    siftDown(position_[last.index]);
+  }
+
+  /**
+   * @brief Removes and returns the index with the lowest key. The heap must not be empty.
+   */
+  int pop()
+  {
+    int index = heap_.front().index;
+    position_[index] = -1;
+
+    Entry last = heap_.back();
+    heap_.pop_back();
+    if (!heap_.empty())
+    {
+      heap_[0] = last;
+      position_[last.index] = 0;
+      siftDown(0);
+    }
+    return index;
+  }
+};
+
+typedef BasicIndexedHeap<double> IndexedHeap;
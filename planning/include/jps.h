@@ -0,0 +1,103 @@
+#pragma once
+
+#include <astar.h>
+
+/**
+ * @brief Jump Point Search on uniform cost occupancy grids.
+ *
+ * Finds the same kind of shortest 8-connected paths as A*, but skips over the long runs of symmetric free cells that
+ * make up most of a padded CSpace grid, only expanding cells where the path may have to turn (jump points).
+ * Diagonal moves are only allowed when both adjacent straight cells are free, so paths never cut obstacle corners.
+ * Based off Harabor and Grastien, "Online Graph Pruning for Pathfinding on Grid Maps" (AAAI 2011).
+ */
+class JPS : public AStar
+{
+private:
+  /**
+   * @brief Checks if a cell is inside the grid and can be travelled through
+   *
+   * @param x X coordinate of the cell
+   * @param y Y coordinate of the cell
+   * @param oGrid The occupancy grid
+   * @param threshold The threshold at which we consider a node occupied
+   * @param endIndex The target index, which is always walkable
+   * @return Whether the cell can be travelled through
+   */
+  static bool walkable(int x, int y, const nav_msgs::OccupancyGrid &oGrid, int threshold, int endIndex);
+
+  /**
+   * @brief Octile distance between two indexes, the exact cost of a straight or diagonal run between them
+   *
+   * @param ind1 First point index
+   * @param ind2 Second point index
+   * @param width The width of the map that the indexes are on
+   * @return The octile distance between the points (in map units)
+   */
+  static double octileDistance(int ind1, int ind2, int width);
+
+  /**
+   * @brief Steps from a cell in a straight (horizontal or vertical) direction until a jump point is found
+   *
+   * @param x X coordinate to jump from
+   * @param y Y coordinate to jump from
+   * @param dx X direction, -1, 0 or 1
+   * @param dy Y direction, -1, 0 or 1
+   * @param oGrid The occupancy grid
+   * @param threshold The threshold at which we consider a node occupied
+   * @param endIndex The target index
+   * @return The index of the jump point, -1 if the jump ran into an obstacle or off the grid
+   */
+  static int jumpStraight(int x, int y, int dx, int dy, const nav_msgs::OccupancyGrid &oGrid, int threshold, int endIndex);
+
+  /**
+   * @brief Steps from a cell in a diagonal direction until a jump point is found
+   *
+   * @param x X coordinate to jump from
+   * @param y Y coordinate to jump from
+   * @param dx X direction, -1 or 1
+   * @param dy Y direction, -1 or 1
+   * @param oGrid The occupancy grid
+   * @param threshold The threshold at which we consider a node occupied
+   * @param endIndex The target index
+   * @return The index of the jump point, -1 if the jump ran into an obstacle or off the grid
+   */
+  static int jumpDiagonal(int x, int y, int dx, int dy, const nav_msgs::OccupancyGrid &oGrid, int threshold, int endIndex);
+
+  /**
+   * @brief Gets the directions that have to be searched from a jump point, given the direction it was reached from
+   *
+   * @param current The index of the jump point
+   * @param parent The index of the jump point it was reached from, -1 for the start
+   * @param oGrid The occupancy grid
+   * @param threshold The threshold at which we consider a node occupied
+   * @param endIndex The target index
+   * @param directions Output array of (dx, dy) pairs
+   * @return The number of directions written to the array
+   */
+  static int getPrunedDirections(int current, int parent, const nav_msgs::OccupancyGrid &oGrid, int threshold, int endIndex, std::array<std::pair<int, int>, 8> &directions);
+
+public:
+  /**
+     * @brief Calculates the shortest path using jump point search. Takes the same arguments and gives the same
+     * kind of path as AStar::findPathOccGrid.
+     *
+     * @param oGrid The occupancy grid, ranging 0 (unoccupied) to 100 (completely blocked)
+     * @param target The target Point for the algorithm.
+     * @param threshold The threshold above which we consider a node occupied. default = 50
+     *
+     * @return A ROS Path message containing the points in the shortest path, including the robot's current location.
+    **/
+  static nav_msgs::Path findPathOccGrid(const nav_msgs::OccupancyGrid &oGrid, geometry_msgs::Point target, int threshold = 50);
+
+  /**
+     * @brief Same as above, but runs the search in a caller owned search space so its memory is reused between calls.
+     *
+     * @param oGrid The occupancy grid, ranging 0 (unoccupied) to 100 (completely blocked)
+     * @param target The target Point for the algorithm.
+     * @param space The search space to run in. It is reset at the start of the search and holds the expansion count after it.
+     * @param threshold The threshold above which we consider a node occupied. default = 50
+     *
+     * @return A ROS Path message containing the points in the shortest path, including the robot's current location.
+    **/
+  static nav_msgs::Path findPathOccGrid(const nav_msgs::OccupancyGrid &oGrid, geometry_msgs::Point target, SearchSpace &space, int threshold = 50);
+};
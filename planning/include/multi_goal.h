@@ -0,0 +1,42 @@
+#pragma once
+
+#include <astar.h>
+
+#include <vector>
+
+/**
+ * @brief Travel costs and paths between many starts and many goals, from one Dijkstra sweep per start.
+ *
+ * A sweep runs outwards from one cell and stops as soon as every goal has been reached, so all goals cost about as much
+ * as the furthest one alone. Moves cost the same both ways, so when there are fewer goals than starts the sweeps run
+ * from the goals instead. Moves are 8-connected without cutting obstacle corners, like JPS.
+ */
+class MultiGoal : public AStar
+{
+public:
+  /**
+   * @brief Dijkstra from one cell until every target is reached or nothing is left to expand. With no targets it
+   * sweeps every cell that can be reached.
+   *
+   * @param oGrid The occupancy grid
+   * @param source The cell to start from. It is expanded even if it is occupied.
+   * @param targets The cells to reach. Occupied targets can be reached but not passed through.
+   * @param space The search space to run in, holds the costs and parents afterwards
+   * @param threshold The threshold above which we consider a node occupied
+   */
+  static void sweep(const nav_msgs::OccupancyGrid &oGrid, int source, const std::vector<int> &targets, SearchSpace &space, int threshold);
+
+  /**
+   * @brief Cost of the shortest path from every start to every goal
+   *
+   * @param oGrid The occupancy grid, ranging 0 (unoccupied) to 100 (completely blocked)
+   * @param starts Grid indexes of the starts
+   * @param goals Grid indexes of the goals
+   * @param paths If not null, gets the cells of each path from start to goal, empty if there is no path
+   * @param threshold The threshold above which we consider a node occupied. default = 50
+   * @return The costs in cells, row major: [i * goals.size() + j] is from starts[i] to goals[j], INFINITY if there is
+   * no path. paths uses the same order.
+   */
+  static std::vector<double> costMatrix(const nav_msgs::OccupancyGrid &oGrid, const std::vector<int> &starts, const std::vector<int> &goals,
+                                        std::vector<std::vector<int>> *paths, int threshold = 50);
+};
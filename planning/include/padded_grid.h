@@ -0,0 +1,94 @@
+#pragma once
+
+#include <nav_msgs/OccupancyGrid.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Copy of an occupancy grid with a one cell wide border of blocked cells all around it, for grid searches.
+ *
+ * Every cell of the original grid has all 8 of its neighbors in the padded grid, so a search can step to
+ * `cell + offsets()[k]` without any bounds checks and never wraps from one row to the next. The border cells hold
+ * BORDER, which is at or above any occupancy threshold, so they are never entered. Searches run on padded indices and
+ * convert back with toGrid() when they build their path. Keep one PaddedGrid around and assign() each new grid to it to
+ * reuse its memory.
+ */
+class PaddedGrid
+{
+private:
+  std::vector<int8_t> data_;
+  int grid_width_ = 0;
+  int width_ = 0;
+  int height_ = 0;
+  std::array<int, 8> offsets_{};
+
+public:
+  // Value of the border cells
+  static const int8_t BORDER = INT8_MAX;
+
+  static constexpr int NEIGHBORS = 8;
+
+  // Column and row steps to each neighbor, in the same order as AStar::getNeighborsIndiciesArray
+  static constexpr int DX[NEIGHBORS] = {1, -1, 0, 1, -1, 0, 1, -1};
+  static constexpr int DY[NEIGHBORS] = {0, 0, 1, 1, 1, -1, -1, -1};
+
+  // Length of the step to each neighbor, in cells
+  static constexpr double STEP_COST[NEIGHBORS] = {1, 1, 1, M_SQRT2, M_SQRT2, 1, M_SQRT2, M_SQRT2};
+
+  /**
+   * @brief Copies a grid into the middle of the padded grid and fills in the border
+   *
+   * @param oGrid The occupancy grid
+   */
+  void assign(const nav_msgs::OccupancyGrid &oGrid);
+
+  /**
+   * @brief Width of the padded grid, two more than the original
+   */
+  int width() const
+  {
+    return width_;
+  }
+
+  int height() const
+  {
+    return height_;
+  }
+
+  int size() const
+  {
+    return data_.size();
+  }
+
+  int8_t operator[](int index) const
+  {
+    return data_[index];
+  }
+
+  /**
+   * @brief Index offsets of the 8 neighbors of a cell, DY * width() + DX
+   */
+  const std::array<int, 8> &offsets() const
+  {
+    return offsets_;
+  }
+
+  /**
+   * @brief Padded index of a cell of the original grid
+   */
+  int toPadded(int index) const
+  {
+    return (index / grid_width_ + 1) * width_ + index % grid_width_ + 1;
+  }
+
+  /**
+   * @brief Index in the original grid of a padded cell that is not on the border
+   */
+  int toGrid(int index) const
+  {
+    return (index / width_ - 1) * grid_width_ + index % width_ - 1;
+  }
+};
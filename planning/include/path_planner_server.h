@@ -4,20 +4,231 @@
 #include <nav_msgs/OccupancyGrid.h>
 #include <geometry_msgs/PoseStamped.h>
 #include "planning/trajectory.h"
+#include "planning/batch_trajectory.h"
+#include "planning/cooperative_trajectory.h"
 #include <mutex>
 #include <nav_msgs/Odometry.h>
+#include <dstar_lite.h>
+#include <hpa_star.h>
+#include <ara_star.h>
+#include <thread_pool.h>
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+#include <memory>
+#include <vector>
 
+/**
+ * @brief A map snapshot after inflation. Never modified once published, so it is shared between requests.
+ */
+struct InflatedMap
+{
+  typedef boost::shared_ptr<const InflatedMap> ConstPtr;
+
+  // Counts up by one for every inflated map
+  uint64_t version;
+
+  // The raw snapshot this was built from
+  nav_msgs::OccupancyGrid::ConstPtr source;
+
+  // The padded map the planners run on
+  nav_msgs::OccupancyGrid::ConstPtr padded;
+
+  // Traversal costs for TERRAIN_ASTAR, see Costmap
+  nav_msgs::OccupancyGrid::ConstPtr costmap;
+
+  // Distance from each cell to the closest obstacle, in cells. Maps are updated incrementally from the previous one,
+  // so only distances up to the CSpace radius are exact (see CSpace::updateCSpace).
+  std::vector<float> distance_field;
+};
+
+/**
+ * @brief Planner for one robot: its maps, planners and services. One process serves every robot with one PathServer
+ * each, sharing the worker pool, and services requests for different robots in parallel.
+ */
 class PathServer
 {
 private:
-  nav_msgs::OccupancyGrid global_oGrid_;
+  std::string robot_name_;
+
+  // Latest map snapshot. Snapshots are never modified once published, so readers just grab the pointer
+  // (boost::atomic_load) and the callback swaps in a new one (boost::atomic_exchange) without copying any cells.
+  nav_msgs::OccupancyGrid::ConstPtr global_oGrid_;
+
+  // Latest inflated map, swapped the same way as global_oGrid_
+  InflatedMap::ConstPtr inflated_map_;
+
+  // Only one inflation runs at a time, so a request never duplicates the background stage's work
+  std::mutex inflation_mutex_;
 
+  // Background inflation stage, woken up by oGridCallback
+  std::thread inflation_thread_;
+  std::mutex inflation_signal_mutex_;
+  std::condition_variable inflation_signal_;
+  bool inflation_pending_ = false;
+  bool shutdown_ = false;
+
+  // Diagnostics
+  std::atomic<uint64_t> inflation_count_{0};
+  std::atomic<uint64_t> cache_hits_{0};
+  std::atomic<uint64_t> cache_misses_{0};
+  std::atomic<double> last_inflation_ms_{0};
+  std::atomic<double> total_inflation_ms_{0};
+  std::atomic<uint64_t> incremental_count_{0};
+  std::atomic<uint64_t> cells_recomputed_{0};
+
+  // Guards swapping in new snapshots together with the D* Lite change tracking below
   std::mutex oGrid_mutex_;
 
+  // Incremental planner, keeps its search between DSTAR_LITE requests. Not thread safe, guarded by dstar_mutex_.
+  DStarLite dstar_lite_;
+  std::mutex dstar_mutex_;
+
+  // Anytime planner for ARASTAR requests, and the map it is searching. Not thread safe, guarded by ara_mutex_.
+  // ara_search_ counts the searches started, so the background improvement knows when its search was replaced.
+  ARAStar ara_star_;
+  InflatedMap::ConstPtr ara_map_;
+  uint64_t ara_search_ = 0;
+  std::mutex ara_mutex_;
+
+  // Arena map and hierarchical planner for targets outside the local map. Not thread safe, guarded by hpa_mutex_.
+  HPAStar hpa_star_;
+  std::mutex hpa_mutex_;
+
+  // Workers for the planning that can run in parallel, shared by every robot
+  ThreadPool &planning_pool_;
+
+  // Every robot's PathServer in this process, this one included. Only read once they are all constructed.
+  const std::vector<std::unique_ptr<PathServer>> &team_;
+
+  // Latest robot pose in the odom frame, guarded by pose_mutex_
+  geometry_msgs::Pose robot_pose_;
+  bool pose_received_ = false;
+  std::mutex pose_mutex_;
+
+  // Cells of the raw map that changed since the last DSTAR_LITE request, guarded by oGrid_mutex_
+  std::vector<int> changed_cells_;
+
+  // Set when too much of the map changed to be worth tracking, the next DSTAR_LITE request plans from scratch
+  bool map_replaced_ = true;
+
+  /**
+   * @brief Turns changed cells of the raw map into the cells of the padded map that may have changed with them
+   *
+   * @param changed Changed cells of the raw map
+   * @param paddedGrid The padded map
+   * @param radius The padding radius used for the CSpace
+   * @return The indexes of every padded cell within the padding radius of a changed cell
+   */
+  static std::vector<int> padChangedCells(const std::vector<int> &changed, const nav_msgs::OccupancyGrid &paddedGrid, int radius);
+
+  /**
+   * @brief Gets the inflated version of a map snapshot, inflating it only if that hasn't been done yet
+   *
+   * @param oGrid The map snapshot
+   * @param fromRequest Whether a planning request is asking, which counts towards the cache hits and misses
+   * @return The inflated map, shared with every other request on the same snapshot
+   */
+  InflatedMap::ConstPtr getInflatedMap(const nav_msgs::OccupancyGrid::ConstPtr &oGrid, bool fromRequest);
+
+  /**
+   * @brief Adds a raw map snapshot to the arena map used by HPASTAR requests, at the latest robot pose
+   */
+  void updateArenaMap(const nav_msgs::OccupancyGrid::ConstPtr &oGrid);
+
+  /**
+   * @brief Copy of the arena map, padded for the batch and cooperative services
+   */
+  nav_msgs::OccupancyGrid paddedArenaMap();
+
+  /**
+   * @brief The arena maps of the whole team merged into one and padded, for the cooperative service. Every cell is
+   * the highest value any robot has for it, so cells one robot hasn't seen take what the others saw.
+   */
+  nav_msgs::OccupancyGrid paddedTeamArenaMap();
+
+  /**
+   * @brief Arena map index of a pose in the odom frame, -1 if it is off the map
+   */
+  static int arenaIndex(const nav_msgs::OccupancyGrid &arena, const geometry_msgs::PoseStamped &pose);
+
+  /**
+   * @brief Turns arena map cells into a Path in the odom frame, goal first, without the points on straight lines
+   *
+   * @param cells The cells from the start to the goal
+   * @param arena The arena map
+   * @param stepTime Time between two cells in seconds. Each pose is stamped with the time the robot gets there.
+   * @return The path
+   */
+  static nav_msgs::Path arenaPath(const std::vector<int> &cells, const nav_msgs::OccupancyGrid &arena, double stepTime = 0);
+
+  /**
+   * @brief Plans with ARA* until the time limit, carrying on from the last search if it was for the same target on the
+   * same map. The search keeps going in the background afterwards.
+   *
+   * @param inflated The map to plan on
+   * @param target The target, in cells relative to the center of the map
+   * @param timeLimit Seconds to search for
+   * @return The best path found in time, empty if there is none yet
+   */
+  nav_msgs::Path anytimePath(const InflatedMap::ConstPtr &inflated, const geometry_msgs::Point &target, double timeLimit);
+
+  /**
+   * @brief Improves an ARA* search for a short slice of time on the worker pool, then queues the next slice until the
+   * search is done, replaced or out of time. Slicing lets requests and the other robots' work in between.
+   *
+   * @param search The search to improve, see ara_search_
+   * @param until When to give up on improving it
+   */
+  void improveInBackground(uint64_t search, const ros::WallTime &until);
+
+  /**
+   * @brief Background stage, inflates every new map as soon as it arrives
+   */
+  void inflationLoop();
+
+  ros::Subscriber oGrid_subscriber_;
+  ros::Subscriber odom_subscriber_;
+
+  // Latest inflated map, published by the background stage
+  ros::Publisher inflated_oGrid_publisher_;
+
+  // Inflation cache and latency statistics
+  ros::Publisher diagnostics_publisher_;
+  ros::WallTimer diagnostics_timer_;
+
+  ros::ServiceServer trajectory_service_;
+  ros::ServiceServer batch_service_;
+  ros::ServiceServer cooperative_service_;
+
 public:
-  ros::Subscriber oGrid_subscriber;
+  /**
+   * @brief Starts planning for a robot, subscribing to its map and odometry and advertising its services
+   *
+   * @param nh Node handle in the robot's namespace
+   * @param robot_name The robot
+   * @param pool Workers shared with the other robots
+   * @param team The PathServers of every robot, this one included, for the maps the cooperative service plans on
+   */
+  PathServer(ros::NodeHandle &nh, const std::string &robot_name, ThreadPool &pool, const std::vector<std::unique_ptr<PathServer>> &team);
+  ~PathServer();
 
-  void oGridCallback(nav_msgs::OccupancyGrid oGrid);
-  void locationCallback(nav_msgs::Odometry location);
+  PathServer(const PathServer &) = delete;
+  PathServer &operator=(const PathServer &) = delete;
+
+  void publishDiagnostics(const ros::WallTimerEvent &event);
+
+  void oGridCallback(const nav_msgs::OccupancyGrid::ConstPtr &oGrid);
+  void locationCallback(const nav_msgs::Odometry::ConstPtr &location);
   bool trajectoryGeneration(planning::trajectory::Request &req, planning::trajectory::Response &res);
+
+  /**
+   * @brief Costs and paths between many starts and goals on the inflated arena map, for the scheduler
+   */
+  bool batchTrajectoryGeneration(planning::batch_trajectory::Request &req, planning::batch_trajectory::Response &res);
+
+  /**
+   * @brief Paths for several robots on the team's arena map that keep them apart, see CooperativePlanner
+   */
+  bool cooperativeTrajectoryGeneration(planning::cooperative_trajectory::Request &req, planning::cooperative_trajectory::Response &res);
 };
\ No newline at end of file
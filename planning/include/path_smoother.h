@@ -0,0 +1,102 @@
+#pragma once
+
+#include <nav_msgs/OccupancyGrid.h>
+#include <nav_msgs/Path.h>
+
+#include <vector>
+
+/**
+ * @brief Post-processing for the grid planners' paths: shortcuts, rounded corners and a speed for every waypoint.
+ *
+ * Paths keep the planners' layout, in meters relative to the center of the grid, target first and the robot last.
+ * Shortcutting drops every waypoint that can be skipped with a straight, free line. Each remaining corner is replaced by
+ * a circular arc tangent to both of its segments (a line and arc spline, like a Dubins path), as wide as the turning
+ * radius allows without running into the next corner or an obstacle. The speed profile then caps the speed by the
+ * curvature and the clearance to obstacles, and limits the acceleration and braking between waypoints.
+ */
+class PathSmoother
+{
+public:
+  /**
+   * @brief Limits for the speed profile. Speeds in m/s, accelerations in m/s^2 and distances in meters.
+   */
+  struct Limits
+  {
+    // Speed on open ground
+    double max_speed;
+
+    // Speed close to obstacles, in tight turns and at both ends of the path
+    double min_speed;
+
+    // Speeding up and braking along the path
+    double max_acceleration;
+
+    // Turns are taken slow enough to stay below this
+    double max_lateral_acceleration;
+
+    // The speed goes from min_speed at min_clearance from the closest obstacle up to max_speed at slow_clearance
+    double min_clearance;
+    double slow_clearance;
+  };
+
+private:
+  /**
+   * @brief Checks that every cell a straight line crosses is free. Cells off the grid count as free, so paths that
+   * leave the local map (HPASTAR) are left alone there.
+   *
+   * @param x0 Start X, in meters
+   * @param y0 Start Y, in meters
+   * @param x1 End X, in meters
+   * @param y1 End Y, in meters
+   * @param oGrid The occupancy grid
+   * @param threshold The threshold above which we consider a cell occupied
+   * @param startIndex The robot's cell, always free like in the planners
+   * @param endIndex The target cell, always free like in the planners
+   * @return Whether the line is free
+   */
+  static bool segmentFree(double x0, double y0, double x1, double y1, const nav_msgs::OccupancyGrid &oGrid, int threshold, int startIndex,
+                          int endIndex);
+
+  /**
+   * @brief Grid index of a position in meters relative to the center of the grid, -1 if it is off the grid
+   */
+  static int cellIndex(double x, double y, const nav_msgs::OccupancyGrid &oGrid);
+
+public:
+  /**
+   * @brief Removes the waypoints that the robot can skip by driving straight to a later one
+   *
+   * @param path A planner's path, target first
+   * @param oGrid The padded occupancy grid the path was planned on
+   * @param threshold The threshold above which we consider a cell occupied. default = 50
+   * @return The path with only the waypoints it can't skip, target first
+   */
+  static nav_msgs::Path shortcut(const nav_msgs::Path &path, const nav_msgs::OccupancyGrid &oGrid, int threshold = 50);
+
+  /**
+   * @brief Rounds the corners of a path with arcs and samples it evenly
+   *
+   * @param path A path, target first. Usually shortcut first, so that the corners are few and far apart.
+   * @param oGrid The padded occupancy grid the path was planned on
+   * @param turnRadius Radius of the arcs in meters. Corners too close to the next corner or an obstacle get the
+   * widest arc that fits, and corners where not even a one cell arc fits stay sharp.
+   * @param spacing Distance between the waypoints, in meters
+   * @param threshold The threshold above which we consider a cell occupied. default = 50
+   * @return The smoothed path, target first, with each pose facing the direction of travel
+   */
+  static nav_msgs::Path smooth(const nav_msgs::Path &path, const nav_msgs::OccupancyGrid &oGrid, double turnRadius, double spacing, int threshold = 50);
+
+  /**
+   * @brief Speed at every waypoint of a path
+   *
+   * @param path The path, target first
+   * @param oGrid The grid the path is on, for its size and resolution
+   * @param distanceField Distance from each cell of the grid to the closest obstacle in cells, see
+   * CSpace::getDistanceField. Empty to ignore the clearance.
+   * @param limits The speed and acceleration limits
+   * @return One speed per pose in the same order, in m/s. Both ends of the path are at limits.min_speed, where the
+   * robot starts off and where the navigation stack stops it.
+   */
+  static std::vector<double> velocityProfile(const nav_msgs::Path &path, const nav_msgs::OccupancyGrid &oGrid, const std::vector<float> &distanceField,
+                                             const Limits &limits);
+};
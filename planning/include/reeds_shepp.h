@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+
+/**
+ * @brief Shortest paths for a car that can drive forwards and backwards with a minimum turning radius, and no obstacles.
+ *
+ * Every such path is made of at most five arcs at the minimum radius and straight lines, from one of 48 families
+ * (Reeds and Shepp, "Optimal paths for a car that goes both forwards and backwards", 1990). All the families are
+ * tried and the shortest one is kept. The formulas follow the paper, with the corrections from the OMPL implementation.
+ */
+class ReedsShepp
+{
+public:
+  enum SegmentType
+  {
+    NOP,
+    LEFT,
+    STRAIGHT,
+    RIGHT
+  };
+
+  /**
+   * @brief A path of up to five segments. Lengths are for a unit turning radius, negative when driving backwards.
+   */
+  struct Path
+  {
+    SegmentType types[5] = {NOP, NOP, NOP, NOP, NOP};
+    double lengths[5] = {0, 0, 0, 0, 0};
+
+    /**
+     * @brief Total length for a unit turning radius, INFINITY if no path was found
+     */
+    double length() const;
+  };
+
+  /**
+   * @brief A pose along a path
+   */
+  struct Sample
+  {
+    double x, y, yaw;
+    bool forward;
+  };
+
+  /**
+   * @brief Shortest path between two poses
+   *
+   * @param x0, y0, yaw0 The start pose
+   * @param x1, y1, yaw1 The end pose
+   * @param radius The minimum turning radius, in the same unit as the positions
+   * @return The path, for a unit radius. Multiply its length by radius to get the real length.
+   */
+  static Path shortestPath(double x0, double y0, double yaw0, double x1, double y1, double yaw1, double radius);
+
+  /**
+   * @brief Poses along a path, spaced by at most step, the end pose included and the start pose left out
+   *
+   * @param path The path from shortestPath
+   * @param x0, y0, yaw0 The start pose that the path was computed from
+   * @param radius The turning radius that the path was computed for
+   * @param step The largest distance between two samples, in the same unit as the positions
+   * @param samples Gets the poses appended
+   */
+  static void sample(const Path &path, double x0, double y0, double yaw0, double radius, double step, std::vector<Sample> &samples);
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <indexed_heap.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Flat per-cell bookkeeping for grid searches (g-scores, parents, closed set and the open list).
+ *
+ * All arrays are indexed directly by the 1D occupancy grid index, so there are no hash lookups or node allocations
+ * during a search. The g-scores and parents are tagged with a generation number, which lets reset() start a new search
+ * without touching every cell. Keep one SearchSpace around and pass it to every search to reuse its memory.
+ */
+class SearchSpace
+{
+private:
+  std::vector<double> g_scores_;
+  std::vector<int> came_from_;
+  std::vector<uint32_t> generation_of_;
+  std::vector<bool> closed_;
+
+  uint32_t generation_ = 0;
+  int size_ = 0;
+  int expansions_ = 0;
+
+public:
+  // The open list, keyed on f-score
+  IndexedHeap open;
+
+  /**
+   * @brief Prepares the space for a new search on a grid with the given number of cells
+   *
+   * @param size The size of the 1D representation of the grid
+   */
+  void reset(int size)
+  {
+    if ((int)g_scores_.size() < size)
+    {
+      g_scores_.resize(size);
+      came_from_.resize(size);
+      generation_of_.resize(size, 0);
+    }
+
+    // On wrap-around the old tags could collide with new ones, so clear them once
+    if (++generation_ == 0)
+    {
+      std::fill(generation_of_.begin(), generation_of_.end(), 0);
+      generation_ = 1;
+    }
+
+    closed_.assign(size, false);
+    open.reset(size);
+    size_ = size;
+    expansions_ = 0;
+  }
+
+  int size() const
+  {
+    return size_;
+  }
+
+  /**
+   * @brief Cost of the best known path to a cell, INFINITY if it has not been reached in this search
+   */
+  double gScore(int index) const
+  {
+    return generation_of_[index] == generation_ ? g_scores_[index] : INFINITY;
+  }
+
+  /**
+   * @brief The cell we came from to reach a cell, -1 for the start or unreached cells
+   */
+  int cameFrom(int index) const
+  {
+    return generation_of_[index] == generation_ ? came_from_[index] : -1;
+  }
+
+  /**
+   * @brief Records a new best path to a cell
+   *
+   * @param index The cell that was reached
+   * @param g_score The cost of the path to the cell
+   * @param came_from The cell the path came from, -1 for the start
+   */
+  void setScore(int index, double g_score, int came_from)
+  {
+    g_scores_[index] = g_score;
+    came_from_[index] = came_from;
+    generation_of_[index] = generation_;
+  }
+
+  bool isClosed(int index) const
+  {
+    return closed_[index];
+  }
+
+  /**
+   * @brief Marks a cell as expanded
+   */
+  void close(int index)
+  {
+    closed_[index] = true;
+    ++expansions_;
+  }
+
+  /**
+   * @brief Number of cells expanded since the last reset
+   */
+  int expansions() const
+  {
+    return expansions_;
+  }
+};
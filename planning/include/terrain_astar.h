@@ -0,0 +1,40 @@
+#pragma once
+
+#include <astar.h>
+#include <costmap.h>
+
+/**
+ * @brief A* on a costmap (see Costmap), trading a little extra distance for easier ground.
+ *
+ * Entering a cell costs the distance to it, stretched by the cell's cost: a cell at cost c takes
+ * 1 + costWeight * c / LETHAL_COST times as long to cross as free ground. Lethal cells are never entered. Every move
+ * costs at least its distance, so the straight line distance is still an admissible heuristic. Moves are 8-connected
+ * like AStar.
+ */
+class TerrainAStar : public AStar
+{
+public:
+  /**
+     * @brief Calculates the cheapest path on a costmap.
+     *
+     * @param costmap The costmap, 0 (free) to Costmap::LETHAL_COST
+     * @param target The target Point, in cells relative to the center of the grid like AStar
+     * @param costWeight How much the costs count against distance, 0 gives the shortest path
+     *
+     * @return A ROS Path message containing the points in the cheapest path, target first and the robot's current
+     * location last. Empty if there is none.
+    **/
+  static nav_msgs::Path findPathOccGrid(const nav_msgs::OccupancyGrid &costmap, geometry_msgs::Point target, double costWeight);
+
+  /**
+     * @brief Same as above, but runs the search in a caller owned search space so its memory is reused between calls.
+     *
+     * @param costmap The costmap, 0 (free) to Costmap::LETHAL_COST
+     * @param target The target Point, as above
+     * @param costWeight How much the costs count against distance, as above
+     * @param space The search space to run in. It is reset at the start of the search and holds the expansion count after it.
+     *
+     * @return The path, as above.
+    **/
+  static nav_msgs::Path findPathOccGrid(const nav_msgs::OccupancyGrid &costmap, geometry_msgs::Point target, double costWeight, SearchSpace &space);
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <astar.h>
+
+/**
+ * @brief Any-angle planner (Lazy Theta*) on occupancy grids.
+ *
+ * Searches the same 8-connected grid as A*, but a cell can take the parent of its parent whenever the straight line
+ * between them is free, so paths are not restricted to the 8 grid directions. The line of sight is only checked when a
+ * cell is expanded, not for every neighbor it is queued from. Paths come out as a short list of turning points instead
+ * of a staircase of cells. Moves never cut obstacle corners, diagonal steps need both straight cells beside them free.
+ * Based off Nash, Koenig and Tovey, "Lazy Theta*: Any-Angle Path Planning and Path Length Analysis in 3D" (AAAI 2010).
+ */
+class ThetaStar : public AStar
+{
+private:
+  /**
+   * @brief Checks if a cell is inside the grid and can be travelled through
+   *
+   * @param x X coordinate of the cell
+   * @param y Y coordinate of the cell
+   * @param oGrid The occupancy grid
+   * @param threshold The threshold at which we consider a node occupied
+   * @param endIndex The target index, which is always walkable
+   * @return Whether the cell can be travelled through
+   */
+  static bool walkable(int x, int y, const nav_msgs::OccupancyGrid &oGrid, int threshold, int endIndex);
+
+  /**
+   * @brief Bresenham line of sight between two cells. Every cell on the line has to be free, and so do both cells
+   * beside each diagonal step.
+   *
+   * @param ind1 First point index
+   * @param ind2 Second point index
+   * @param oGrid The occupancy grid
+   * @param threshold The threshold at which we consider a node occupied
+   * @param endIndex The target index, which is always walkable
+   * @return Whether a straight drive between the cells stays in free space
+   */
+  static bool lineOfSight(int ind1, int ind2, const nav_msgs::OccupancyGrid &oGrid, int threshold, int endIndex);
+
+  /**
+   * @brief Turns the parents recorded during the search into a Path. The parents are already the turning points.
+   */
+  static nav_msgs::Path reconstructPath(int current, const SearchSpace &space, const nav_msgs::OccupancyGrid &oGrid);
+
+public:
+  /**
+     * @brief Calculates a short any-angle path. Takes the same arguments and gives the same kind of path as
+     * AStar::findPathOccGrid, with only the turning points as waypoints.
+     *
+     * @param oGrid The occupancy grid, ranging 0 (unoccupied) to 100 (completely blocked)
+     * @param target The target Point for the algorithm.
+     * @param threshold The threshold above which we consider a node occupied. default = 50
+     *
+     * @return A ROS Path message containing the points in the shortest path, including the robot's current location.
+    **/
+  static nav_msgs::Path findPathOccGrid(const nav_msgs::OccupancyGrid &oGrid, geometry_msgs::Point target, int threshold = 50);
+
+  /**
+     * @brief Same as above, but runs the search in a caller owned search space so its memory is reused between calls.
+     *
+     * @param oGrid The occupancy grid, ranging 0 (unoccupied) to 100 (completely blocked)
+     * @param target The target Point for the algorithm.
+     * @param space The search space to run in. It is reset at the start of the search and holds the expansion count after it.
+     * @param threshold The threshold above which we consider a node occupied. default = 50
+     *
+     * @return A ROS Path message containing the points in the shortest path, including the robot's current location.
+    **/
+  static nav_msgs::Path findPathOccGrid(const nav_msgs::OccupancyGrid &oGrid, geometry_msgs::Point target, SearchSpace &space, int threshold = 50);
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed set of worker threads that run queued tasks in the order they were submitted.
+ *
+ * Starting threads costs far more than most planning tasks, so the workers are started once and kept. Tasks still
+ * queued when the pool is destroyed are run before the workers exit.
+ */
+class ThreadPool
+{
+private:
+  std::vector<std::thread> workers_;
+  std::queue<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable signal_;
+  bool shutdown_ = false;
+
+  void work()
+  {
+    while (true)
+    {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        signal_.wait(lock, [this] { return shutdown_ || !tasks_.empty(); });
+        if (tasks_.empty())
+          return;
+
+        task = std::move(tasks_.front());
+        tasks_.pop();
+      }
+      task();
+    }
+  }
+
+public:
+  /**
+   * @brief Starts the workers
+   *
+   * @param threads Number of workers, one per core by default
+   */
+  explicit ThreadPool(int threads = std::thread::hardware_concurrency())
+  {
+    for (int i = 0; i < std::max(1, threads); ++i)
+      workers_.emplace_back(&ThreadPool::work, this);
+  }
+
+  ~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      shutdown_ = true;
+    }
+    signal_.notify_all();
+    for (std::thread &worker : workers_)
+      worker.join();
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  int size() const
+  {
+    return workers_.size();
+  }
+
+  /**
+   * @brief Queues a task for the workers
+   *
+   * @param task Anything callable without arguments
+   * @return A future for the task's result. Exceptions thrown by the task come out of get().
+   */
+  template <typename Task>
+  std::future<typename std::result_of<Task()>::type> submit(Task task)
+  {
+    typedef typename std::result_of<Task()>::type Result;
+    auto packaged = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+    std::future<Result> result = packaged->get_future();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push([packaged] { (*packaged)(); });
+    }
+    signal_.notify_one();
+    return result;
+  }
+};
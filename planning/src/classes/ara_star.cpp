@@ -0,0 +1,170 @@
+#include <ara_star.h>
+
+#include <algorithm>
+#include <math.h>
+
+using geometry_msgs::Point;
+using nav_msgs::Path;
+
+// How many cells are expanded between looking at the clock
+#define DEADLINE_CHECK_EXPANSIONS 256
+
+double ARAStar::key(int cell) const
+{
+  return g_[cell] + epsilon_ * distance(cell, goal_, width_);
+}
+
+void ARAStar::start(const nav_msgs::OccupancyGrid &oGrid, const Point target, double epsilon, double epsilonStep, int threshold)
+{
+  int size = oGrid.data.size();
+  width_ = oGrid.info.width;
+  threshold_ = threshold;
+  target_ = target;
+  epsilon_ = std::max(1.0, epsilon);
+  epsilon_step_ = epsilonStep;
+
+  g_.assign(size, INFINITY);
+  came_from_.assign(size, -1);
+  closed_in_.assign(size, 0);
+  search_ = 1;
+  inconsistent_.clear();
+  is_inconsistent_.assign(size, false);
+  open_.reset(size);
+
+  path_ = Path();
+  path_epsilon_ = INFINITY;
+  path_cost_ = INFINITY;
+  expansions_ = 0;
+  done_ = true;
+
+  if (size == 0)
+  {
+    ROS_WARN("Occupancy Grid is Empty.");
+    return;
+  }
+
+  start_ = (oGrid.info.height / 2) * width_ + width_ / 2;
+  goal_ = getTargetIndex(oGrid, target, threshold);
+  if (oGrid.data[goal_] > threshold)
+  {
+    ROS_WARN("TARGET IN OCCUPIED SPACE, UNREACHABLE");
+    return;
+  }
+
+  g_[start_] = 0;
+  open_.push(start_, key(start_));
+  done_ = false;
+}
+
+bool ARAStar::improvePath(const nav_msgs::OccupancyGrid &oGrid, const ros::WallTime &deadline)
+{
+  int sinceCheck = 0;
+  while (!open_.empty() && g_[goal_] > open_.topKey())
+  {
+    if (++sinceCheck == DEADLINE_CHECK_EXPANSIONS)
+    {
+      sinceCheck = 0;
+      if (deadline < ros::WallTime::now())
+        return false;
+    }
+
+    int current = open_.pop();
+    closed_in_[current] = search_;
+    ++expansions_;
+
+    // Same as AStar, occupied cells are never expanded
+    if (oGrid.data[current] >= threshold_)
+      continue;
+
+    for (int neighbor : getNeighborsIndiciesArray(current, width_, oGrid.data.size()))
+    {
+      if (neighbor == -1 || (oGrid.data[neighbor] >= threshold_ && neighbor != goal_))
+        continue;
+
+      double tentative_gscore = g_[current] + distance(current, neighbor, width_);
+      if (tentative_gscore >= g_[neighbor])
+        continue;
+
+      g_[neighbor] = tentative_gscore;
+      came_from_[neighbor] = current;
+
+      // Cells are expanded at most once per search, the ones that improve afterwards wait for the next search
+      if (closed_in_[neighbor] != search_)
+      {
+        open_.push(neighbor, key(neighbor));
+      }
+      else if (!is_inconsistent_[neighbor])
+      {
+        is_inconsistent_[neighbor] = true;
+        inconsistent_.push_back(neighbor);
+      }
+    }
+  }
+
+  return true;
+}
+
+void ARAStar::publishPath(const nav_msgs::OccupancyGrid &oGrid)
+{
+  path_cost_ = g_[goal_];
+  path_epsilon_ = epsilon_;
+
+  // Target first, the robot last and only the corners in between, like AStar::reconstructPath
+  path_ = Path();
+  path_.header = pathHeader(oGrid);
+  path_.poses.push_back(poseStampedFromIndex(goal_, oGrid));
+
+  int last = goal_;
+  for (int current = came_from_[goal_]; current != -1; current = came_from_[current])
+  {
+    int next = came_from_[current];
+    if (next == -1 || !collinear(last, current, next, width_))
+    {
+      path_.poses.push_back(poseStampedFromIndex(current, oGrid));
+      last = current;
+    }
+  }
+}
+
+bool ARAStar::improve(const nav_msgs::OccupancyGrid &oGrid, const ros::WallTime &deadline)
+{
+  while (!done_)
+  {
+    if (!improvePath(oGrid, deadline))
+      return false;
+
+    if (g_[goal_] == INFINITY)
+    {
+      ROS_WARN("[WARNING] Call to navigation failed to find valid path.\n");
+      done_ = true;
+      break;
+    }
+
+    publishPath(oGrid);
+    if (epsilon_ <= 1)
+    {
+      done_ = true;
+      break;
+    }
+
+    // The next search starts from everything still open or improved since it was expanded, with the new keys
+    epsilon_ = epsilon_step_ > 0 ? std::max(1.0, epsilon_ - epsilon_step_) : 1;
+
+    std::vector<int> cells;
+    cells.swap(inconsistent_);
+    for (int cell : cells)
+      is_inconsistent_[cell] = false;
+    while (!open_.empty())
+      cells.push_back(open_.pop());
+    for (int cell : cells)
+      open_.push(cell, key(cell));
+
+    if (++search_ == 0)
+    {
+      std::fill(closed_in_.begin(), closed_in_.end(), 0);
+      search_ = 1;
+    }
+  }
+
+  return true;
+}
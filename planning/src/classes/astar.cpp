@@ -33,22 +33,22 @@ double AStar::distance(int ind1, int ind2, int width)
 
 std::array<int, 8> AStar::getNeighborsIndiciesArray(int pt, int widthOfGrid, int sizeOfGrid)
 {
-  // Get the neighbors around any given index (ternary operators to ensure the points remain within bounds)
+  // Get the neighbors around any given index, -1 for the ones off the grid. Rows are checked first and columns after,
+  // so that cells on the first or last column do not wrap around to the other side of the grid.
   std::array<int, 8> neighbors;
+  int x = pt % widthOfGrid;
 
-  neighbors[0] = ((pt + 1) < 0)               || ((pt + 1) > sizeOfGrid) ? -1               : pt + 1;
-  neighbors[1] = ((pt - 1) < 0)               || ((pt - 1) > sizeOfGrid) ? -1               : pt - 1;
-  neighbors[2] = ((pt + widthOfGrid) < 0)     || ((pt + widthOfGrid) > sizeOfGrid) ? -1     : pt + widthOfGrid;
-  neighbors[3] = ((pt + widthOfGrid + 1) < 0) || ((pt + widthOfGrid + 1) > sizeOfGrid) ? -1 : pt + widthOfGrid + 1;
-  neighbors[4] = ((pt + widthOfGrid - 1) < 0) || ((pt + widthOfGrid - 1) > sizeOfGrid) ? -1 : pt + widthOfGrid - 1;
-  neighbors[5] = ((pt - widthOfGrid) < 0)     || ((pt - widthOfGrid) > sizeOfGrid) ? -1     : pt - widthOfGrid;
-  neighbors[6] = ((pt - widthOfGrid + 1) < 0) || ((pt - widthOfGrid + 1) > sizeOfGrid) ? -1 : pt - widthOfGrid + 1;
-  neighbors[7] = ((pt - widthOfGrid - 1) < 0) || ((pt - widthOfGrid - 1) > sizeOfGrid) ? -1 : pt - widthOfGrid - 1;
+  for (int k = 0; k < PaddedGrid::NEIGHBORS; ++k)
+  {
+    int neighbor = pt + PaddedGrid::DY[k] * widthOfGrid + PaddedGrid::DX[k];
+    bool offGrid = neighbor < 0 || neighbor >= sizeOfGrid || x + PaddedGrid::DX[k] < 0 || x + PaddedGrid::DX[k] >= widthOfGrid;
+    neighbors[k] = offGrid ? -1 : neighbor;
+  }
 
   return neighbors;
 }
 
-inline bool AStar::collinear(int pt1, int pt2, int pt3, int width)
+bool AStar::collinear(int pt1, int pt2, int pt3, int width)
 {
   // Checks if three points lie on the same line.
   int pt1x = pt1 % width;
@@ -75,13 +75,19 @@ PoseStamped AStar::poseStampedFromIndex(int ind, const nav_msgs::OccupancyGrid &
   ps.pose.position.x = (indx - oGrid.info.width / 2) * oGrid.info.resolution;
   ps.pose.position.y = (indy - oGrid.info.height / 2) * oGrid.info.resolution;
 
-  ps.header = oGrid.header;
-  // TODO: Tell albert to properly set the frame id in map generation.
-  ps.header.frame_id = "odom";
+  ps.header = pathHeader(oGrid);
   return ps;
 }
 
-Path AStar::reconstructPath(int current, int last, std::unordered_map<int, int> &reverse_list, const nav_msgs::OccupancyGrid &oGrid)
+std_msgs::Header AStar::pathHeader(const nav_msgs::OccupancyGrid &oGrid)
+{
+  std_msgs::Header header = oGrid.header;
+  // TODO: Tell albert to properly set the frame id in map generation.
+  header.frame_id = "odom";
+  return header;
+}
+
+Path AStar::reconstructPath(int current, int last, const SearchSpace &space, const nav_msgs::OccupancyGrid &oGrid)
 {
   // This function takes the list of nodes generated by A* and converts it into a list of waypoints.
   // It does this by taking the last point and retracing its steps back to the starting point
@@ -92,26 +98,44 @@ Path AStar::reconstructPath(int current, int last, std::unordered_map<int, int>
   PoseStamped firstPs = poseStampedFromIndex(current, oGrid);
   p.poses.push_back(firstPs);
   int lastPt = current;
-  current = reverse_list[current];
+  current = space.cameFrom(current);
 
-  p.header = oGrid.header;
-  // TODO: Tell albert to properly set the frame id in map generation.
-  p.header.frame_id = "odom";
+  p.header = pathHeader(oGrid);
 
   // Loop through the list of node associations backwards. If a node is not collinear with the nodes before and after it, add it to the path.
   while (current != -1)
   {
-    if (!collinear(lastPt, current, reverse_list[current], oGrid.info.width))
+    if (!collinear(lastPt, current, space.cameFrom(current), oGrid.info.width))
       p.poses.push_back(poseStampedFromIndex(current, oGrid));
 
     lastPt = current;
-    current = reverse_list[current];
+    current = space.cameFrom(current);
   }
 
   p.poses.push_back(lastPs);
   return p;
 }
 
+Path AStar::reconstructPath(int current, int last, const SearchSpace &space, const PaddedGrid &grid, const nav_msgs::OccupancyGrid &oGrid)
+{
+  // Same as above, for a search on the padded grid. The corners are picked on padded indices and converted back.
+  Path p;
+  p.header = pathHeader(oGrid);
+  p.poses.push_back(poseStampedFromIndex(grid.toGrid(current), oGrid));
+
+  int lastPt = current;
+  for (current = space.cameFrom(current); current != last && current != -1; current = space.cameFrom(current))
+  {
+    if (!collinear(lastPt, current, space.cameFrom(current), grid.width()))
+      p.poses.push_back(poseStampedFromIndex(grid.toGrid(current), oGrid));
+
+    lastPt = current;
+  }
+
+  p.poses.push_back(poseStampedFromIndex(grid.toGrid(last), oGrid));
+  return p;
+}
+
 float AStar::distGridToPoint(int index, Point p1, int width, int height)
 {
   Point p2;
@@ -123,24 +147,23 @@ float AStar::distGridToPoint(int index, Point p1, int width, int height)
 
 Path AStar::findPathOccGrid(const nav_msgs::OccupancyGrid &oGrid, const Point target, int threshold)
 {
-  if (oGrid.data.size() == 0)
-  {
-    ROS_WARN("Occupancy Grid is Empty.");
-    return Path();
-  }
-  // A Star Implementation based off https://en.wikipedia.org/wiki/A*_search_algorithm
-
-  // Set up the open and closed sets and heuristic scores
-  std::vector<double> gScores(oGrid.data.size(), INFINITY);
+  // Each thread keeps its own search space, so repeated service calls don't reallocate the per-cell arrays
+  static thread_local SearchSpace space;
+  return findPathOccGrid(oGrid, target, space, threshold);
+}
 
+int AStar::getTargetIndex(const nav_msgs::OccupancyGrid &oGrid, const Point target, int threshold)
+{
   int endIndex = 0;
   int centerIndex = (oGrid.info.height / 2) * oGrid.info.width + oGrid.info.width / 2;
 
-  auto origin = std::make_pair<double, int>(0, std::move(centerIndex));
+  // Round to a whole cell in x and y separately, a fractional row would otherwise shift the index along the row
+  int column = lround(target.x) + (int)oGrid.info.width / 2;
+  int row = lround(target.y) + (int)oGrid.info.height / 2;
 
   // Check if the target is outside of the current occupancy grid
   // If it is, we need to find the closest point on the edge of the occupancy grid to the target.
-  if ((int)target.x > (int)oGrid.info.width / 2 || (int)target.x < (int)-(oGrid.info.width / 2) || (int)target.y > (int)oGrid.info.height / 2 || (int)target.y < (int)-(oGrid.info.height / 2))
+  if (column < 0 || column >= (int)oGrid.info.width || row < 0 || row >= (int)oGrid.info.height)
   {
     ROS_WARN("Finding New index...");
     float minDist = INFINITY;
@@ -186,10 +209,25 @@ Path AStar::findPathOccGrid(const nav_msgs::OccupancyGrid &oGrid, const Point ta
   else
   {
     // If the target point was on the grid, just calculate the index of the point (with the center being 0,0)
-    endIndex = (target.y + (oGrid.info.height / 2)) * oGrid.info.width + (target.x + (oGrid.info.width / 2));
+    endIndex = row * oGrid.info.width + column;
     ROS_WARN("Calculated Index: %d", endIndex);
   }
 
+  return endIndex;
+}
+
+Path AStar::findPathOccGrid(const nav_msgs::OccupancyGrid &oGrid, const Point target, SearchSpace &space, int threshold)
+{
+  if (oGrid.data.size() == 0)
+  {
+    ROS_WARN("Occupancy Grid is Empty.");
+    return Path();
+  }
+  // A Star Implementation based off https://en.wikipedia.org/wiki/A*_search_algorithm
+
+  int endIndex = getTargetIndex(oGrid, target, threshold);
+  int centerIndex = (oGrid.info.height / 2) * oGrid.info.width + oGrid.info.width / 2;
+
   // Check if the final destination is occupied.
   if (oGrid.data[endIndex] > threshold)
   {
@@ -197,44 +235,54 @@ Path AStar::findPathOccGrid(const nav_msgs::OccupancyGrid &oGrid, const Point ta
     return Path();
   }
 
-  std::set<std::pair<double, int>> open_set;
-  open_set.insert(origin);
-
-  std::unordered_map<int, int> came_from;
-  came_from[centerIndex] = -1;
+  // The search runs on a copy of the grid with a blocked border, so neighbors never need bounds checks
+  static thread_local PaddedGrid grid;
+  grid.assign(oGrid);
+  const std::array<int, 8> &offsets = grid.offsets();
+  int start = grid.toPadded(centerIndex);
+  int goal = grid.toPadded(endIndex);
 
-  gScores[centerIndex] = 0;
+  // Set up the open list, closed set and scores. All of them are flat arrays indexed by padded grid cell.
+  space.reset(grid.size());
+  space.setScore(start, 0, -1);
+  space.open.push(start, 0);
 
   // Loop through the open set
-  while (!open_set.empty())
+  while (!space.open.empty())
   {
-    auto iter = open_set.lower_bound(std::make_pair<double, int>(0, 0));
-    auto current = *iter;
-    open_set.erase(iter);
+    int current = space.open.pop();
+    space.close(current);
 
     // Check if we hit the target
-    if (current.second == endIndex)
+    if (current == goal)
     {
-      return reconstructPath(current.second, centerIndex, came_from, oGrid);
+      return reconstructPath(current, start, space, grid, oGrid);
     }
 
     // If the node is occupied, we can't travel through it so skip it
-    if (oGrid.data[current.second] >= threshold)
+    if (grid[current] >= threshold)
       continue;
 
+    double current_gscore = space.gScore(current);
+    int current_parent = space.cameFrom(current);
+
     // Search the neighbors, and set the heuristic scores
-    for (int neighbor : getNeighborsIndiciesArray(current.second, oGrid.info.width, oGrid.data.size()))
+    for (int k = 0; k < PaddedGrid::NEIGHBORS; ++k)
     {
-      if (neighbor == -1)
+      int neighbor = current + offsets[k];
+      if (space.isClosed(neighbor))
+        continue;
+
+      // Occupied nodes are never expanded, so only queue them if they are the target. The border is always occupied.
+      if (grid[neighbor] >= threshold && neighbor != goal)
         continue;
 
-      double tentative_gscore = gScores[current.second] + distance(current.second, neighbor, oGrid.info.width);
-      if (collinear(neighbor, current.second, came_from[current.second], oGrid.info.width)) tentative_gscore -= .95; // bias towards straight lines
-      if (tentative_gscore < gScores[neighbor])
+      double tentative_gscore = current_gscore + PaddedGrid::STEP_COST[k];
+      if (current_parent != -1 && current - current_parent == offsets[k]) tentative_gscore -= .95; // bias towards straight lines
+      if (tentative_gscore < space.gScore(neighbor))
       {
-        gScores[neighbor] = tentative_gscore;
-        came_from[neighbor] = current.second;
-        open_set.insert(std::make_pair<double, int>((tentative_gscore + distance(neighbor, endIndex, oGrid.info.width)), std::move(neighbor)));
+        space.setScore(neighbor, tentative_gscore, current);
+        space.open.push(neighbor, tentative_gscore + distance(neighbor, goal, grid.width()));
       }
     }
   }
@@ -0,0 +1,133 @@
+#include <bidirectional_astar.h>
+#include <ros/ros.h>
+
+#include <algorithm>
+#include <math.h>
+
+using geometry_msgs::Point;
+using nav_msgs::Path;
+
+Path BidirectionalAStar::reconstructPath(int meet, const SearchSpace &forward, const SearchSpace &backward, const PaddedGrid &grid,
+                                         const nav_msgs::OccupancyGrid &oGrid)
+{
+  // Target to meeting point along the backward parents, then on to the robot along the forward ones
+  std::vector<int> cells;
+  for (int cell = meet; cell != -1; cell = backward.cameFrom(cell))
+    cells.push_back(grid.toGrid(cell));
+  std::reverse(cells.begin(), cells.end());
+  for (int cell = forward.cameFrom(meet); cell != -1; cell = forward.cameFrom(cell))
+    cells.push_back(grid.toGrid(cell));
+
+  Path p;
+  p.header = pathHeader(oGrid);
+
+  // Only the corners in between the two ends, like AStar::reconstructPath
+  for (int i = 0; i < (int)cells.size(); ++i)
+  {
+    if (i == 0 || i == (int)cells.size() - 1 || !collinear(cells[i - 1], cells[i], cells[i + 1], oGrid.info.width))
+      p.poses.push_back(poseStampedFromIndex(cells[i], oGrid));
+  }
+
+  return p;
+}
+
+Path BidirectionalAStar::findPathOccGrid(const nav_msgs::OccupancyGrid &oGrid, const Point target, int threshold)
+{
+  static thread_local SearchSpace forward, backward;
+  return findPathOccGrid(oGrid, target, forward, backward, threshold);
+}
+
+Path BidirectionalAStar::findPathOccGrid(const nav_msgs::OccupancyGrid &oGrid, const Point target, SearchSpace &forward, SearchSpace &backward, int threshold)
+{
+  if (oGrid.data.size() == 0)
+  {
+    ROS_WARN("Occupancy Grid is Empty.");
+    return Path();
+  }
+
+  int width = oGrid.info.width;
+  int endIndex = getTargetIndex(oGrid, target, threshold);
+  int centerIndex = (oGrid.info.height / 2) * width + width / 2;
+
+  if (oGrid.data[endIndex] > threshold)
+  {
+    ROS_WARN("TARGET IN OCCUPIED SPACE, UNREACHABLE");
+    return Path();
+  }
+
+  // Both searches run on the padded grid, like AStar
+  static thread_local PaddedGrid grid;
+  grid.assign(oGrid);
+  const std::array<int, 8> &offsets = grid.offsets();
+  int start = grid.toPadded(centerIndex);
+  int goal = grid.toPadded(endIndex);
+
+  // Average of the two front-to-end heuristics. The forward search uses it and the backward search its negative, so
+  // both are consistent and the keys of a cell on each side add up to the length of the path through it.
+  auto potential = [&](int cell) { return (distance(cell, goal, grid.width()) - distance(cell, start, grid.width())) / 2; };
+
+  forward.reset(grid.size());
+  backward.reset(grid.size());
+  forward.setScore(start, 0, -1);
+  forward.open.push(start, potential(start));
+  backward.setScore(goal, 0, -1);
+  backward.open.push(goal, -potential(goal));
+
+  if (start == goal)
+    return reconstructPath(start, forward, backward, grid, oGrid);
+
+  // Cost of the best path through a cell reached from both sides, and that cell
+  double best = INFINITY;
+  int meet = -1;
+
+  while (!forward.open.empty() && !backward.open.empty())
+  {
+    // No path through the cells still open can beat the best one found
+    if (best <= forward.open.topKey() + backward.open.topKey())
+      break;
+
+    bool fromRobot = forward.open.size() <= backward.open.size();
+    SearchSpace &space = fromRobot ? forward : backward;
+    const SearchSpace &other = fromRobot ? backward : forward;
+    double side = fromRobot ? 1 : -1;
+
+    int current = space.open.pop();
+    space.close(current);
+
+    // Occupied cells are never expanded, but the two ends are always entered like in AStar. The border is never entered.
+    if (grid[current] >= threshold && current != goal && current != start)
+      continue;
+
+    double current_gscore = space.gScore(current);
+    for (int k = 0; k < PaddedGrid::NEIGHBORS; ++k)
+    {
+      int neighbor = current + offsets[k];
+      if (space.isClosed(neighbor))
+        continue;
+      if (grid[neighbor] >= threshold && neighbor != goal && neighbor != start)
+        continue;
+
+      double tentative_gscore = current_gscore + PaddedGrid::STEP_COST[k];
+      if (tentative_gscore >= space.gScore(neighbor))
+        continue;
+
+      space.setScore(neighbor, tentative_gscore, current);
+      space.open.push(neighbor, tentative_gscore + side * potential(neighbor));
+
+      double through = tentative_gscore + other.gScore(neighbor);
+      if (through < best)
+      {
+        best = through;
+        meet = neighbor;
+      }
+    }
+  }
+
+  if (meet == -1)
+  {
+    ROS_WARN("[WARNING] Call to navigation failed to find valid path.\n");
+    return Path();
+  }
+
+  return reconstructPath(meet, forward, backward, grid, oGrid);
+}
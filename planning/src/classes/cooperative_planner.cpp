@@ -0,0 +1,214 @@
+#include <cooperative_planner.h>
+#include <multi_goal.h>
+#include <ros/ros.h>
+
+#include <algorithm>
+#include <math.h>
+#include <queue>
+#include <unordered_set>
+
+void CooperativePlanner::ReservationTable::reserve(const std::vector<int> &path, int robot, int steps)
+{
+  int size = width_ * height_;
+  bool arrives = (int)path.size() <= steps;
+
+  for (int t = 0; t < std::min(steps, (int)path.size()); ++t)
+  {
+    int x = path[t] % width_, y = path[t] / width_;
+    bool parks = arrives && t == (int)path.size() - 1;
+
+    for (int dy = -radius_; dy <= radius_; ++dy)
+    {
+      for (int dx = -radius_; dx <= radius_; ++dx)
+      {
+        if (x + dx < 0 || y + dy < 0 || x + dx >= width_ || y + dy >= height_)
+          continue;
+
+        int cell = (y + dy) * width_ + x + dx;
+        if (parks)
+          parked_[cell] = {robot, t};
+        else
+          reserved_[(int64_t)t * size + cell] = robot;
+      }
+    }
+  }
+}
+
+bool CooperativePlanner::ReservationTable::free(int cell, int step, int robot) const
+{
+  auto reserved = reserved_.find((int64_t)step * width_ * height_ + cell);
+  if (reserved != reserved_.end() && reserved->second != robot)
+    return false;
+
+  auto parked = parked_.find(cell);
+  return parked == parked_.end() || parked->second.first == robot || step < parked->second.second;
+}
+
+void CooperativePlanner::followSweep(int cell, const SearchSpace &toGoal, std::vector<int> &path)
+{
+  for (int current = toGoal.cameFrom(cell); current != -1; current = toGoal.cameFrom(current))
+    path.push_back(current);
+}
+
+std::vector<int> CooperativePlanner::planWindow(const nav_msgs::OccupancyGrid &oGrid, int start, int goal, int robot, const SearchSpace &toGoal,
+                                                const ReservationTable &reservations, int window, int threshold)
+{
+  int width = oGrid.info.width;
+  int height = oGrid.info.height;
+  int64_t size = oGrid.data.size();
+
+  // The space-time states are few compared to cells times steps, so they are kept in hash maps keyed on step * size + cell
+  struct Node
+  {
+    double g_score;
+    int64_t came_from;
+  };
+  std::unordered_map<int64_t, Node> nodes;
+  std::unordered_set<int64_t> closed;
+  typedef std::pair<double, int64_t> Entry;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+
+  nodes[start] = {0, -1};
+  open.push({toGoal.gScore(start), start});
+
+  auto enterable = [&](int x, int y) {
+    if (x < 0 || y < 0 || x >= width || y >= height)
+      return false;
+    int cell = y * width + x;
+    return oGrid.data[cell] < threshold || cell == goal;
+  };
+
+  int64_t last = -1;
+  while (!open.empty())
+  {
+    int64_t current = open.top().second;
+    open.pop();
+    if (!closed.insert(current).second)
+      continue;
+
+    int cell = current % size;
+    int step = current / size;
+
+    // Done once the robot can stay on its goal for the rest of the window, or at the end of the window
+    if (cell == goal)
+    {
+      bool stays = true;
+      for (int t = step + 1; t <= window && stays; ++t)
+        stays = reservations.free(goal, t, robot);
+      if (stays)
+      {
+        last = current;
+        break;
+      }
+    }
+    if (step == window)
+    {
+      last = current;
+      break;
+    }
+
+    int x = cell % width;
+    int y = cell / width;
+    double current_gscore = nodes[current].g_score;
+
+    for (int dy = -1; dy <= 1; ++dy)
+    {
+      for (int dx = -1; dx <= 1; ++dx)
+      {
+        // Waiting in place is a move too
+        bool wait = dx == 0 && dy == 0;
+        if (!wait && !enterable(x + dx, y + dy))
+          continue;
+        if (dx != 0 && dy != 0 && (!enterable(x + dx, y) || !enterable(x, y + dy)))
+          continue;
+
+        int neighbor_cell = cell + dy * width + dx;
+        double h = toGoal.gScore(neighbor_cell);
+        if (h == INFINITY || !reservations.free(neighbor_cell, step + 1, robot))
+          continue;
+
+        int64_t neighbor = (step + 1) * size + neighbor_cell;
+        if (closed.count(neighbor))
+          continue;
+
+        double tentative_gscore = current_gscore + (dx != 0 && dy != 0 ? M_SQRT2 : 1);
+        auto found = nodes.find(neighbor);
+        if (found == nodes.end() || tentative_gscore < found->second.g_score)
+        {
+          nodes[neighbor] = {tentative_gscore, current};
+          open.push({tentative_gscore + h, neighbor});
+        }
+      }
+    }
+  }
+
+  if (last == -1)
+    return {};
+
+  std::vector<int> path;
+  for (int64_t current = last; current != -1; current = nodes[current].came_from)
+    path.push_back(current % size);
+  std::reverse(path.begin(), path.end());
+
+  // Past the window, the robot takes its own shortest path
+  followSweep(path.back(), toGoal, path);
+  return path;
+}
+
+std::vector<std::vector<int>> CooperativePlanner::planPaths(const nav_msgs::OccupancyGrid &oGrid, const std::vector<int> &starts, const std::vector<int> &goals,
+                                                            ThreadPool &pool, int separation, int window, int threshold)
+{
+  int robots = starts.size();
+  int width = oGrid.info.width;
+  int size = oGrid.data.size();
+
+  // Every robot's own shortest path, in parallel
+  std::vector<std::vector<int>> paths(robots);
+  std::vector<SearchSpace> toGoal(robots);
+  std::vector<std::future<void>> sweeps;
+  for (int i = 0; i < robots; ++i)
+  {
+    if (starts[i] < 0 || starts[i] >= size || goals[i] < 0 || goals[i] >= size)
+      continue;
+
+    sweeps.push_back(pool.submit([&, i] {
+      MultiGoal::sweep(oGrid, goals[i], {}, toGoal[i], threshold);
+      if (toGoal[i].gScore(starts[i]) == INFINITY)
+        return;
+
+      paths[i].push_back(starts[i]);
+      followSweep(starts[i], toGoal[i], paths[i]);
+    }));
+  }
+  for (std::future<void> &sweep : sweeps)
+    sweep.get();
+
+  // In priority order, every robot keeps its own path if it stays clear of the robots before it, and is planned
+  // around them otherwise. Robots after it never change its path.
+  auto at = [&](int robot, int step) { return paths[robot][std::min(step, (int)paths[robot].size() - 1)]; };
+  ReservationTable reservations(width, oGrid.info.height, separation);
+  for (int i = 0; i < robots; ++i)
+  {
+    if (paths[i].empty())
+      continue;
+
+    bool clear = true;
+    for (int t = 1; t <= window && clear; ++t)
+      clear = reservations.free(at(i, t), t, i);
+    if (clear)
+    {
+      reservations.reserve(paths[i], i, window + 1);
+      continue;
+    }
+
+    std::vector<int> path = planWindow(oGrid, starts[i], goals[i], i, toGoal[i], reservations, window, threshold);
+    if (path.empty())
+      ROS_WARN("Robot %d can't keep clear of the others, using its own path.", i);
+    else
+      paths[i] = path;
+
+    reservations.reserve(paths[i], i, window + 1);
+  }
+
+  return paths;
+}
@@ -0,0 +1,104 @@
+#include <costmap.h>
+
+#include <algorithm>
+#include <math.h>
+
+using nav_msgs::OccupancyGrid;
+
+const int Costmap::LETHAL_COST;
+
+OccupancyGrid Costmap::obstacleLayer(const OccupancyGrid &oGrid, int threshold)
+{
+  OccupancyGrid layer;
+  layer.header = oGrid.header;
+  layer.info = oGrid.info;
+  layer.data.resize(oGrid.data.size());
+
+  for (size_t i = 0; i < oGrid.data.size(); ++i)
+    layer.data[i] = oGrid.data[i] >= threshold ? LETHAL_COST : std::max<int8_t>(oGrid.data[i], 0);
+
+  return layer;
+}
+
+OccupancyGrid Costmap::inflationLayer(const OccupancyGrid &oGrid, const std::vector<float> &distanceField, double inscribedRadius,
+                                      double inflationRadius, int maxCost)
+{
+  OccupancyGrid layer;
+  layer.header = oGrid.header;
+  layer.info = oGrid.info;
+  layer.data.assign(oGrid.data.size(), 0);
+
+  // Decays to about 1% of maxCost at the inflation radius
+  double decay = inflationRadius > inscribedRadius ? log(100.0) / (inflationRadius - inscribedRadius) : 0;
+
+  for (size_t i = 0; i < distanceField.size() && i < layer.data.size(); ++i)
+  {
+    float distance = distanceField[i];
+    if (distance >= inflationRadius)
+      continue;
+
+    layer.data[i] = distance <= inscribedRadius ? maxCost : lround(maxCost * exp(-decay * (distance - inscribedRadius)));
+  }
+
+  return layer;
+}
+
+OccupancyGrid Costmap::slopeLayer(const OccupancyGrid &oGrid, const std::vector<float> &heights, double maxSlope, double maxRoughness, int maxCost)
+{
+  int width = oGrid.info.width;
+  int height = oGrid.info.height;
+  double resolution = oGrid.info.resolution;
+
+  OccupancyGrid layer;
+  layer.header = oGrid.header;
+  layer.info = oGrid.info;
+  layer.data.assign(oGrid.data.size(), 0);
+
+  if ((int)heights.size() != width * height)
+    return layer;
+
+  // The edges of the map don't have all their neighbors, they are left at 0
+  for (int y = 1; y < height - 1; ++y)
+  {
+    for (int x = 1; x < width - 1; ++x)
+    {
+      int i = y * width + x;
+      if (std::isnan(heights[i]))
+        continue;
+
+      // Slope from central differences, roughness from how far the cell sits off the average of its known neighbors
+      double gx = (heights[i + 1] - heights[i - 1]) / (2 * resolution);
+      double gy = (heights[i + width] - heights[i - width]) / (2 * resolution);
+      double slope = std::isnan(gx) || std::isnan(gy) ? 0 : atan(hypot(gx, gy));
+
+      double sum = 0;
+      int known = 0;
+      for (int dy = -1; dy <= 1; ++dy)
+      {
+        for (int dx = -1; dx <= 1; ++dx)
+        {
+          float neighbor = heights[i + dy * width + dx];
+          if ((dx != 0 || dy != 0) && !std::isnan(neighbor))
+          {
+            sum += neighbor;
+            ++known;
+          }
+        }
+      }
+      double roughness = known > 0 ? fabs(heights[i] - sum / known) : 0;
+
+      if (slope >= maxSlope || roughness >= maxRoughness)
+        layer.data[i] = LETHAL_COST;
+      else
+        layer.data[i] = lround(maxCost * std::max(slope / maxSlope, roughness / maxRoughness));
+    }
+  }
+
+  return layer;
+}
+
+void Costmap::combine(OccupancyGrid &costmap, const OccupancyGrid &layer)
+{
+  for (size_t i = 0; i < costmap.data.size() && i < layer.data.size(); ++i)
+    costmap.data[i] = std::max(costmap.data[i], layer.data[i]);
+}
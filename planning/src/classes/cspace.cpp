@@ -1,59 +1,259 @@
 #include <ros/ros.h>
 #include <cspace.h>
+#include <cspace_kernels.h>
 #include <geometry_msgs/Point.h>
 
+#include <algorithm>
+#include <math.h>
+
 using geometry_msgs::Point;
 using nav_msgs::OccupancyGrid;
 
-std::array<int, 8> CSpace::getNeighborsIndiciesArray(int pt, int widthOfGrid, int sizeOfGrid)
+// Stand-in for an infinite squared distance. Kept finite so the parabola intersections never compute inf - inf.
+#define FAR_SQ_DISTANCE 1e20f
+
+// Side of the square tiles changes are tracked in by updateCSpace, in cells
+#define CSPACE_TILE 16
+
+void CSpace::distanceTransform1D(const float *f, float *d, int n, int *v, float *z)
 {
-  // Get the neighbors around any given index (ternary operators to ensure the points remain within bounds)
-  std::array<int, 8> neighbors;
-
-  neighbors[0] = ((pt + 1) < 0)               || ((pt + 1) > sizeOfGrid) 								? -1 : pt + 1;
-  neighbors[1] = ((pt - 1) < 0)               || ((pt - 1) > sizeOfGrid) 								? -1 : pt - 1;
-  neighbors[2] = ((pt + widthOfGrid    ) < 0) || ((pt + widthOfGrid) > sizeOfGrid) 			? -1 : pt + widthOfGrid;
-  neighbors[3] = ((pt + widthOfGrid + 1) < 0) || !((pt + widthOfGrid + 1) > sizeOfGrid) ? -1 : pt + widthOfGrid + 1;
-  neighbors[4] = ((pt + widthOfGrid - 1) < 0) || !((pt + widthOfGrid - 1) > sizeOfGrid) ? -1 : pt + widthOfGrid - 1;
-  neighbors[5] = ((pt - widthOfGrid) < 0)     || !((pt - widthOfGrid) > sizeOfGrid) 		? -1 : pt - widthOfGrid;
-  neighbors[6] = ((pt - widthOfGrid + 1) < 0) || !((pt - widthOfGrid + 1) > sizeOfGrid) ? -1 : pt - widthOfGrid + 1;
-  neighbors[7] = ((pt - widthOfGrid - 1) < 0) || !((pt - widthOfGrid - 1) > sizeOfGrid) ? -1 : pt - widthOfGrid - 1;
-
-  return neighbors;
+	// Lower envelope of the parabolas rooted at each sample
+	int k = 0;
+	v[0] = 0;
+	z[0] = -INFINITY;
+	z[1] = INFINITY;
+
+	for (int q = 1; q < n; ++q)
+	{
+		float s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+		while (s <= z[k])
+		{
+			--k;
+			s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+		}
+		++k;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = INFINITY;
+	}
+
+	// Read the envelope back out
+	k = 0;
+	for (int q = 0; q < n; ++q)
+	{
+		while (z[k + 1] < q)
+			++k;
+		d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+	}
 }
 
-void CSpace::recursiveSearchNeighbors(const int pt, const int radius, const int threshold, OccupancyGrid &editGrid, OccupancyGrid &searchGrid)
+void CSpace::distanceFieldWindow(const OccupancyGrid &oGrid, const int threshold, int x0, int y0, int w, int h, float *field)
 {
-	if (radius > 0)
+	int width = oGrid.info.width;
+
+	int longest = std::max(w, h);
+	std::vector<float> f(longest), d(longest), z(longest + 1);
+	std::vector<int> v(longest);
+
+	std::vector<uint8_t> obstacles(w * h);
+	for (int y = 0; y < h; ++y)
+		CSpaceKernels::get().obstacleMask(&oGrid.data[(y0 + y) * width + x0], &obstacles[y * w], w, threshold);
+
+	// First pass down the columns, on the obstacle indicator function
+	for (int x = 0; x < w; ++x)
+	{
+		for (int y = 0; y < h; ++y)
+			f[y] = obstacles[y * w + x] ? 0 : FAR_SQ_DISTANCE;
+
+		distanceTransform1D(f.data(), d.data(), h, v.data(), z.data());
+
+		for (int y = 0; y < h; ++y)
+			field[y * w + x] = d[y];
+	}
+
+	// Second pass along the rows, on the squared column distances, gives the exact 2D squared distance
+	for (int y = 0; y < h; ++y)
 	{
-		auto neighbors = getNeighborsIndiciesArray(pt, editGrid.info.width, editGrid.data.size());
-		for (int i = 0; i < neighbors.size(); ++i)
+		float *row = &field[y * w];
+		std::copy(row, row + w, f.begin());
+
+		distanceTransform1D(f.data(), row, w, v.data(), z.data());
+
+		for (int x = 0; x < w; ++x)
+			row[x] = row[x] >= FAR_SQ_DISTANCE ? INFINITY : sqrtf(row[x]);
+	}
+}
+
+std::vector<float> CSpace::getDistanceField(const OccupancyGrid &oGrid, const int threshold)
+{
+	std::vector<float> field(oGrid.data.size());
+	if (!field.empty())
+		distanceFieldWindow(oGrid, threshold, 0, 0, oGrid.info.width, oGrid.info.height, field.data());
+	return field;
+}
+
+OccupancyGrid CSpace::getCSpace(const nav_msgs::OccupancyGrid &oGrid, const int threshold, const int radius)
+{
+	std::vector<float> distanceField;
+	return getCSpace(oGrid, threshold, radius, distanceField);
+}
+
+OccupancyGrid CSpace::getCSpace(const nav_msgs::OccupancyGrid &oGrid, const int threshold, const int radius, std::vector<float> &distanceField)
+{
+	OccupancyGrid paddedGrid;
+	paddedGrid.header = oGrid.header;
+	paddedGrid.info = oGrid.info;
+	paddedGrid.data.resize(oGrid.data.size());
+
+	distanceField = getDistanceField(oGrid, threshold);
+
+	// Obstacles keep their own value, everything else within the radius of one is padded
+	CSpaceKernels::get().padFromDistance(oGrid.data.data(), distanceField.data(), paddedGrid.data.data(), oGrid.data.size(), threshold, radius);
+
+	paddedGrid.header.frame_id = "odom";
+	return paddedGrid;
+}
+
+int CSpace::updateCSpace(const OccupancyGrid &previousGrid, const OccupancyGrid &oGrid, const int threshold, const int radius, OccupancyGrid &cspace, std::vector<float> &distanceField, const int exactDistance)
+{
+	int width = oGrid.info.width;
+	int height = oGrid.info.height;
+	int size = oGrid.data.size();
+
+	// Anything we can't line up cell for cell with the new map gets rebuilt from scratch
+	if (previousGrid.info.width != oGrid.info.width || previousGrid.info.height != oGrid.info.height ||
+			(int)previousGrid.data.size() != size || (int)cspace.data.size() != size || (int)distanceField.size() != size)
+	{
+		cspace = getCSpace(oGrid, threshold, radius, distanceField);
+		return size;
+	}
+
+	const CSpaceKernels::Table &kernels = CSpaceKernels::get();
+	cspace.header = oGrid.header;
+	cspace.info = oGrid.info;
+	cspace.header.frame_id = "odom";
+
+	// Cells whose obstacle state flipped mark their tile dirty. Cells that only changed value just need repadding.
+	int tilesX = (width + CSPACE_TILE - 1) / CSPACE_TILE;
+	int tilesY = (height + CSPACE_TILE - 1) / CSPACE_TILE;
+	std::vector<bool> dirty(tilesX * tilesY, false);
+	std::vector<int> repad;
+	int dirtyTiles = 0;
+
+	for (int y = 0; y < height; ++y)
+	{
+		const int8_t *before = &previousGrid.data[y * width];
+		const int8_t *after = &oGrid.data[y * width];
+		if (std::equal(after, after + width, before))
+			continue;
+
+		for (int x = 0; x < width; ++x)
 		{
-			if(neighbors[i] == -1)
+			if (after[x] == before[x])
 				continue;
 
-			editGrid.data[neighbors[i]] = 100;
-			recursiveSearchNeighbors(neighbors[i], radius - 1, threshold, editGrid, searchGrid);
+			if ((after[x] > threshold) != (before[x] > threshold))
+			{
+				int tile = (y / CSPACE_TILE) * tilesX + x / CSPACE_TILE;
+				if (!dirty[tile])
+				{
+					dirty[tile] = true;
+					++dirtyTiles;
+				}
+			}
+			else
+			{
+				repad.push_back(y * width + x);
+			}
 		}
 	}
-}
 
-OccupancyGrid CSpace::getCSpace(nav_msgs::OccupancyGrid &oGrid, const int threshold, const int radius)
-{
+	// Past this point the overlapping windows cost more than inflating the whole map
+	if (dirtyTiles * 2 > tilesX * tilesY)
+	{
+		cspace = getCSpace(oGrid, threshold, radius, distanceField);
+		return size;
+	}
+
+	for (int index : repad)
+		kernels.padFromDistance(&oGrid.data[index], &distanceField[index], &cspace.data[index], 1, threshold, radius);
+	int recomputed = repad.size();
 
-	OccupancyGrid paddedGrid = oGrid;
+	// A changed obstacle can only move distances up to the margin within the margin of itself. Each run of dirty tiles
+	// along a tile row becomes one box grown by the margin, and its distances are computed on a window grown by the
+	// margin again, so every obstacle that could be the closest one to a cell in the box is in the window.
+	int margin = std::max(radius, exactDistance);
+	std::vector<float> window;
 
-	for (int i = 0; i < oGrid.data.size(); ++i)
+	for (int ty = 0; ty < tilesY; ++ty)
 	{
-		if (oGrid.data[i] > threshold)
+		for (int tx = 0; tx < tilesX; ++tx)
 		{
-			recursiveSearchNeighbors(i, radius, threshold, paddedGrid, oGrid);
+			if (!dirty[ty * tilesX + tx])
+				continue;
+
+			int runEnd = tx;
+			while (runEnd + 1 < tilesX && dirty[ty * tilesX + runEnd + 1])
+				++runEnd;
+
+			int boxX0 = std::max(0, tx * CSPACE_TILE - margin);
+			int boxY0 = std::max(0, ty * CSPACE_TILE - margin);
+			int boxX1 = std::min(width, (runEnd + 1) * CSPACE_TILE + margin);
+			int boxY1 = std::min(height, (ty + 1) * CSPACE_TILE + margin);
+
+			int winX0 = std::max(0, boxX0 - margin);
+			int winY0 = std::max(0, boxY0 - margin);
+			int winX1 = std::min(width, boxX1 + margin);
+			int winY1 = std::min(height, boxY1 + margin);
+			int winW = winX1 - winX0;
+
+			window.resize(winW * (winY1 - winY0));
+			distanceFieldWindow(oGrid, threshold, winX0, winY0, winW, winY1 - winY0, window.data());
+
+			int boxW = boxX1 - boxX0;
+			for (int y = boxY0; y < boxY1; ++y)
+			{
+				int index = y * width + boxX0;
+				const float *local = &window[(y - winY0) * winW + (boxX0 - winX0)];
+				std::copy(local, local + boxW, &distanceField[index]);
+				kernels.padFromDistance(&oGrid.data[index], &distanceField[index], &cspace.data[index], boxW, threshold, radius);
+			}
+			recomputed += boxW * (boxY1 - boxY0);
+
+			tx = runEnd;
 		}
-		if (oGrid.data[i] == -1)
-			paddedGrid.data[i] = 0;
 	}
 
+	return recomputed;
+}
 
-	paddedGrid.header.frame_id = "odom";
-	return paddedGrid;
-}
\ No newline at end of file
+OccupancyGrid CSpace::getDilatedGrid(const nav_msgs::OccupancyGrid &oGrid, const int radius)
+{
+	const CSpaceKernels::Table &kernels = CSpaceKernels::get();
+	int width = oGrid.info.width;
+	int height = oGrid.info.height;
+
+	OccupancyGrid dilatedGrid;
+	dilatedGrid.header = oGrid.header;
+	dilatedGrid.info = oGrid.info;
+	dilatedGrid.data.resize(oGrid.data.size());
+
+	// The square max filter is separable, first along the rows...
+	std::vector<int8_t> rows(oGrid.data.size());
+	for (int y = 0; y < height; ++y)
+		kernels.maxFilterRow(&oGrid.data[y * width], &rows[y * width], width, radius);
+
+	// ...then down the columns, one whole row at a time
+	for (int y = 0; y < height; ++y)
+	{
+		int8_t *out = &dilatedGrid.data[y * width];
+		int first = std::max(0, y - radius);
+		int last = std::min(height - 1, y + radius);
+
+		std::copy(&rows[first * width], &rows[first * width] + width, out);
+		for (int k = first + 1; k <= last; ++k)
+			kernels.maxRows(out, &rows[k * width], out, width);
+	}
+
+	return dilatedGrid;
+}
@@ -0,0 +1,257 @@
+#include <cspace_kernels.h>
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CSPACE_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+/*******************************************************************/
+/************************** S C A L A R ****************************/
+/*******************************************************************/
+
+static void obstacleMaskScalar(const int8_t *src, uint8_t *mask, int n, int threshold)
+{
+  for (int i = 0; i < n; ++i)
+    mask[i] = src[i] > threshold;
+}
+
+static inline int8_t padCell(int8_t src, float distance, int threshold, float radius)
+{
+  if (src > threshold)
+    return src;
+  if (distance <= radius)
+    return 100;
+  return src == -1 ? 0 : src;
+}
+
+static void padFromDistanceScalar(const int8_t *src, const float *distance, int8_t *dst, int n, int threshold, float radius)
+{
+  for (int i = 0; i < n; ++i)
+    dst[i] = padCell(src[i], distance[i], threshold, radius);
+}
+
+static inline int8_t windowMax(const int8_t *src, int i, int n, int radius)
+{
+  int8_t m = src[i];
+  for (int k = std::max(0, i - radius); k <= std::min(n - 1, i + radius); ++k)
+    m = std::max(m, src[k]);
+  return m;
+}
+
+static void maxFilterRowScalar(const int8_t *src, int8_t *dst, int n, int radius)
+{
+  for (int i = 0; i < n; ++i)
+    dst[i] = windowMax(src, i, n, radius);
+}
+
+static void maxRowsScalar(const int8_t *a, const int8_t *b, int8_t *dst, int n)
+{
+  for (int i = 0; i < n; ++i)
+    dst[i] = std::max(a[i], b[i]);
+}
+
+#ifdef CSPACE_KERNELS_X86
+
+/*******************************************************************/
+/************************** S S E 4 . 1 ****************************/
+/*******************************************************************/
+
+__attribute__((target("sse4.1"))) static void obstacleMaskSSE41(const int8_t *src, uint8_t *mask, int n, int threshold)
+{
+  const __m128i thr = _mm_set1_epi8((int8_t)threshold);
+  const __m128i one = _mm_set1_epi8(1);
+  int i = 0;
+  for (; i + 16 <= n; i += 16)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+    _mm_storeu_si128((__m128i *)(mask + i), _mm_and_si128(_mm_cmpgt_epi8(v, thr), one));
+  }
+  obstacleMaskScalar(src + i, mask + i, n - i, threshold);
+}
+
+__attribute__((target("sse4.1"))) static void padFromDistanceSSE41(const int8_t *src, const float *distance, int8_t *dst, int n, int threshold, float radius)
+{
+  const __m128i thr = _mm_set1_epi8((int8_t)threshold);
+  const __m128i unknown = _mm_set1_epi8(-1);
+  const __m128i occupied = _mm_set1_epi8(100);
+  const __m128 rad = _mm_set1_ps(radius);
+  int i = 0;
+  for (; i + 16 <= n; i += 16)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+
+    // Four float compares packed down to one byte mask, the order stays intact on 128 bit registers
+    __m128i d0 = _mm_castps_si128(_mm_cmple_ps(_mm_loadu_ps(distance + i), rad));
+    __m128i d1 = _mm_castps_si128(_mm_cmple_ps(_mm_loadu_ps(distance + i + 4), rad));
+    __m128i d2 = _mm_castps_si128(_mm_cmple_ps(_mm_loadu_ps(distance + i + 8), rad));
+    __m128i d3 = _mm_castps_si128(_mm_cmple_ps(_mm_loadu_ps(distance + i + 12), rad));
+    __m128i within = _mm_packs_epi16(_mm_packs_epi32(d0, d1), _mm_packs_epi32(d2, d3));
+
+    __m128i out = _mm_andnot_si128(_mm_cmpeq_epi8(v, unknown), v);
+    out = _mm_blendv_epi8(out, occupied, within);
+    out = _mm_blendv_epi8(out, v, _mm_cmpgt_epi8(v, thr));
+    _mm_storeu_si128((__m128i *)(dst + i), out);
+  }
+  padFromDistanceScalar(src + i, distance + i, dst + i, n - i, threshold, radius);
+}
+
+__attribute__((target("sse4.1"))) static void maxFilterRowSSE41(const int8_t *src, int8_t *dst, int n, int radius)
+{
+  // Edges where the window is clamped are done in scalar code
+  int i = 0;
+  for (; i < std::min(radius, n); ++i)
+    dst[i] = windowMax(src, i, n, radius);
+
+  for (; i + 16 + radius <= n; i += 16)
+  {
+    __m128i m = _mm_loadu_si128((const __m128i *)(src + i - radius));
+    for (int k = -radius + 1; k <= radius; ++k)
+      m = _mm_max_epi8(m, _mm_loadu_si128((const __m128i *)(src + i + k)));
+    _mm_storeu_si128((__m128i *)(dst + i), m);
+  }
+
+  for (; i < n; ++i)
+    dst[i] = windowMax(src, i, n, radius);
+}
+
+__attribute__((target("sse4.1"))) static void maxRowsSSE41(const int8_t *a, const int8_t *b, int8_t *dst, int n)
+{
+  int i = 0;
+  for (; i + 16 <= n; i += 16)
+  {
+    __m128i m = _mm_max_epi8(_mm_loadu_si128((const __m128i *)(a + i)), _mm_loadu_si128((const __m128i *)(b + i)));
+    _mm_storeu_si128((__m128i *)(dst + i), m);
+  }
+  maxRowsScalar(a + i, b + i, dst + i, n - i);
+}
+
+/*******************************************************************/
+/***************************** A V X 2 *****************************/
+/*******************************************************************/
+
+__attribute__((target("avx2"))) static void obstacleMaskAVX2(const int8_t *src, uint8_t *mask, int n, int threshold)
+{
+  const __m256i thr = _mm256_set1_epi8((int8_t)threshold);
+  const __m256i one = _mm256_set1_epi8(1);
+  int i = 0;
+  for (; i + 32 <= n; i += 32)
+  {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(src + i));
+    _mm256_storeu_si256((__m256i *)(mask + i), _mm256_and_si256(_mm256_cmpgt_epi8(v, thr), one));
+  }
+  obstacleMaskScalar(src + i, mask + i, n - i, threshold);
+}
+
+__attribute__((target("avx2"))) static void padFromDistanceAVX2(const int8_t *src, const float *distance, int8_t *dst, int n, int threshold, float radius)
+{
+  const __m256i thr = _mm256_set1_epi8((int8_t)threshold);
+  const __m256i unknown = _mm256_set1_epi8(-1);
+  const __m256i occupied = _mm256_set1_epi8(100);
+  const __m256 rad = _mm256_set1_ps(radius);
+  // The packs work within 128 bit lanes, this puts the dwords back in order afterwards
+  const __m256i unshuffle = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+  int i = 0;
+  for (; i + 32 <= n; i += 32)
+  {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(src + i));
+
+    __m256i d0 = _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(distance + i), rad, _CMP_LE_OQ));
+    __m256i d1 = _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(distance + i + 8), rad, _CMP_LE_OQ));
+    __m256i d2 = _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(distance + i + 16), rad, _CMP_LE_OQ));
+    __m256i d3 = _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(distance + i + 24), rad, _CMP_LE_OQ));
+    __m256i within = _mm256_packs_epi16(_mm256_packs_epi32(d0, d1), _mm256_packs_epi32(d2, d3));
+    within = _mm256_permutevar8x32_epi32(within, unshuffle);
+
+    __m256i out = _mm256_andnot_si256(_mm256_cmpeq_epi8(v, unknown), v);
+    out = _mm256_blendv_epi8(out, occupied, within);
+    out = _mm256_blendv_epi8(out, v, _mm256_cmpgt_epi8(v, thr));
+    _mm256_storeu_si256((__m256i *)(dst + i), out);
+  }
+  padFromDistanceScalar(src + i, distance + i, dst + i, n - i, threshold, radius);
+}
+
+__attribute__((target("avx2"))) static void maxFilterRowAVX2(const int8_t *src, int8_t *dst, int n, int radius)
+{
+  int i = 0;
+  for (; i < std::min(radius, n); ++i)
+    dst[i] = windowMax(src, i, n, radius);
+
+  for (; i + 32 + radius <= n; i += 32)
+  {
+    __m256i m = _mm256_loadu_si256((const __m256i *)(src + i - radius));
+    for (int k = -radius + 1; k <= radius; ++k)
+      m = _mm256_max_epi8(m, _mm256_loadu_si256((const __m256i *)(src + i + k)));
+    _mm256_storeu_si256((__m256i *)(dst + i), m);
+  }
+
+  for (; i < n; ++i)
+    dst[i] = windowMax(src, i, n, radius);
+}
+
+__attribute__((target("avx2"))) static void maxRowsAVX2(const int8_t *a, const int8_t *b, int8_t *dst, int n)
+{
+  int i = 0;
+  for (; i + 32 <= n; i += 32)
+  {
+    __m256i m = _mm256_max_epi8(_mm256_loadu_si256((const __m256i *)(a + i)), _mm256_loadu_si256((const __m256i *)(b + i)));
+    _mm256_storeu_si256((__m256i *)(dst + i), m);
+  }
+  maxRowsScalar(a + i, b + i, dst + i, n - i);
+}
+
+#endif
+
+/*******************************************************************/
+/************************ D I S P A T C H **************************/
+/*******************************************************************/
+
+static const CSpaceKernels::Table SCALAR_TABLE = {CSpaceKernels::SCALAR, obstacleMaskScalar, padFromDistanceScalar, maxFilterRowScalar, maxRowsScalar};
+#ifdef CSPACE_KERNELS_X86
+static const CSpaceKernels::Table SSE41_TABLE = {CSpaceKernels::SSE41, obstacleMaskSSE41, padFromDistanceSSE41, maxFilterRowSSE41, maxRowsSSE41};
+static const CSpaceKernels::Table AVX2_TABLE = {CSpaceKernels::AVX2, obstacleMaskAVX2, padFromDistanceAVX2, maxFilterRowAVX2, maxRowsAVX2};
+#endif
+
+CSpaceKernels::Isa CSpaceKernels::detectIsa()
+{
+#ifdef CSPACE_KERNELS_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return AVX2;
+  if (__builtin_cpu_supports("sse4.1"))
+    return SSE41;
+#endif
+  return SCALAR;
+}
+
+const CSpaceKernels::Table &CSpaceKernels::get()
+{
+  static const Table &best = get(detectIsa());
+  return best;
+}
+
+const CSpaceKernels::Table &CSpaceKernels::get(Isa isa)
+{
+  isa = std::min(isa, detectIsa());
+#ifdef CSPACE_KERNELS_X86
+  if (isa == AVX2)
+    return AVX2_TABLE;
+  if (isa == SSE41)
+    return SSE41_TABLE;
+#endif
+  return SCALAR_TABLE;
+}
+
+const char *CSpaceKernels::name(Isa isa)
+{
+  switch (isa)
+  {
+  case AVX2:
+    return "avx2";
+  case SSE41:
+    return "sse4.1";
+  default:
+    return "scalar";
+  }
+}
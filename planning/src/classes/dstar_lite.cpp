@@ -0,0 +1,278 @@
+#include <dstar_lite.h>
+#include <ros/ros.h>
+
+#include <math.h>
+
+using geometry_msgs::Point;
+using nav_msgs::Path;
+
+double DStarLite::heuristic(int ind1, int ind2) const
+{
+  int dx = abs(ind1 % width_ - ind2 % width_);
+  int dy = abs(ind1 / width_ - ind2 / width_);
+  return std::max(dx, dy) + (M_SQRT2 - 1) * std::min(dx, dy);
+}
+
+double DStarLite::cost(int from, int to) const
+{
+  if (blocked_[from] || blocked_[to])
+    return INFINITY;
+
+  int step = abs(from - to);
+  return (step == 1 || step == width_) ? 1.0 : M_SQRT2;
+}
+
+int DStarLite::getNeighbors(int pt, std::array<int, 8> &neighbors) const
+{
+  int x = pt % width_;
+  int y = pt / width_;
+  int count = 0;
+
+  for (int dy = -1; dy <= 1; ++dy)
+  {
+    if (y + dy < 0 || y + dy >= height_)
+      continue;
+
+    for (int dx = -1; dx <= 1; ++dx)
+    {
+      if ((dx == 0 && dy == 0) || x + dx < 0 || x + dx >= width_)
+        continue;
+
+      neighbors[count++] = pt + dy * width_ + dx;
+    }
+  }
+
+  return count;
+}
+
+DStarLite::Key DStarLite::calculateKey(int s) const
+{
+  double min_g = std::min(g_[s], rhs_[s]);
+  return std::make_pair(min_g + heuristic(start_, s) + km_, min_g);
+}
+
+double DStarLite::lookahead(int s) const
+{
+  std::array<int, 8> neighbors;
+  int count = getNeighbors(s, neighbors);
+
+  double best = INFINITY;
+  for (int i = 0; i < count; ++i)
+    best = std::min(best, cost(s, neighbors[i]) + g_[neighbors[i]]);
+
+  return best;
+}
+
+void DStarLite::updateVertex(int s)
+{
+  if (g_[s] != rhs_[s])
+    open_.push(s, calculateKey(s));
+  else
+    open_.remove(s);
+}
+
+void DStarLite::computeShortestPath()
+{
+  std::array<int, 8> neighbors;
+
+  while (!open_.empty() && (open_.topKey() < calculateKey(start_) || rhs_[start_] > g_[start_]))
+  {
+    int u = open_.top();
+    Key k_old = open_.topKey();
+    Key k_new = calculateKey(u);
+    ++expansions_;
+
+    if (k_old < k_new)
+    {
+      // The robot moved since u was queued, put it back with its up to date key
+      open_.push(u, k_new);
+    }
+    else if (g_[u] > rhs_[u])
+    {
+      // Overconsistent, the cost of u went down. Lock it in and pass it on to the neighbors.
+      g_[u] = rhs_[u];
+      open_.remove(u);
+
+      int count = getNeighbors(u, neighbors);
+      for (int i = 0; i < count; ++i)
+      {
+        int s = neighbors[i];
+        if (s != goal_)
+          rhs_[s] = std::min(rhs_[s], cost(s, u) + g_[u]);
+        updateVertex(s);
+      }
+    }
+    else
+    {
+      // Underconsistent, the cost of u went up. Every neighbor that went through u has to look for a new way.
+      double g_old = g_[u];
+      g_[u] = INFINITY;
+
+      int count = getNeighbors(u, neighbors);
+      for (int i = 0; i < count; ++i)
+      {
+        int s = neighbors[i];
+        if (s != goal_ && rhs_[s] == cost(s, u) + g_old)
+          rhs_[s] = lookahead(s);
+        updateVertex(s);
+      }
+
+      if (u != goal_)
+        rhs_[u] = lookahead(u);
+      updateVertex(u);
+    }
+  }
+}
+
+void DStarLite::initialize(const nav_msgs::OccupancyGrid &oGrid, int goal, int threshold)
+{
+  width_ = oGrid.info.width;
+  height_ = oGrid.info.height;
+  threshold_ = threshold;
+  goal_ = goal;
+  km_ = 0;
+
+  int size = oGrid.data.size();
+  g_.assign(size, INFINITY);
+  rhs_.assign(size, INFINITY);
+  blocked_.resize(size);
+  for (int i = 0; i < size; ++i)
+    blocked_[i] = oGrid.data[i] >= threshold && i != goal_;
+
+  open_.reset(size);
+  rhs_[goal_] = 0;
+  open_.push(goal_, calculateKey(goal_));
+
+  initialized_ = true;
+}
+
+void DStarLite::reset()
+{
+  initialized_ = false;
+}
+
+Path DStarLite::extractPath(const nav_msgs::OccupancyGrid &oGrid) const
+{
+  // Walk downhill on the cost to goal, from the robot to the target
+  std::vector<int> cells{start_};
+  std::array<int, 8> neighbors;
+
+  int current = start_;
+  while (current != goal_)
+  {
+    int count = getNeighbors(current, neighbors);
+    int best = -1;
+    double best_cost = INFINITY;
+    for (int i = 0; i < count; ++i)
+    {
+      double c = cost(current, neighbors[i]) + g_[neighbors[i]];
+      if (c < best_cost)
+      {
+        best_cost = c;
+        best = neighbors[i];
+      }
+    }
+
+    // Can't happen on a consistent search, but never loop forever on a broken one
+    if (best == -1 || cells.size() > g_.size())
+      return Path();
+
+    current = best;
+    cells.push_back(current);
+  }
+
+  // Same layout as AStar::reconstructPath: target first, robot last, collinear points removed
+  Path p;
+  p.header = pathHeader(oGrid);
+
+  p.poses.push_back(poseStampedFromIndex(cells.back(), oGrid));
+  for (int i = cells.size() - 2; i > 0; --i)
+  {
+    if (!collinear(cells[i + 1], cells[i], cells[i - 1], width_))
+      p.poses.push_back(poseStampedFromIndex(cells[i], oGrid));
+  }
+  p.poses.push_back(poseStampedFromIndex(cells.front(), oGrid));
+
+  return p;
+}
+
+Path DStarLite::findPathOccGrid(const nav_msgs::OccupancyGrid &oGrid, const Point target, const std::vector<int> &changedCells, int threshold)
+{
+  if (oGrid.data.size() == 0)
+  {
+    ROS_WARN("Occupancy Grid is Empty.");
+    return Path();
+  }
+
+  int endIndex = getTargetIndex(oGrid, target, threshold);
+  int centerIndex = (oGrid.info.height / 2) * oGrid.info.width + oGrid.info.width / 2;
+
+  // Check if the final destination is occupied.
+  if (oGrid.data[endIndex] > threshold)
+  {
+    ROS_WARN("TARGET IN OCCUPIED SPACE, UNREACHABLE");
+    return Path();
+  }
+
+  expansions_ = 0;
+
+  if (!initialized_ || endIndex != goal_ || threshold != threshold_ || (int)oGrid.info.width != width_ ||
+      (int)oGrid.info.height != height_ || oGrid.data.size() != blocked_.size())
+  {
+    start_ = centerIndex;
+    initialize(oGrid, endIndex, threshold);
+  }
+  else
+  {
+    // The heuristic is measured from the start, so moving it shifts every queued key by at most this much
+    if (centerIndex != start_)
+    {
+      km_ += heuristic(start_, centerIndex);
+      start_ = centerIndex;
+    }
+
+    std::array<int, 8> neighbors;
+    for (int cell : changedCells)
+    {
+      if (cell < 0 || cell >= (int)blocked_.size())
+        continue;
+
+      bool blocked = oGrid.data[cell] >= threshold && cell != goal_;
+      if (blocked == blocked_[cell])
+        continue;
+
+      blocked_[cell] = blocked;
+
+      // Every edge touching the cell changed cost, so the cell and its neighbors need their lookahead redone
+      int count = getNeighbors(cell, neighbors);
+      for (int i = 0; i < count; ++i)
+      {
+        int s = neighbors[i];
+        if (s != goal_)
+          rhs_[s] = lookahead(s);
+        updateVertex(s);
+      }
+
+      if (cell != goal_)
+        rhs_[cell] = lookahead(cell);
+      updateVertex(cell);
+    }
+  }
+
+  // Same as A*, we can't start from inside an obstacle
+  if (blocked_[start_])
+  {
+    ROS_WARN("[WARNING] Call to navigation failed to find valid path.\n");
+    return Path();
+  }
+
+  computeShortestPath();
+
+  if (rhs_[start_] == INFINITY)
+  {
+    ROS_WARN("[WARNING] Call to navigation failed to find valid path.\n");
+    return Path();
+  }
+
+  return extractPath(oGrid);
+}
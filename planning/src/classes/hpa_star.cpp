@@ -0,0 +1,513 @@
+#include <hpa_star.h>
+#include <ros/ros.h>
+
+#include <algorithm>
+#include <math.h>
+
+using geometry_msgs::Point;
+using geometry_msgs::PoseStamped;
+using nav_msgs::Path;
+
+// Border runs at least this long get an entrance at each end instead of one in the middle
+#define LONG_ENTRANCE 6
+
+static double getYaw(const geometry_msgs::Quaternion &q)
+{
+  return atan2(2 * (q.w * q.z + q.x * q.y), 1 - 2 * (q.y * q.y + q.z * q.z));
+}
+
+HPAStar::HPAStar(double arenaSize, double resolution, int clusterSize, int threshold)
+    : threshold_(threshold), cluster_size_(clusterSize)
+{
+  int cells = ceil(arenaSize / resolution);
+
+  global_map_.header.frame_id = "odom";
+  global_map_.info.resolution = resolution;
+  global_map_.info.width = cells;
+  global_map_.info.height = cells;
+  global_map_.info.origin.position.x = -cells * resolution / 2;
+  global_map_.info.origin.position.y = -cells * resolution / 2;
+  global_map_.info.origin.orientation.w = 1;
+  global_map_.data.assign(cells * cells, -1);
+
+  clusters_x_ = (cells + clusterSize - 1) / clusterSize;
+  clusters_y_ = clusters_x_;
+  clusters_.resize(clusters_x_ * clusters_y_);
+
+  entrance_slot_.assign(cells * cells, -1);
+  merged_.resize(cells * cells);
+  merged_generation_.assign(cells * cells, 0);
+}
+
+bool HPAStar::blocked(int cell) const
+{
+  return global_map_.data[cell] > threshold_;
+}
+
+int HPAStar::clusterOf(int cell) const
+{
+  int width = global_map_.info.width;
+  return (cell / width / cluster_size_) * clusters_x_ + (cell % width) / cluster_size_;
+}
+
+int HPAStar::localIndex(int cluster, int cell) const
+{
+  int width = global_map_.info.width;
+  int x0 = (cluster % clusters_x_) * cluster_size_;
+  int y0 = (cluster / clusters_x_) * cluster_size_;
+  return (cell / width - y0) * cluster_size_ + (cell % width - x0);
+}
+
+double HPAStar::octileDistance(int cell1, int cell2) const
+{
+  int width = global_map_.info.width;
+  int dx = abs(cell1 % width - cell2 % width);
+  int dy = abs(cell1 / width - cell2 / width);
+  return std::max(dx, dy) + (M_SQRT2 - 1) * std::min(dx, dy);
+}
+
+int HPAStar::coarseIndex(double x, double y) const
+{
+  int cx = floor((x - global_map_.info.origin.position.x) / global_map_.info.resolution);
+  int cy = floor((y - global_map_.info.origin.position.y) / global_map_.info.resolution);
+  if (cx < 0 || cy < 0 || cx >= (int)global_map_.info.width || cy >= (int)global_map_.info.height)
+    return -1;
+
+  return cy * global_map_.info.width + cx;
+}
+
+Point HPAStar::coarseCenter(int cell) const
+{
+  int width = global_map_.info.width;
+  return getPoint(global_map_.info.origin.position.x + (cell % width + 0.5) * global_map_.info.resolution,
+                  global_map_.info.origin.position.y + (cell / width + 0.5) * global_map_.info.resolution);
+}
+
+void HPAStar::findEntrances(int cluster)
+{
+  Cluster &c = clusters_[cluster];
+  for (int cell : c.entrances)
+    entrance_slot_[cell] = -1;
+  c.entrances.clear();
+
+  int width = global_map_.info.width;
+  int height = global_map_.info.height;
+  int x0 = (cluster % clusters_x_) * cluster_size_;
+  int y0 = (cluster / clusters_x_) * cluster_size_;
+  int x1 = std::min(width, x0 + cluster_size_);
+  int y1 = std::min(height, y0 + cluster_size_);
+
+  auto addEntrance = [&](int cell) {
+    if (entrance_slot_[cell] != -1)
+      return;
+    entrance_slot_[cell] = c.entrances.size();
+    c.entrances.push_back(cell);
+  };
+
+  // Walks along one side, comparing the cells inside the cluster with the ones across the border
+  auto scanSide = [&](int inside, int outside, int step, int count) {
+    int runStart = -1;
+    for (int i = 0; i <= count; ++i)
+    {
+      bool open = i < count && !blocked(inside + i * step) && !blocked(outside + i * step);
+      if (open && runStart == -1)
+      {
+        runStart = i;
+      }
+      else if (!open && runStart != -1)
+      {
+        int runEnd = i - 1;
+        if (runEnd - runStart + 1 < LONG_ENTRANCE)
+        {
+          addEntrance(inside + ((runStart + runEnd) / 2) * step);
+        }
+        else
+        {
+          addEntrance(inside + runStart * step);
+          addEntrance(inside + runEnd * step);
+        }
+        runStart = -1;
+      }
+    }
+  };
+
+  if (x0 > 0)
+    scanSide(y0 * width + x0, y0 * width + x0 - 1, width, y1 - y0);
+  if (x1 < width)
+    scanSide(y0 * width + x1 - 1, y0 * width + x1, width, y1 - y0);
+  if (y0 > 0)
+    scanSide(y0 * width + x0, (y0 - 1) * width + x0, 1, x1 - x0);
+  if (y1 < height)
+    scanSide((y1 - 1) * width + x0, y1 * width + x0, 1, x1 - x0);
+}
+
+void HPAStar::searchCluster(int cluster, int from)
+{
+  int width = global_map_.info.width;
+  int height = global_map_.info.height;
+  int x0 = (cluster % clusters_x_) * cluster_size_;
+  int y0 = (cluster / clusters_x_) * cluster_size_;
+  int x1 = std::min(width, x0 + cluster_size_);
+  int y1 = std::min(height, y0 + cluster_size_);
+
+  int size = cluster_size_ * cluster_size_;
+  cluster_costs_.assign(size, INFINITY);
+  cluster_parents_.assign(size, -1);
+  cluster_open_.reset(size);
+
+  int start = localIndex(cluster, from);
+  cluster_costs_[start] = 0;
+  cluster_open_.push(start, 0);
+
+  while (!cluster_open_.empty())
+  {
+    int current = cluster_open_.pop();
+    int x = x0 + current % cluster_size_;
+    int y = y0 + current / cluster_size_;
+
+    for (int dy = -1; dy <= 1; ++dy)
+    {
+      for (int dx = -1; dx <= 1; ++dx)
+      {
+        int nx = x + dx;
+        int ny = y + dy;
+        if ((dx == 0 && dy == 0) || nx < x0 || nx >= x1 || ny < y0 || ny >= y1 || blocked(ny * width + nx))
+          continue;
+
+        // Same as JPS, no cutting the corners of obstacles
+        if (dx != 0 && dy != 0 && (blocked(y * width + nx) || blocked(ny * width + x)))
+          continue;
+
+        int neighbor = (ny - y0) * cluster_size_ + (nx - x0);
+        float cost = cluster_costs_[current] + (dx != 0 && dy != 0 ? M_SQRT2 : 1);
+        if (cost < cluster_costs_[neighbor])
+        {
+          cluster_costs_[neighbor] = cost;
+          cluster_parents_[neighbor] = current;
+          cluster_open_.push(neighbor, cost);
+        }
+      }
+    }
+  }
+}
+
+void HPAStar::rebuildClusters()
+{
+  std::vector<int> rebuild;
+  std::vector<bool> marked(clusters_.size(), false);
+
+  auto mark = [&](int cx, int cy) {
+    if (cx < 0 || cy < 0 || cx >= clusters_x_ || cy >= clusters_y_ || marked[cy * clusters_x_ + cx])
+      return;
+    marked[cy * clusters_x_ + cx] = true;
+    rebuild.push_back(cy * clusters_x_ + cx);
+  };
+
+  for (int i = 0; i < (int)clusters_.size(); ++i)
+  {
+    if (!clusters_[i].dirty)
+      continue;
+
+    int cx = i % clusters_x_;
+    int cy = i / clusters_x_;
+    mark(cx, cy);
+    mark(cx - 1, cy);
+    mark(cx + 1, cy);
+    mark(cx, cy - 1);
+    mark(cx, cy + 1);
+  }
+
+  // All the entrances first, a cluster's costs only depend on its own entrances but the borders are shared
+  for (int cluster : rebuild)
+    findEntrances(cluster);
+
+  for (int cluster : rebuild)
+  {
+    Cluster &c = clusters_[cluster];
+    int n = c.entrances.size();
+    c.costs.assign(n * n, INFINITY);
+    for (int i = 0; i < n; ++i)
+    {
+      searchCluster(cluster, c.entrances[i]);
+      for (int j = 0; j < n; ++j)
+        c.costs[i * n + j] = cluster_costs_[localIndex(cluster, c.entrances[j])];
+    }
+    c.dirty = false;
+  }
+}
+
+void HPAStar::updateGlobalMap(const nav_msgs::OccupancyGrid &oGrid, const geometry_msgs::Pose &robotPose)
+{
+  int width = oGrid.info.width;
+  int height = oGrid.info.height;
+  double resolution = oGrid.info.resolution;
+  double yaw = getYaw(robotPose.orientation);
+  double c = cos(yaw);
+  double s = sin(yaw);
+
+  if (++generation_ == 0)
+  {
+    std::fill(merged_generation_.begin(), merged_generation_.end(), 0);
+    generation_ = 1;
+  }
+
+  // Several local cells land in each coarse cell, the coarse cell keeps the highest of them
+  std::vector<int> touched;
+  for (int y = 0; y < height; ++y)
+  {
+    for (int x = 0; x < width; ++x)
+    {
+      int8_t value = oGrid.data[y * width + x];
+      if (value == -1)
+        continue;
+
+      // Same cell position as AStar::poseStampedFromIndex, rotated into the odom frame
+      double lx = (x - width / 2) * resolution;
+      double ly = (y - height / 2) * resolution;
+      int cell = coarseIndex(robotPose.position.x + c * lx - s * ly, robotPose.position.y + s * lx + c * ly);
+      if (cell == -1)
+        continue;
+
+      if (merged_generation_[cell] != generation_)
+      {
+        merged_generation_[cell] = generation_;
+        merged_[cell] = value;
+        touched.push_back(cell);
+      }
+      else
+      {
+        merged_[cell] = std::max(merged_[cell], value);
+      }
+    }
+  }
+
+  for (int cell : touched)
+  {
+    if ((merged_[cell] > threshold_) != blocked(cell))
+      clusters_[clusterOf(cell)].dirty = true;
+    global_map_.data[cell] = merged_[cell];
+  }
+
+  global_map_.header.stamp = oGrid.header.stamp;
+}
+
+std::vector<int> HPAStar::findCoarsePath(int start, int goal)
+{
+  rebuildClusters();
+  expansions_ = 0;
+
+  if (start == goal)
+    return {start};
+
+  int startCluster = clusterOf(start);
+  int goalCluster = clusterOf(goal);
+  const Cluster &startEntrances = clusters_[startCluster];
+  const Cluster &goalEntrances = clusters_[goalCluster];
+
+  // Connect the start and goal to the entrances of their clusters. Moves cost the same both ways, so the goal side is
+  // searched from the goal.
+  searchCluster(startCluster, start);
+  std::vector<float> startCosts;
+  for (int e : startEntrances.entrances)
+    startCosts.push_back(cluster_costs_[localIndex(startCluster, e)]);
+  float direct = startCluster == goalCluster ? cluster_costs_[localIndex(startCluster, goal)] : INFINITY;
+
+  searchCluster(goalCluster, goal);
+  std::vector<float> goalCosts;
+  for (int e : goalEntrances.entrances)
+    goalCosts.push_back(cluster_costs_[localIndex(goalCluster, e)]);
+
+  // A* over the entrances
+  int width = global_map_.info.width;
+  int size = global_map_.data.size();
+  SearchSpace &space = abstract_space_;
+  space.reset(size);
+  space.setScore(start, 0, -1);
+  space.open.push(start, octileDistance(start, goal));
+
+  auto relax = [&](int from, int to, double cost) {
+    if (cost == INFINITY || space.isClosed(to))
+      return;
+
+    double tentative_gscore = space.gScore(from) + cost;
+    if (tentative_gscore < space.gScore(to))
+    {
+      space.setScore(to, tentative_gscore, from);
+      space.open.push(to, tentative_gscore + octileDistance(to, goal));
+    }
+  };
+
+  while (!space.open.empty())
+  {
+    int current = space.open.pop();
+    space.close(current);
+
+    if (current == goal)
+      break;
+
+    if (current == start)
+    {
+      for (int i = 0; i < (int)startCosts.size(); ++i)
+        relax(current, startEntrances.entrances[i], startCosts[i]);
+      relax(current, goal, direct);
+    }
+
+    int slot = entrance_slot_[current];
+    if (slot == -1)
+      continue;
+
+    int cluster = clusterOf(current);
+    const Cluster &c = clusters_[cluster];
+    int n = c.entrances.size();
+    for (int j = 0; j < n; ++j)
+    {
+      if (j != slot)
+        relax(current, c.entrances[j], c.costs[slot * n + j]);
+    }
+
+    // Step across the border into the entrances of the neighboring clusters
+    int x = current % width;
+    int neighbors[4] = {x > 0 ? current - 1 : -1, x < width - 1 ? current + 1 : -1, current - width, current + width};
+    for (int neighbor : neighbors)
+    {
+      if (neighbor < 0 || neighbor >= size || entrance_slot_[neighbor] == -1 || clusterOf(neighbor) == cluster || blocked(neighbor))
+        continue;
+      relax(current, neighbor, 1);
+    }
+
+    if (cluster == goalCluster)
+      relax(current, goal, goalCosts[slot]);
+  }
+
+  expansions_ = space.expansions();
+  if (space.gScore(goal) == INFINITY)
+    return {};
+
+  std::vector<int> abstractPath;
+  for (int current = goal; current != -1; current = space.cameFrom(current))
+    abstractPath.push_back(current);
+  std::reverse(abstractPath.begin(), abstractPath.end());
+
+  // Refine each abstract edge into coarse cells. Steps between clusters are single moves, anything else stays
+  // inside one cluster.
+  std::vector<int> route{start};
+  std::vector<int> segment;
+  for (int i = 1; i < (int)abstractPath.size(); ++i)
+  {
+    int from = abstractPath[i - 1];
+    int to = abstractPath[i];
+    int cluster = clusterOf(from);
+    if (cluster != clusterOf(to))
+    {
+      route.push_back(to);
+      continue;
+    }
+
+    searchCluster(cluster, from);
+    int x0 = (cluster % clusters_x_) * cluster_size_;
+    int y0 = (cluster / clusters_x_) * cluster_size_;
+    segment.clear();
+    for (int local = localIndex(cluster, to); local != localIndex(cluster, from); local = cluster_parents_[local])
+      segment.push_back((y0 + local / cluster_size_) * width + x0 + local % cluster_size_);
+    route.insert(route.end(), segment.rbegin(), segment.rend());
+  }
+
+  return route;
+}
+
+Path HPAStar::findPathOccGrid(const nav_msgs::OccupancyGrid &oGrid, const Point target, const geometry_msgs::Pose &robotPose, int threshold)
+{
+  if (oGrid.data.size() == 0)
+  {
+    ROS_WARN("Occupancy Grid is Empty.");
+    return Path();
+  }
+
+  int width = oGrid.info.width;
+  int height = oGrid.info.height;
+
+  // Targets on the local grid don't need the arena map
+  if ((int)target.x < width / 2 && (int)target.x > -(width / 2) && (int)target.y < height / 2 && (int)target.y > -(height / 2))
+    return AStar::findPathOccGrid(oGrid, target, threshold);
+
+  double resolution = oGrid.info.resolution;
+  double yaw = getYaw(robotPose.orientation);
+  double c = cos(yaw);
+  double s = sin(yaw);
+
+  int start = coarseIndex(robotPose.position.x, robotPose.position.y);
+  int goal = coarseIndex(robotPose.position.x + (c * target.x - s * target.y) * resolution,
+                         robotPose.position.y + (s * target.x + c * target.y) * resolution);
+  if (start == -1 || goal == -1)
+  {
+    ROS_WARN("Robot or target outside of the arena map, planning on the local grid only.");
+    return AStar::findPathOccGrid(oGrid, target, threshold);
+  }
+
+  std::vector<int> route = findCoarsePath(start, goal);
+  if (route.empty())
+  {
+    ROS_WARN("[WARNING] Call to navigation failed to find valid path.\n");
+    return Path();
+  }
+
+  // Coarse cells in the robot centred frame, in local cells
+  auto toLocal = [&](int cell) {
+    Point p = coarseCenter(cell);
+    double dx = p.x - robotPose.position.x;
+    double dy = p.y - robotPose.position.y;
+    return getPoint((c * dx + s * dy) / resolution, (-s * dx + c * dy) / resolution);
+  };
+
+  // Follow the route until it leaves the local grid, the fine search goes to the last free cell on the way
+  int last = -1;
+  Point subgoal;
+  for (int i = 0; i < (int)route.size(); ++i)
+  {
+    Point p = toLocal(route[i]);
+    int x = lround(p.x);
+    int y = lround(p.y);
+    if (x <= -(width / 2) || x >= width / 2 || y <= -(height / 2) || y >= height / 2)
+      break;
+
+    if (oGrid.data[(y + height / 2) * width + x + width / 2] <= threshold)
+    {
+      last = i;
+      subgoal = getPoint(x, y);
+    }
+  }
+
+  if (last == -1)
+  {
+    ROS_WARN("Coarse route never crosses free local space, planning on the local grid only.");
+    return AStar::findPathOccGrid(oGrid, target, threshold);
+  }
+
+  Path local = AStar::findPathOccGrid(oGrid, subgoal, threshold);
+  if (local.poses.empty())
+    return local;
+
+  // Same layout as the A* paths: the target first, then the rest of the route without collinear cells, then the fine
+  // path down to the robot
+  Path p;
+  p.header = local.header;
+
+  auto addPose = [&](const Point &cells) {
+    PoseStamped ps;
+    ps.header = local.header;
+    ps.pose.position.x = cells.x * resolution;
+    ps.pose.position.y = cells.y * resolution;
+    p.poses.push_back(ps);
+  };
+
+  addPose(target);
+  int globalWidth = global_map_.info.width;
+  for (int i = route.size() - 2; i > last; --i)
+  {
+    if (!collinear(route[i + 1], route[i], route[i - 1], globalWidth))
+      addPose(toLocal(route[i]));
+  }
+
+  p.poses.insert(p.poses.end(), local.poses.begin(), local.poses.end());
+  return p;
+}
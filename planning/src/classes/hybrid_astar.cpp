@@ -0,0 +1,381 @@
+#include <hybrid_astar.h>
+#include <multi_goal.h>
+#include <ros/ros.h>
+
+#include <algorithm>
+#include <math.h>
+
+using geometry_msgs::PoseStamped;
+using nav_msgs::Path;
+
+// Heading bins, 5 degrees each
+#define HEADINGS 72
+
+// Size of a position bin, in meters
+#define XY_BIN 0.2
+
+// Length of every driving primitive, in meters
+#define STEP 0.5
+
+// Largest distance between two collision checks along a motion, in cells
+#define SAMPLE_SPACING 1.0
+
+// Heading bins turned over one step by the two radial turns. The sharp one sets the minimum turning radius to
+// STEP / 20 deg = 1.43 m, where the inner wheels steer about 30 degrees.
+#define GENTLE_TURN 2
+#define SHARP_TURN 4
+
+// Crab drives go 45 degrees off the heading, point turns turn 45 degrees at a time
+#define CRAB_BINS 9
+#define POINT_TURN_BINS 9
+
+// Steering codes of the primitives that aren't radial turns
+#define STEERING_CRAB 100
+#define STEERING_POINT_TURN 200
+
+// Extra costs, as multiples of the distance driven or in meters
+#define REVERSE_PENALTY 2.0
+#define CRAB_PENALTY 1.5
+#define POINT_TURN_COST 1.0
+#define DIRECTION_SWITCH_COST 1.0
+#define STEERING_CHANGE_COST 0.1
+
+// The Reeds-Shepp curve to the target is tried every expansion closer than ANALYTIC_RANGE meters, and every
+// ANALYTIC_EVERY expansions further away
+#define ANALYTIC_RANGE 3.0
+#define ANALYTIC_EVERY 10
+
+// Gives up after this many expansions, when the target can't be reached
+#define MAX_EXPANSIONS 50000
+
+namespace
+{
+// Position after driving s along an arc of curvature kappa, from the origin at heading theta
+std::pair<double, double> arc(double theta, double kappa, double s)
+{
+  if (kappa == 0)
+    return {s * cos(theta), s * sin(theta)};
+  return {(sin(theta + kappa * s) - sin(theta)) / kappa, (cos(theta) - cos(theta + kappa * s)) / kappa};
+}
+} // namespace
+
+const std::vector<std::vector<HybridAStar::Primitive>> &HybridAStar::primitives(double resolution)
+{
+  static thread_local double built_for = 0;
+  static thread_local std::vector<std::vector<Primitive>> table;
+  if (built_for == resolution)
+    return table;
+
+  built_for = resolution;
+  table.assign(HEADINGS, {});
+
+  double step = STEP / resolution;
+  double bin = 2 * M_PI / HEADINGS;
+  int substeps = ceil(step / SAMPLE_SPACING);
+
+  for (int h = 0; h < HEADINGS; ++h)
+  {
+    double theta = h * bin;
+    std::vector<Primitive> &prims = table[h];
+
+    // Radial turns and straight drives, forwards and backwards
+    for (int direction : {1, -1})
+    {
+      for (int turn : {-SHARP_TURN, -GENTLE_TURN, 0, GENTLE_TURN, SHARP_TURN})
+      {
+        Primitive p;
+        double kappa = turn * bin / step;
+        for (int i = 1; i <= substeps; ++i)
+          p.samples.push_back(arc(theta, kappa, direction * step * i / substeps));
+        p.dx = p.samples.back().first;
+        p.dy = p.samples.back().second;
+        p.dheading = turn * direction;
+        p.cost = direction > 0 ? step : step * REVERSE_PENALTY;
+        p.direction = direction;
+        p.steering = turn;
+        prims.push_back(p);
+      }
+    }
+
+    // Crab drives, the heading stays the same
+    for (int side : {-1, 1})
+    {
+      Primitive p;
+      for (int i = 1; i <= substeps; ++i)
+        p.samples.push_back(arc(theta + side * CRAB_BINS * bin, 0, step * i / substeps));
+      p.dx = p.samples.back().first;
+      p.dy = p.samples.back().second;
+      p.dheading = 0;
+      p.cost = step * CRAB_PENALTY;
+      p.direction = 1;
+      p.steering = side * STEERING_CRAB;
+      prims.push_back(p);
+    }
+
+    // Point turns
+    for (int side : {-1, 1})
+    {
+      Primitive p;
+      p.samples.push_back({0, 0});
+      p.dx = p.dy = 0;
+      p.dheading = side * POINT_TURN_BINS;
+      p.cost = POINT_TURN_COST / resolution;
+      p.direction = 0;
+      p.steering = STEERING_POINT_TURN;
+      prims.push_back(p);
+    }
+  }
+
+  return table;
+}
+
+inline bool HybridAStar::free(double x, double y, const nav_msgs::OccupancyGrid &oGrid, int threshold, int startIndex, int endIndex)
+{
+  int ix = lround(x), iy = lround(y);
+  if (ix < 0 || iy < 0 || ix >= (int)oGrid.info.width || iy >= (int)oGrid.info.height)
+    return false;
+
+  int index = iy * oGrid.info.width + ix;
+  return oGrid.data[index] < threshold || index == startIndex || index == endIndex;
+}
+
+PoseStamped HybridAStar::poseStamped(double x, double y, double yaw, const nav_msgs::OccupancyGrid &oGrid)
+{
+  PoseStamped ps;
+  ps.pose.position.x = (x - (int)oGrid.info.width / 2) * oGrid.info.resolution;
+  ps.pose.position.y = (y - (int)oGrid.info.height / 2) * oGrid.info.resolution;
+  ps.pose.orientation.z = sin(yaw / 2);
+  ps.pose.orientation.w = cos(yaw / 2);
+
+  ps.header = pathHeader(oGrid);
+  return ps;
+}
+
+Path HybridAStar::findPathOccGrid(const nav_msgs::OccupancyGrid &oGrid, const geometry_msgs::Pose &target, int threshold)
+{
+  static thread_local SearchSpace space;
+  return findPathOccGrid(oGrid, target, space, threshold);
+}
+
+Path HybridAStar::findPathOccGrid(const nav_msgs::OccupancyGrid &oGrid, const geometry_msgs::Pose &target, SearchSpace &space, int threshold)
+{
+  if (oGrid.data.size() == 0)
+  {
+    ROS_WARN("Occupancy Grid is Empty.");
+    return Path();
+  }
+
+  int width = oGrid.info.width;
+  int height = oGrid.info.height;
+  double resolution = oGrid.info.resolution;
+  int endIndex = getTargetIndex(oGrid, target.position, threshold);
+  int centerIndex = (height / 2) * width + width / 2;
+
+  // Check if the final destination is occupied.
+  if (oGrid.data[endIndex] > threshold)
+  {
+    ROS_WARN("TARGET IN OCCUPIED SPACE, UNREACHABLE");
+    return Path();
+  }
+
+  const std::vector<std::vector<Primitive>> &prims = primitives(resolution);
+  double bin = 2 * M_PI / HEADINGS;
+  double radius = STEP / (SHARP_TURN * bin) / resolution;
+
+  double goal_x = endIndex % width, goal_y = endIndex / width;
+  const geometry_msgs::Quaternion &q = target.orientation;
+  bool heading_given = q.x != 0 || q.y != 0 || q.z != 0 || q.w != 0;
+  double goal_yaw = heading_given ? atan2(2 * (q.w * q.z + q.x * q.y), 1 - 2 * (q.y * q.y + q.z * q.z)) : 0;
+
+  // States are binned by position and heading, each bin keeps the continuous position it was reached at
+  double bin_size = std::max(1.0, XY_BIN / resolution);
+  int bins_x = ceil(width / bin_size) + 1;
+  int bins_y = ceil(height / bin_size) + 1;
+  auto binIndex = [&](double x, double y) {
+    return (int)floor((y + 0.5) / bin_size) * bins_x + (int)floor((x + 0.5) / bin_size);
+  };
+  auto stateIndex = [&](double x, double y, int h) { return binIndex(x, y) * HEADINGS + h; };
+
+  // Grid distance of every position bin to the target, ignoring the turning radius. A bin is free if any of its cells
+  // is, so the distance is never longer than the real one by more than a bin.
+  static thread_local nav_msgs::OccupancyGrid bins;
+  bins.info.width = bins_x;
+  bins.info.height = bins_y;
+  bins.data.assign(bins_x * bins_y, 100);
+  for (int i = 0; i < (int)oGrid.data.size(); ++i)
+  {
+    if (oGrid.data[i] < threshold)
+      bins.data[binIndex(i % width, i / width)] = 0;
+  }
+
+  double start_x = width / 2, start_y = height / 2;
+  bins.data[binIndex(start_x, start_y)] = 0;
+
+  static thread_local SearchSpace bin_space;
+  MultiGoal::sweep(bins, binIndex(goal_x, goal_y), {}, bin_space, threshold);
+
+  // Not even the bins connect the robot to the target, so there is no point searching
+  if (bin_space.gScore(binIndex(start_x, start_y)) == INFINITY)
+  {
+    ROS_WARN("TARGET NOT CONNECTED TO THE ROBOT, UNREACHABLE");
+    return Path();
+  }
+
+  auto heuristic = [&](double x, double y, int h) {
+    double cost = std::max(hypot(goal_x - x, goal_y - y), (bin_space.gScore(binIndex(x, y)) - 1) * bin_size);
+    if (heading_given)
+      cost = std::max(cost, radius * ReedsShepp::shortestPath(x, y, h * bin, goal_x, goal_y, goal_yaw, radius).length());
+    return cost;
+  };
+
+  int states = bins_x * bins_y * HEADINGS;
+  static thread_local std::vector<double> state_x, state_y;
+  static thread_local std::vector<int8_t> state_direction;
+  static thread_local std::vector<int16_t> state_steering;
+  if ((int)state_x.size() < states)
+  {
+    state_x.resize(states);
+    state_y.resize(states);
+    state_direction.resize(states);
+    state_steering.resize(states);
+  }
+
+  int start = stateIndex(start_x, start_y, 0);
+  state_x[start] = start_x;
+  state_y[start] = start_y;
+  state_direction[start] = 0;
+  state_steering[start] = 0;
+
+  space.reset(states);
+  space.setScore(start, 0, -1);
+  space.open.push(start, heuristic(start_x, start_y, 0));
+
+  int last = -1;
+  std::vector<ReedsShepp::Sample> analytic;
+
+  while (!space.open.empty())
+  {
+    int current = space.open.pop();
+    space.close(current);
+
+    if (space.expansions() > MAX_EXPANSIONS)
+    {
+      ROS_WARN("Hybrid A* gave up after %d expansions.", MAX_EXPANSIONS);
+      return Path();
+    }
+
+    double x = state_x[current], y = state_y[current];
+    int h = current % HEADINGS;
+    double goal_distance = hypot(goal_x - x, goal_y - y);
+
+    // Close enough to the target already
+    if (goal_distance <= bin_size && (!heading_given || fabs(remainder(h * bin - goal_yaw, 2 * M_PI)) <= bin))
+    {
+      last = current;
+      break;
+    }
+
+    // Try to finish with a Reeds-Shepp curve. Without a target heading, aim straight at it.
+    if (goal_distance * resolution < ANALYTIC_RANGE || space.expansions() % ANALYTIC_EVERY == 0)
+    {
+      double yaw = heading_given ? goal_yaw : atan2(goal_y - y, goal_x - x);
+      ReedsShepp::Path curve = ReedsShepp::shortestPath(x, y, h * bin, goal_x, goal_y, yaw, radius);
+
+      analytic.clear();
+      ReedsShepp::sample(curve, x, y, h * bin, radius, SAMPLE_SPACING, analytic);
+      bool clear = true;
+      for (const ReedsShepp::Sample &sample : analytic)
+      {
+        if (!free(sample.x, sample.y, oGrid, threshold, centerIndex, endIndex))
+        {
+          clear = false;
+          break;
+        }
+      }
+
+      if (clear)
+      {
+        last = current;
+        break;
+      }
+      analytic.clear();
+    }
+
+    double current_gscore = space.gScore(current);
+    for (const Primitive &prim : prims[h])
+    {
+      bool clear = true;
+      for (const std::pair<double, double> &sample : prim.samples)
+      {
+        if (!free(x + sample.first, y + sample.second, oGrid, threshold, centerIndex, endIndex))
+        {
+          clear = false;
+          break;
+        }
+      }
+      if (!clear)
+        continue;
+
+      double next_x = x + prim.dx, next_y = y + prim.dy;
+      int next_h = (h + prim.dheading + HEADINGS) % HEADINGS;
+      int next = stateIndex(next_x, next_y, next_h);
+      if (next == current || space.isClosed(next))
+        continue;
+
+      double cost = prim.cost;
+      if (prim.direction != 0 && state_direction[current] != 0 && prim.direction != state_direction[current])
+        cost += DIRECTION_SWITCH_COST / resolution;
+      if (prim.steering != state_steering[current])
+        cost += STEERING_CHANGE_COST / resolution;
+
+      double tentative_gscore = current_gscore + cost;
+      if (tentative_gscore < space.gScore(next))
+      {
+        space.setScore(next, tentative_gscore, current);
+        state_x[next] = next_x;
+        state_y[next] = next_y;
+        // Point turns keep the direction of the drive before them
+        state_direction[next] = prim.direction != 0 ? prim.direction : state_direction[current];
+        state_steering[next] = prim.steering;
+        space.open.push(next, tentative_gscore + heuristic(next_x, next_y, next_h));
+      }
+    }
+  }
+
+  if (last == -1)
+  {
+    ROS_WARN("Hybrid A* found no path.");
+    return Path();
+  }
+
+  // Poses from the robot to the target: the states, then the Reeds-Shepp curve about a step apart
+  std::vector<ReedsShepp::Sample> poses;
+  for (int state = last; state != -1; state = space.cameFrom(state))
+    poses.push_back({state_x[state], state_y[state], (state % HEADINGS) * bin, state_direction[state] >= 0});
+  std::reverse(poses.begin(), poses.end());
+
+  double step = STEP / resolution, travelled = 0;
+  for (int i = 0; i < (int)analytic.size(); ++i)
+  {
+    travelled += SAMPLE_SPACING;
+    bool cusp = i + 1 < (int)analytic.size() && analytic[i + 1].forward != analytic[i].forward;
+    bool near_end = (analytic.size() - i) * SAMPLE_SPACING < step / 2;
+    if ((travelled >= step && !near_end) || cusp || i + 1 == (int)analytic.size())
+    {
+      poses.push_back(analytic[i]);
+      travelled = 0;
+    }
+  }
+
+  // Stopped within a bin of the target, finish on it
+  if (analytic.empty())
+    poses.push_back({goal_x, goal_y, heading_given ? goal_yaw : poses.back().yaw, true});
+
+  // Same layout as AStar::reconstructPath, target first and the robot last
+  Path p;
+  p.header = pathHeader(oGrid);
+  for (int i = poses.size() - 1; i >= 0; --i)
+    p.poses.push_back(poseStamped(poses[i].x, poses[i].y, poses[i].yaw, oGrid));
+
+  return p;
+}
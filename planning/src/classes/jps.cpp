@@ -0,0 +1,213 @@
+#include <jps.h>
+#include <ros/ros.h>
+
+#include <math.h>
+
+using geometry_msgs::Point;
+using nav_msgs::Path;
+
+inline bool JPS::walkable(int x, int y, const nav_msgs::OccupancyGrid &oGrid, int threshold, int endIndex)
+{
+  if (x < 0 || y < 0 || x >= (int)oGrid.info.width || y >= (int)oGrid.info.height)
+    return false;
+
+  int index = y * oGrid.info.width + x;
+  return oGrid.data[index] < threshold || index == endIndex;
+}
+
+double JPS::octileDistance(int ind1, int ind2, int width)
+{
+  int dx = abs(ind1 % width - ind2 % width);
+  int dy = abs(ind1 / width - ind2 / width);
+  return std::max(dx, dy) + (M_SQRT2 - 1) * std::min(dx, dy);
+}
+
+int JPS::jumpStraight(int x, int y, int dx, int dy, const nav_msgs::OccupancyGrid &oGrid, int threshold, int endIndex)
+{
+  while (true)
+  {
+    x += dx;
+    y += dy;
+
+    if (!walkable(x, y, oGrid, threshold, endIndex))
+      return -1;
+
+    int index = y * oGrid.info.width + x;
+    if (index == endIndex)
+      return index;
+
+    // A cell is a jump point if an obstacle behind it to the side opens up (a forced neighbor)
+    if (dx != 0)
+    {
+      if ((walkable(x, y + 1, oGrid, threshold, endIndex) && !walkable(x - dx, y + 1, oGrid, threshold, endIndex)) ||
+          (walkable(x, y - 1, oGrid, threshold, endIndex) && !walkable(x - dx, y - 1, oGrid, threshold, endIndex)))
+        return index;
+    }
+    else
+    {
+      if ((walkable(x + 1, y, oGrid, threshold, endIndex) && !walkable(x + 1, y - dy, oGrid, threshold, endIndex)) ||
+          (walkable(x - 1, y, oGrid, threshold, endIndex) && !walkable(x - 1, y - dy, oGrid, threshold, endIndex)))
+        return index;
+    }
+  }
+}
+
+int JPS::jumpDiagonal(int x, int y, int dx, int dy, const nav_msgs::OccupancyGrid &oGrid, int threshold, int endIndex)
+{
+  while (true)
+  {
+    // No corner cutting, both straight cells next to the diagonal step have to be free
+    if (!walkable(x + dx, y, oGrid, threshold, endIndex) || !walkable(x, y + dy, oGrid, threshold, endIndex))
+      return -1;
+
+    x += dx;
+    y += dy;
+
+    if (!walkable(x, y, oGrid, threshold, endIndex))
+      return -1;
+
+    int index = y * oGrid.info.width + x;
+    if (index == endIndex)
+      return index;
+
+    // A diagonal cell is a jump point if one of the straight jumps from it finds something
+    if (jumpStraight(x, y, dx, 0, oGrid, threshold, endIndex) != -1 || jumpStraight(x, y, 0, dy, oGrid, threshold, endIndex) != -1)
+      return index;
+  }
+}
+
+int JPS::getPrunedDirections(int current, int parent, const nav_msgs::OccupancyGrid &oGrid, int threshold, int endIndex, std::array<std::pair<int, int>, 8> &directions)
+{
+  int width = oGrid.info.width;
+  int x = current % width;
+  int y = current / width;
+  int count = 0;
+
+  // The start has no parent, so every direction is searched
+  if (parent == -1)
+  {
+    for (int dx = -1; dx <= 1; ++dx)
+      for (int dy = -1; dy <= 1; ++dy)
+        if (dx != 0 || dy != 0)
+          directions[count++] = std::make_pair(dx, dy);
+    return count;
+  }
+
+  // Direction of travel, normalized since jump points can be many cells apart
+  int dx = (x > parent % width) - (x < parent % width);
+  int dy = (y > parent / width) - (y < parent / width);
+
+  if (dx != 0 && dy != 0)
+  {
+    // Diagonal: the natural neighbors are the two straight directions and the diagonal itself
+    directions[count++] = std::make_pair(dx, 0);
+    directions[count++] = std::make_pair(0, dy);
+    directions[count++] = std::make_pair(dx, dy);
+  }
+  else if (dx != 0)
+  {
+    directions[count++] = std::make_pair(dx, 0);
+
+    // Forced neighbors, where an obstacle behind us to the side opens up
+    for (int side : {-1, 1})
+    {
+      if (walkable(x, y + side, oGrid, threshold, endIndex) && !walkable(x - dx, y + side, oGrid, threshold, endIndex))
+      {
+        directions[count++] = std::make_pair(0, side);
+        directions[count++] = std::make_pair(dx, side);
+      }
+    }
+  }
+  else
+  {
+    directions[count++] = std::make_pair(0, dy);
+
+    for (int side : {-1, 1})
+    {
+      if (walkable(x + side, y, oGrid, threshold, endIndex) && !walkable(x + side, y - dy, oGrid, threshold, endIndex))
+      {
+        directions[count++] = std::make_pair(side, 0);
+        directions[count++] = std::make_pair(side, dy);
+      }
+    }
+  }
+
+  return count;
+}
+
+Path JPS::findPathOccGrid(const nav_msgs::OccupancyGrid &oGrid, const Point target, int threshold)
+{
+  // Each thread keeps its own search space, so repeated service calls don't reallocate the per-cell arrays
+  static thread_local SearchSpace space;
+  return findPathOccGrid(oGrid, target, space, threshold);
+}
+
+Path JPS::findPathOccGrid(const nav_msgs::OccupancyGrid &oGrid, const Point target, SearchSpace &space, int threshold)
+{
+  if (oGrid.data.size() == 0)
+  {
+    ROS_WARN("Occupancy Grid is Empty.");
+    return Path();
+  }
+
+  int width = oGrid.info.width;
+  int endIndex = getTargetIndex(oGrid, target, threshold);
+  int centerIndex = (oGrid.info.height / 2) * width + width / 2;
+
+  // Check if the final destination is occupied.
+  if (oGrid.data[endIndex] > threshold)
+  {
+    ROS_WARN("TARGET IN OCCUPIED SPACE, UNREACHABLE");
+    return Path();
+  }
+
+  // Same as A*, we can't start from inside an obstacle
+  if (oGrid.data[centerIndex] >= threshold && centerIndex != endIndex)
+  {
+    ROS_WARN("[WARNING] Call to navigation failed to find valid path.\n");
+    return Path();
+  }
+
+  space.reset(oGrid.data.size());
+  space.setScore(centerIndex, 0, -1);
+  space.open.push(centerIndex, 0);
+
+  std::array<std::pair<int, int>, 8> directions;
+
+  while (!space.open.empty())
+  {
+    int current = space.open.pop();
+    space.close(current);
+
+    if (current == endIndex)
+    {
+      return reconstructPath(current, centerIndex, space, oGrid);
+    }
+
+    double current_gscore = space.gScore(current);
+    int x = current % width;
+    int y = current / width;
+
+    int count = getPrunedDirections(current, space.cameFrom(current), oGrid, threshold, endIndex, directions);
+    for (int i = 0; i < count; ++i)
+    {
+      int dx = directions[i].first;
+      int dy = directions[i].second;
+
+      int jumpPoint = (dx != 0 && dy != 0) ? jumpDiagonal(x, y, dx, dy, oGrid, threshold, endIndex)
+                                           : jumpStraight(x, y, dx, dy, oGrid, threshold, endIndex);
+      if (jumpPoint == -1 || space.isClosed(jumpPoint))
+        continue;
+
+      double tentative_gscore = current_gscore + octileDistance(current, jumpPoint, width);
+      if (tentative_gscore < space.gScore(jumpPoint))
+      {
+        space.setScore(jumpPoint, tentative_gscore, current);
+        space.open.push(jumpPoint, tentative_gscore + octileDistance(jumpPoint, endIndex, width));
+      }
+    }
+  }
+
+  ROS_WARN("[WARNING] Call to navigation failed to find valid path.\n");
+  return Path();
+}
@@ -0,0 +1,124 @@
+#include <multi_goal.h>
+
+#include <algorithm>
+#include <math.h>
+
+void MultiGoal::sweep(const nav_msgs::OccupancyGrid &oGrid, int source, const std::vector<int> &targets, SearchSpace &space, int threshold)
+{
+  int width = oGrid.info.width;
+  int height = oGrid.info.height;
+
+  // Targets can be entered even when occupied, same as the A* target
+  std::vector<int> isTarget;
+  int remaining = 0;
+  for (int target : targets)
+  {
+    if (std::find(isTarget.begin(), isTarget.end(), target) == isTarget.end())
+    {
+      isTarget.push_back(target);
+      ++remaining;
+    }
+  }
+
+  auto enterable = [&](int x, int y) {
+    if (x < 0 || y < 0 || x >= width || y >= height)
+      return false;
+    int index = y * width + x;
+    return oGrid.data[index] < threshold || std::find(isTarget.begin(), isTarget.end(), index) != isTarget.end();
+  };
+
+  space.reset(oGrid.data.size());
+  space.setScore(source, 0, -1);
+  space.open.push(source, 0);
+
+  while (!space.open.empty() && (remaining > 0 || targets.empty()))
+  {
+    int current = space.open.pop();
+    space.close(current);
+
+    if (std::find(isTarget.begin(), isTarget.end(), current) != isTarget.end())
+      --remaining;
+
+    // Occupied cells are never passed through, the source is the only exception
+    if (oGrid.data[current] >= threshold && current != source)
+      continue;
+
+    int x = current % width;
+    int y = current / width;
+    double current_gscore = space.gScore(current);
+
+    for (int dy = -1; dy <= 1; ++dy)
+    {
+      for (int dx = -1; dx <= 1; ++dx)
+      {
+        if ((dx == 0 && dy == 0) || !enterable(x + dx, y + dy))
+          continue;
+        if (dx != 0 && dy != 0 && (!enterable(x + dx, y) || !enterable(x, y + dy)))
+          continue;
+
+        int neighbor = current + dy * width + dx;
+        if (space.isClosed(neighbor))
+          continue;
+
+        double tentative_gscore = current_gscore + (dx != 0 && dy != 0 ? M_SQRT2 : 1);
+        if (tentative_gscore < space.gScore(neighbor))
+        {
+          space.setScore(neighbor, tentative_gscore, current);
+          space.open.push(neighbor, tentative_gscore);
+        }
+      }
+    }
+  }
+}
+
+std::vector<double> MultiGoal::costMatrix(const nav_msgs::OccupancyGrid &oGrid, const std::vector<int> &starts, const std::vector<int> &goals,
+                                          std::vector<std::vector<int>> *paths, int threshold)
+{
+  static thread_local SearchSpace space;
+
+  int size = oGrid.data.size();
+  std::vector<double> costs(starts.size() * goals.size(), INFINITY);
+  if (paths != nullptr)
+    paths->assign(costs.size(), std::vector<int>());
+
+  // Sweep from whichever side has fewer cells
+  bool fromGoals = goals.size() < starts.size();
+  const std::vector<int> &sources = fromGoals ? goals : starts;
+  const std::vector<int> &targets = fromGoals ? starts : goals;
+
+  std::vector<int> validTargets;
+  for (int target : targets)
+  {
+    if (target >= 0 && target < size)
+      validTargets.push_back(target);
+  }
+
+  for (int s = 0; s < (int)sources.size(); ++s)
+  {
+    if (sources[s] < 0 || sources[s] >= size)
+      continue;
+
+    sweep(oGrid, sources[s], validTargets, space, threshold);
+
+    for (int t = 0; t < (int)targets.size(); ++t)
+    {
+      if (targets[t] < 0 || targets[t] >= size || space.gScore(targets[t]) == INFINITY)
+        continue;
+
+      int entry = fromGoals ? t * goals.size() + s : s * goals.size() + t;
+      costs[entry] = space.gScore(targets[t]);
+
+      if (paths == nullptr)
+        continue;
+
+      // The parents lead back to the source, which is the goal when sweeping from the goals
+      std::vector<int> &path = (*paths)[entry];
+      for (int current = targets[t]; current != -1; current = space.cameFrom(current))
+        path.push_back(current);
+      if (!fromGoals)
+        std::reverse(path.begin(), path.end());
+    }
+  }
+
+  return costs;
+}
@@ -0,0 +1,31 @@
+#include <padded_grid.h>
+
+#include <algorithm>
+
+const int8_t PaddedGrid::BORDER;
+constexpr int PaddedGrid::NEIGHBORS;
+constexpr int PaddedGrid::DX[];
+constexpr int PaddedGrid::DY[];
+constexpr double PaddedGrid::STEP_COST[];
+
+void PaddedGrid::assign(const nav_msgs::OccupancyGrid &oGrid)
+{
+  grid_width_ = oGrid.info.width;
+  width_ = grid_width_ + 2;
+  height_ = oGrid.info.height + 2;
+
+  // Only the border needs filling, every other cell is overwritten by the copy below
+  data_.resize(width_ * height_);
+  std::fill(data_.begin(), data_.begin() + width_, BORDER);
+  std::fill(data_.end() - width_, data_.end(), BORDER);
+  for (int y = 1; y < height_ - 1; ++y)
+  {
+    int8_t *row = &data_[y * width_];
+    row[0] = BORDER;
+    row[width_ - 1] = BORDER;
+    std::copy(&oGrid.data[(y - 1) * grid_width_], &oGrid.data[(y - 1) * grid_width_] + grid_width_, row + 1);
+  }
+
+  for (int k = 0; k < NEIGHBORS; ++k)
+    offsets_[k] = DY[k] * width_ + DX[k];
+}
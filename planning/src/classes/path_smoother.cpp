@@ -0,0 +1,259 @@
+#include <path_smoother.h>
+
+#include <algorithm>
+#include <math.h>
+
+using geometry_msgs::PoseStamped;
+using nav_msgs::Path;
+
+// Lines are checked every quarter of a cell
+#define SEGMENT_SAMPLES_PER_CELL 4
+
+// Each corner tries narrower arcs until one is free, down to a cell
+#define ARC_SHRINK 0.5
+
+// Corners that turn less than this are left as they are, in radians
+#define MIN_CORNER_ANGLE 1e-3
+
+struct Point2
+{
+  double x, y;
+};
+
+static double length(const Point2 &a, const Point2 &b)
+{
+  return hypot(b.x - a.x, b.y - a.y);
+}
+
+// Robot first, the order the robot drives through the path
+static std::vector<Point2> drivingOrder(const Path &path)
+{
+  std::vector<Point2> points;
+  for (auto it = path.poses.rbegin(); it != path.poses.rend(); ++it)
+    points.push_back({it->pose.position.x, it->pose.position.y});
+  return points;
+}
+
+int PathSmoother::cellIndex(double x, double y, const nav_msgs::OccupancyGrid &oGrid)
+{
+  // Inverse of AStar::poseStampedFromIndex
+  int cx = lround(x / oGrid.info.resolution) + oGrid.info.width / 2;
+  int cy = lround(y / oGrid.info.resolution) + oGrid.info.height / 2;
+  if (cx < 0 || cy < 0 || cx >= (int)oGrid.info.width || cy >= (int)oGrid.info.height)
+    return -1;
+  return cy * oGrid.info.width + cx;
+}
+
+bool PathSmoother::segmentFree(double x0, double y0, double x1, double y1, const nav_msgs::OccupancyGrid &oGrid, int threshold, int startIndex,
+                               int endIndex)
+{
+  int samples = std::max(1, (int)ceil(hypot(x1 - x0, y1 - y0) / oGrid.info.resolution * SEGMENT_SAMPLES_PER_CELL));
+  for (int i = 0; i <= samples; ++i)
+  {
+    double f = (double)i / samples;
+    int index = cellIndex(x0 + (x1 - x0) * f, y0 + (y1 - y0) * f, oGrid);
+    if (index != -1 && index != startIndex && index != endIndex && oGrid.data[index] >= threshold)
+      return false;
+  }
+  return true;
+}
+
+Path PathSmoother::shortcut(const Path &path, const nav_msgs::OccupancyGrid &oGrid, int threshold)
+{
+  if (path.poses.size() < 3)
+    return path;
+
+  const std::vector<PoseStamped> &poses = path.poses;
+  int endIndex = cellIndex(poses.front().pose.position.x, poses.front().pose.position.y, oGrid);
+  int startIndex = cellIndex(poses.back().pose.position.x, poses.back().pose.position.y, oGrid);
+
+  Path shortened;
+  shortened.header = path.header;
+  shortened.poses.push_back(poses.front());
+
+  // From each kept waypoint, jump straight to the furthest one that can be seen from it
+  int current = 0;
+  while (current < (int)poses.size() - 1)
+  {
+    int next = poses.size() - 1;
+    const geometry_msgs::Point &a = poses[current].pose.position;
+    while (next > current + 1 && !segmentFree(a.x, a.y, poses[next].pose.position.x, poses[next].pose.position.y, oGrid, threshold, startIndex, endIndex))
+      --next;
+
+    shortened.poses.push_back(poses[next]);
+    current = next;
+  }
+
+  return shortened;
+}
+
+Path PathSmoother::smooth(const Path &path, const nav_msgs::OccupancyGrid &oGrid, double turnRadius, double spacing, int threshold)
+{
+  if (path.poses.size() < 2)
+    return path;
+
+  std::vector<Point2> points = drivingOrder(path);
+  int n = points.size();
+  int startIndex = cellIndex(points.front().x, points.front().y, oGrid);
+  int endIndex = cellIndex(points.back().x, points.back().y, oGrid);
+  double resolution = oGrid.info.resolution;
+
+  // Samples at an even spacing along the lines and arcs, carrying the leftover distance from one piece to the next
+  std::vector<Point2> samples = {points.front()};
+  double carried = 0;
+  auto addLine = [&](const Point2 &a, const Point2 &b) {
+    double total = length(a, b);
+    if (total <= 0)
+      return;
+
+    double s = spacing - carried;
+    for (; s < total; s += spacing)
+      samples.push_back({a.x + (b.x - a.x) * s / total, a.y + (b.y - a.y) * s / total});
+    carried = total - (s - spacing);
+  };
+  auto addArc = [&](const Point2 &center, double radius, double angle0, double sweep) {
+    double total = radius * fabs(sweep);
+    double s = spacing - carried;
+    for (; s < total; s += spacing)
+    {
+      double angle = angle0 + sweep * s / total;
+      samples.push_back({center.x + radius * cos(angle), center.y + radius * sin(angle)});
+    }
+    carried = total - (s - spacing);
+  };
+
+  // Each corner is cut from where its arc leaves the incoming segment (entry) to where it joins the outgoing one
+  Point2 entry = points.front();
+  for (int i = 1; i < n - 1; ++i)
+  {
+    const Point2 &a = points[i - 1], &b = points[i], &c = points[i + 1];
+    double inLength = length(a, b), outLength = length(b, c);
+    if (inLength <= 0 || outLength <= 0)
+      continue;
+
+    double ux = (b.x - a.x) / inLength, uy = (b.y - a.y) / inLength;
+    double vx = (c.x - b.x) / outLength, vy = (c.y - b.y) / outLength;
+    double turn = atan2(ux * vy - uy * vx, ux * vx + uy * vy);
+
+    // Segments shared with another corner only give it half their length, the path's ends give all of it
+    double available = std::min(i == 1 ? inLength : inLength / 2, i == n - 2 ? outLength : outLength / 2);
+    double radius = 0;
+    Point2 center = b, arcStart = b;
+    double angle0 = 0;
+
+    if (fabs(turn) > MIN_CORNER_ANGLE && fabs(turn) < M_PI - MIN_CORNER_ANGLE)
+    {
+      double halfTan = tan(fabs(turn) / 2);
+      for (radius = std::min(turnRadius, available / halfTan); radius >= resolution; radius *= ARC_SHRINK)
+      {
+        double tangent = radius * halfTan;
+        double side = turn > 0 ? 1 : -1;
+        arcStart = {b.x - ux * tangent, b.y - uy * tangent};
+        center = {arcStart.x - uy * radius * side, arcStart.y + ux * radius * side};
+        angle0 = atan2(arcStart.y - center.y, arcStart.x - center.x);
+
+        // The lines either side stay on the original segments, only the arc has to be checked
+        int steps = std::max(2, (int)ceil(radius * fabs(turn) / resolution));
+        bool free = true;
+        Point2 previous = arcStart;
+        for (int k = 1; k <= steps && free; ++k)
+        {
+          double angle = angle0 + turn * k / steps;
+          Point2 current = {center.x + radius * cos(angle), center.y + radius * sin(angle)};
+          free = segmentFree(previous.x, previous.y, current.x, current.y, oGrid, threshold, startIndex, endIndex);
+          previous = current;
+        }
+        if (free)
+          break;
+      }
+    }
+
+    if (radius < resolution)
+    {
+      // Not even a one cell arc fits, keep the corner sharp
+      addLine(entry, b);
+      entry = b;
+      continue;
+    }
+
+    double tangent = radius * tan(fabs(turn) / 2);
+    addLine(entry, arcStart);
+    addArc(center, radius, angle0, turn);
+    entry = {b.x + vx * tangent, b.y + vy * tangent};
+  }
+  addLine(entry, points.back());
+
+  // Finish exactly on the target
+  if (length(samples.back(), points.back()) > 0)
+    samples.push_back(points.back());
+
+  // Target first again, each pose facing the next one along the way
+  Path smoothed;
+  smoothed.header = path.header;
+  PoseStamped pose;
+  pose.header = path.poses.front().header;
+  for (int i = samples.size() - 1; i >= 0; --i)
+  {
+    const Point2 &from = samples[i == (int)samples.size() - 1 ? i - 1 : i];
+    const Point2 &to = samples[i == (int)samples.size() - 1 ? i : i + 1];
+    double yaw = atan2(to.y - from.y, to.x - from.x);
+
+    pose.pose.position.x = samples[i].x;
+    pose.pose.position.y = samples[i].y;
+    pose.pose.orientation.z = sin(yaw / 2);
+    pose.pose.orientation.w = cos(yaw / 2);
+    smoothed.poses.push_back(pose);
+  }
+
+  return smoothed;
+}
+
+std::vector<double> PathSmoother::velocityProfile(const Path &path, const nav_msgs::OccupancyGrid &oGrid, const std::vector<float> &distanceField,
+                                                  const Limits &limits)
+{
+  std::vector<Point2> points = drivingOrder(path);
+  int n = points.size();
+  std::vector<double> speeds(n, limits.max_speed);
+
+  for (int i = 0; i < n; ++i)
+  {
+    // Curvature from the circle through the waypoint and its neighbors
+    if (i > 0 && i < n - 1)
+    {
+      const Point2 &a = points[i - 1], &b = points[i], &c = points[i + 1];
+      double ab = length(a, b), bc = length(b, c), ac = length(a, c);
+      double cross = fabs((b.x - a.x) * (c.y - b.y) - (b.y - a.y) * (c.x - b.x));
+      if (ab > 0 && bc > 0 && ac > 0 && cross > 0)
+      {
+        double curvature = 2 * cross / (ab * bc * ac);
+        speeds[i] = std::min(speeds[i], sqrt(limits.max_lateral_acceleration / curvature));
+      }
+      else if (ac <= 0 && ab > 0)
+      {
+        // Turning back on itself
+        speeds[i] = limits.min_speed;
+      }
+    }
+
+    int index = cellIndex(points[i].x, points[i].y, oGrid);
+    if (index != -1 && !distanceField.empty())
+    {
+      double clearance = distanceField[index] * oGrid.info.resolution;
+      double open = std::min(1.0, std::max(0.0, (clearance - limits.min_clearance) / (limits.slow_clearance - limits.min_clearance)));
+      speeds[i] = std::min(speeds[i], limits.min_speed + (limits.max_speed - limits.min_speed) * open);
+    }
+
+    speeds[i] = std::max(speeds[i], limits.min_speed);
+  }
+  speeds.front() = speeds.back() = limits.min_speed;
+
+  // Speed up no faster than the acceleration limit, then brake early enough for every slower waypoint ahead
+  for (int i = 1; i < n; ++i)
+    speeds[i] = std::min(speeds[i], sqrt(speeds[i - 1] * speeds[i - 1] + 2 * limits.max_acceleration * length(points[i - 1], points[i])));
+  for (int i = n - 2; i >= 0; --i)
+    speeds[i] = std::min(speeds[i], sqrt(speeds[i + 1] * speeds[i + 1] + 2 * limits.max_acceleration * length(points[i], points[i + 1])));
+
+  // Target first, like the path
+  std::reverse(speeds.begin(), speeds.end());
+  return speeds;
+}
@@ -0,0 +1,378 @@
+#include <reeds_shepp.h>
+
+#include <algorithm>
+#include <math.h>
+
+// Tolerance on the segment signs, so paths that end exactly on a boundary case are kept
+#define RS_ZERO 1e-9
+
+namespace
+{
+typedef ReedsShepp::SegmentType Segment;
+const Segment L = ReedsShepp::LEFT, S = ReedsShepp::STRAIGHT, R = ReedsShepp::RIGHT, N = ReedsShepp::NOP;
+
+// The path families, numbered like in the OMPL implementation
+const Segment PATH_TYPES[18][5] = {
+    {L, R, L, N, N}, {R, L, R, N, N}, {L, R, L, R, N}, {R, L, R, L, N}, {L, R, S, L, N}, {R, L, S, R, N},
+    {L, S, R, L, N}, {R, S, L, R, N}, {L, R, S, R, N}, {R, L, S, L, N}, {R, S, R, L, N}, {L, S, L, R, N},
+    {L, S, R, N, N}, {R, S, L, N, N}, {L, S, L, N, N}, {R, S, R, N, N}, {L, R, S, L, R}, {R, L, S, R, L}};
+
+double mod2pi(double x)
+{
+  double v = fmod(x, 2 * M_PI);
+  if (v < -M_PI)
+    v += 2 * M_PI;
+  else if (v > M_PI)
+    v -= 2 * M_PI;
+  return v;
+}
+
+void polar(double x, double y, double &r, double &theta)
+{
+  r = sqrt(x * x + y * y);
+  theta = atan2(y, x);
+}
+
+void tauOmega(double u, double v, double xi, double eta, double phi, double &tau, double &omega)
+{
+  double delta = mod2pi(u - v), A = sin(u) - sin(delta), B = cos(u) - cos(delta) - 1.;
+  double t1 = atan2(eta * A - xi * B, xi * A + eta * B), t2 = 2. * (cos(delta) - cos(v) - cos(u)) + 3;
+  tau = (t2 < 0) ? mod2pi(t1 + M_PI) : mod2pi(t1);
+  omega = mod2pi(tau - u + v - phi);
+}
+
+// Keeps the candidate if it is shorter than the best path so far
+void consider(ReedsShepp::Path &best, double &bestLength, int type, double t, double u, double v, double w = 0, double x = 0)
+{
+  double length = fabs(t) + fabs(u) + fabs(v) + fabs(w) + fabs(x);
+  if (length >= bestLength)
+    return;
+
+  bestLength = length;
+  const double lengths[5] = {t, u, v, w, x};
+  for (int i = 0; i < 5; ++i)
+  {
+    best.types[i] = PATH_TYPES[type][i];
+    best.lengths[i] = PATH_TYPES[type][i] == N ? 0 : lengths[i];
+  }
+}
+
+// Formula 8.1
+bool LpSpLp(double x, double y, double phi, double &t, double &u, double &v)
+{
+  polar(x - sin(phi), y - 1. + cos(phi), u, t);
+  if (t >= -RS_ZERO)
+  {
+    v = mod2pi(phi - t);
+    if (v >= -RS_ZERO)
+      return true;
+  }
+  return false;
+}
+
+// Formula 8.2
+bool LpSpRp(double x, double y, double phi, double &t, double &u, double &v)
+{
+  double t1, u1;
+  polar(x + sin(phi), y - 1. - cos(phi), u1, t1);
+  u1 = u1 * u1;
+  if (u1 >= 4.)
+  {
+    u = sqrt(u1 - 4.);
+    double theta = atan2(2., u);
+    t = mod2pi(t1 + theta);
+    v = mod2pi(t - phi);
+    return t >= -RS_ZERO && v >= -RS_ZERO;
+  }
+  return false;
+}
+
+// Formulas 8.3 and 8.4, corrected
+bool LpRmL(double x, double y, double phi, double &t, double &u, double &v)
+{
+  double xi = x - sin(phi), eta = y - 1. + cos(phi), u1, theta;
+  polar(xi, eta, u1, theta);
+  if (u1 <= 4.)
+  {
+    u = -2. * asin(.25 * u1);
+    t = mod2pi(theta + .5 * u + M_PI);
+    v = mod2pi(phi - t + u);
+    return t >= -RS_ZERO && u <= RS_ZERO;
+  }
+  return false;
+}
+
+// Formula 8.7
+bool LpRupLumRm(double x, double y, double phi, double &t, double &u, double &v)
+{
+  double xi = x + sin(phi), eta = y - 1. - cos(phi), rho = .25 * (2. + sqrt(xi * xi + eta * eta));
+  if (rho <= 1.)
+  {
+    u = acos(rho);
+    tauOmega(u, -u, xi, eta, phi, t, v);
+    return t >= -RS_ZERO && v <= RS_ZERO;
+  }
+  return false;
+}
+
+// Formula 8.8
+bool LpRumLumRp(double x, double y, double phi, double &t, double &u, double &v)
+{
+  double xi = x + sin(phi), eta = y - 1. - cos(phi), rho = (20. - xi * xi - eta * eta) / 16.;
+  if (rho >= 0 && rho <= 1)
+  {
+    u = -acos(rho);
+    if (u >= -.5 * M_PI)
+    {
+      tauOmega(u, u, xi, eta, phi, t, v);
+      return t >= -RS_ZERO && v >= -RS_ZERO;
+    }
+  }
+  return false;
+}
+
+// Formula 8.9
+bool LpRmSmLm(double x, double y, double phi, double &t, double &u, double &v)
+{
+  double xi = x - sin(phi), eta = y - 1. + cos(phi), rho, theta;
+  polar(xi, eta, rho, theta);
+  if (rho >= 2.)
+  {
+    double r = sqrt(rho * rho - 4.);
+    u = 2. - r;
+    t = mod2pi(theta + atan2(r, -2.));
+    v = mod2pi(phi - .5 * M_PI - t);
+    return t >= -RS_ZERO && u <= RS_ZERO && v <= RS_ZERO;
+  }
+  return false;
+}
+
+// Formula 8.10
+bool LpRmSmRm(double x, double y, double phi, double &t, double &u, double &v)
+{
+  double xi = x + sin(phi), eta = y - 1. - cos(phi), rho, theta;
+  polar(-eta, xi, rho, theta);
+  if (rho >= 2.)
+  {
+    t = theta;
+    u = 2. - rho;
+    v = mod2pi(t + .5 * M_PI - phi);
+    return t >= -RS_ZERO && u <= RS_ZERO && v <= RS_ZERO;
+  }
+  return false;
+}
+
+// Formula 8.11, corrected
+bool LpRmSLmRp(double x, double y, double phi, double &t, double &u, double &v)
+{
+  double xi = x + sin(phi), eta = y - 1. - cos(phi), rho, theta;
+  polar(xi, eta, rho, theta);
+  if (rho >= 2.)
+  {
+    u = 4. - sqrt(rho * rho - 4.);
+    if (u <= RS_ZERO)
+    {
+      t = mod2pi(atan2((4 - u) * xi - 2 * eta, -2 * xi + (u - 4) * eta));
+      v = mod2pi(t - phi);
+      return t >= -RS_ZERO && v >= -RS_ZERO;
+    }
+  }
+  return false;
+}
+
+// Each family is tried as is, driven backwards (timeflip), mirrored (reflect) and both
+
+void CSC(double x, double y, double phi, ReedsShepp::Path &path, double &Lmin)
+{
+  double t, u, v;
+  if (LpSpLp(x, y, phi, t, u, v))
+    consider(path, Lmin, 14, t, u, v);
+  if (LpSpLp(-x, y, -phi, t, u, v))
+    consider(path, Lmin, 14, -t, -u, -v);
+  if (LpSpLp(x, -y, -phi, t, u, v))
+    consider(path, Lmin, 15, t, u, v);
+  if (LpSpLp(-x, -y, phi, t, u, v))
+    consider(path, Lmin, 15, -t, -u, -v);
+  if (LpSpRp(x, y, phi, t, u, v))
+    consider(path, Lmin, 12, t, u, v);
+  if (LpSpRp(-x, y, -phi, t, u, v))
+    consider(path, Lmin, 12, -t, -u, -v);
+  if (LpSpRp(x, -y, -phi, t, u, v))
+    consider(path, Lmin, 13, t, u, v);
+  if (LpSpRp(-x, -y, phi, t, u, v))
+    consider(path, Lmin, 13, -t, -u, -v);
+}
+
+void CCC(double x, double y, double phi, ReedsShepp::Path &path, double &Lmin)
+{
+  double t, u, v;
+  if (LpRmL(x, y, phi, t, u, v))
+    consider(path, Lmin, 0, t, u, v);
+  if (LpRmL(-x, y, -phi, t, u, v))
+    consider(path, Lmin, 0, -t, -u, -v);
+  if (LpRmL(x, -y, -phi, t, u, v))
+    consider(path, Lmin, 1, t, u, v);
+  if (LpRmL(-x, -y, phi, t, u, v))
+    consider(path, Lmin, 1, -t, -u, -v);
+
+  // Same families, driven from the end
+  double xb = x * cos(phi) + y * sin(phi), yb = x * sin(phi) - y * cos(phi);
+  if (LpRmL(xb, yb, phi, t, u, v))
+    consider(path, Lmin, 0, v, u, t);
+  if (LpRmL(-xb, yb, -phi, t, u, v))
+    consider(path, Lmin, 0, -v, -u, -t);
+  if (LpRmL(xb, -yb, -phi, t, u, v))
+    consider(path, Lmin, 1, v, u, t);
+  if (LpRmL(-xb, -yb, phi, t, u, v))
+    consider(path, Lmin, 1, -v, -u, -t);
+}
+
+void CCCC(double x, double y, double phi, ReedsShepp::Path &path, double &Lmin)
+{
+  double t, u, v;
+  if (LpRupLumRm(x, y, phi, t, u, v))
+    consider(path, Lmin, 2, t, u, -u, v);
+  if (LpRupLumRm(-x, y, -phi, t, u, v))
+    consider(path, Lmin, 2, -t, -u, u, -v);
+  if (LpRupLumRm(x, -y, -phi, t, u, v))
+    consider(path, Lmin, 3, t, u, -u, v);
+  if (LpRupLumRm(-x, -y, phi, t, u, v))
+    consider(path, Lmin, 3, -t, -u, u, -v);
+
+  if (LpRumLumRp(x, y, phi, t, u, v))
+    consider(path, Lmin, 2, t, u, u, v);
+  if (LpRumLumRp(-x, y, -phi, t, u, v))
+    consider(path, Lmin, 2, -t, -u, -u, -v);
+  if (LpRumLumRp(x, -y, -phi, t, u, v))
+    consider(path, Lmin, 3, t, u, u, v);
+  if (LpRumLumRp(-x, -y, phi, t, u, v))
+    consider(path, Lmin, 3, -t, -u, -u, -v);
+}
+
+void CCSC(double x, double y, double phi, ReedsShepp::Path &path, double &Lmin)
+{
+  double t, u, v;
+  if (LpRmSmLm(x, y, phi, t, u, v))
+    consider(path, Lmin, 4, t, -.5 * M_PI, u, v);
+  if (LpRmSmLm(-x, y, -phi, t, u, v))
+    consider(path, Lmin, 4, -t, .5 * M_PI, -u, -v);
+  if (LpRmSmLm(x, -y, -phi, t, u, v))
+    consider(path, Lmin, 5, t, -.5 * M_PI, u, v);
+  if (LpRmSmLm(-x, -y, phi, t, u, v))
+    consider(path, Lmin, 5, -t, .5 * M_PI, -u, -v);
+
+  if (LpRmSmRm(x, y, phi, t, u, v))
+    consider(path, Lmin, 8, t, -.5 * M_PI, u, v);
+  if (LpRmSmRm(-x, y, -phi, t, u, v))
+    consider(path, Lmin, 8, -t, .5 * M_PI, -u, -v);
+  if (LpRmSmRm(x, -y, -phi, t, u, v))
+    consider(path, Lmin, 9, t, -.5 * M_PI, u, v);
+  if (LpRmSmRm(-x, -y, phi, t, u, v))
+    consider(path, Lmin, 9, -t, .5 * M_PI, -u, -v);
+
+  // Same families, driven from the end
+  double xb = x * cos(phi) + y * sin(phi), yb = x * sin(phi) - y * cos(phi);
+  if (LpRmSmLm(xb, yb, phi, t, u, v))
+    consider(path, Lmin, 6, v, u, -.5 * M_PI, t);
+  if (LpRmSmLm(-xb, yb, -phi, t, u, v))
+    consider(path, Lmin, 6, -v, -u, .5 * M_PI, -t);
+  if (LpRmSmLm(xb, -yb, -phi, t, u, v))
+    consider(path, Lmin, 7, v, u, -.5 * M_PI, t);
+  if (LpRmSmLm(-xb, -yb, phi, t, u, v))
+    consider(path, Lmin, 7, -v, -u, .5 * M_PI, -t);
+
+  if (LpRmSmRm(xb, yb, phi, t, u, v))
+    consider(path, Lmin, 10, v, u, -.5 * M_PI, t);
+  if (LpRmSmRm(-xb, yb, -phi, t, u, v))
+    consider(path, Lmin, 10, -v, -u, .5 * M_PI, -t);
+  if (LpRmSmRm(xb, -yb, -phi, t, u, v))
+    consider(path, Lmin, 11, v, u, -.5 * M_PI, t);
+  if (LpRmSmRm(-xb, -yb, phi, t, u, v))
+    consider(path, Lmin, 11, -v, -u, .5 * M_PI, -t);
+}
+
+void CCSCC(double x, double y, double phi, ReedsShepp::Path &path, double &Lmin)
+{
+  double t, u, v;
+  if (LpRmSLmRp(x, y, phi, t, u, v))
+    consider(path, Lmin, 16, t, -.5 * M_PI, u, -.5 * M_PI, v);
+  if (LpRmSLmRp(-x, y, -phi, t, u, v))
+    consider(path, Lmin, 16, -t, .5 * M_PI, -u, .5 * M_PI, -v);
+  if (LpRmSLmRp(x, -y, -phi, t, u, v))
+    consider(path, Lmin, 17, t, -.5 * M_PI, u, -.5 * M_PI, v);
+  if (LpRmSLmRp(-x, -y, phi, t, u, v))
+    consider(path, Lmin, 17, -t, .5 * M_PI, -u, .5 * M_PI, -v);
+}
+
+// Moves a pose along one segment, for a unit turning radius
+void advance(Segment type, double length, double &x, double &y, double &yaw)
+{
+  switch (type)
+  {
+  case L:
+    x += sin(yaw + length) - sin(yaw);
+    y += -cos(yaw + length) + cos(yaw);
+    yaw += length;
+    break;
+  case R:
+    x += -sin(yaw - length) + sin(yaw);
+    y += cos(yaw - length) - cos(yaw);
+    yaw -= length;
+    break;
+  case S:
+    x += length * cos(yaw);
+    y += length * sin(yaw);
+    break;
+  default:
+    break;
+  }
+}
+} // namespace
+
+double ReedsShepp::Path::length() const
+{
+  if (types[0] == NOP)
+    return INFINITY;
+  return fabs(lengths[0]) + fabs(lengths[1]) + fabs(lengths[2]) + fabs(lengths[3]) + fabs(lengths[4]);
+}
+
+ReedsShepp::Path ReedsShepp::shortestPath(double x0, double y0, double yaw0, double x1, double y1, double yaw1, double radius)
+{
+  // Goal in the frame of the start, scaled to a unit radius
+  double dx = x1 - x0, dy = y1 - y0;
+  double c = cos(yaw0), s = sin(yaw0);
+  double x = (c * dx + s * dy) / radius;
+  double y = (-s * dx + c * dy) / radius;
+  double phi = mod2pi(yaw1 - yaw0);
+
+  Path path;
+  double Lmin = INFINITY;
+  CSC(x, y, phi, path, Lmin);
+  CCC(x, y, phi, path, Lmin);
+  CCCC(x, y, phi, path, Lmin);
+  CCSC(x, y, phi, path, Lmin);
+  CCSCC(x, y, phi, path, Lmin);
+  return path;
+}
+
+void ReedsShepp::sample(const Path &path, double x0, double y0, double yaw0, double radius, double step, std::vector<Sample> &samples)
+{
+  // Walk the path with a unit radius from the origin, then place each sample relative to the start
+  double x = 0, y = 0, yaw = 0;
+  double c = cos(yaw0), s = sin(yaw0);
+  double unitStep = step / radius;
+
+  for (int i = 0; i < 5 && path.types[i] != NOP; ++i)
+  {
+    double length = path.lengths[i];
+    if (fabs(length) < RS_ZERO)
+      continue;
+
+    int steps = std::max(1, (int)ceil(fabs(length) / unitStep));
+    for (int j = 0; j < steps; ++j)
+    {
+      advance(path.types[i], length / steps, x, y, yaw);
+      samples.push_back({x0 + radius * (c * x - s * y), y0 + radius * (s * x + c * y), yaw0 + yaw, length >= 0});
+    }
+  }
+}
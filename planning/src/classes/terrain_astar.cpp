@@ -0,0 +1,72 @@
+#include <terrain_astar.h>
+#include <ros/ros.h>
+
+#include <math.h>
+
+using geometry_msgs::Point;
+using nav_msgs::Path;
+
+Path TerrainAStar::findPathOccGrid(const nav_msgs::OccupancyGrid &costmap, const Point target, double costWeight)
+{
+  static thread_local SearchSpace space;
+  return findPathOccGrid(costmap, target, costWeight, space);
+}
+
+Path TerrainAStar::findPathOccGrid(const nav_msgs::OccupancyGrid &costmap, const Point target, double costWeight, SearchSpace &space)
+{
+  if (costmap.data.size() == 0)
+  {
+    ROS_WARN("Occupancy Grid is Empty.");
+    return Path();
+  }
+
+  int width = costmap.info.width;
+  int endIndex = getTargetIndex(costmap, target, Costmap::LETHAL_COST - 1);
+  int centerIndex = (costmap.info.height / 2) * width + width / 2;
+
+  if (costmap.data[endIndex] >= Costmap::LETHAL_COST)
+  {
+    ROS_WARN("TARGET IN OCCUPIED SPACE, UNREACHABLE");
+    return Path();
+  }
+
+  // Same padded grid as AStar, the border is above LETHAL_COST so it is never entered
+  static thread_local PaddedGrid grid;
+  grid.assign(costmap);
+  const std::array<int, 8> &offsets = grid.offsets();
+  int start = grid.toPadded(centerIndex);
+  int goal = grid.toPadded(endIndex);
+
+  space.reset(grid.size());
+  space.setScore(start, 0, -1);
+  space.open.push(start, 0);
+
+  while (!space.open.empty())
+  {
+    int current = space.open.pop();
+    space.close(current);
+
+    if (current == goal)
+      return reconstructPath(current, start, space, grid, costmap);
+
+    double current_gscore = space.gScore(current);
+
+    for (int k = 0; k < PaddedGrid::NEIGHBORS; ++k)
+    {
+      int neighbor = current + offsets[k];
+      if (space.isClosed(neighbor) || grid[neighbor] >= Costmap::LETHAL_COST)
+        continue;
+
+      double stretch = 1 + costWeight * std::max<int8_t>(grid[neighbor], 0) / Costmap::LETHAL_COST;
+      double tentative_gscore = current_gscore + PaddedGrid::STEP_COST[k] * stretch;
+      if (tentative_gscore < space.gScore(neighbor))
+      {
+        space.setScore(neighbor, tentative_gscore, current);
+        space.open.push(neighbor, tentative_gscore + distance(neighbor, goal, grid.width()));
+      }
+    }
+  }
+
+  ROS_WARN("[WARNING] Call to navigation failed to find valid path.\n");
+  return Path();
+}
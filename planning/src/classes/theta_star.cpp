@@ -0,0 +1,173 @@
+#include <theta_star.h>
+#include <ros/ros.h>
+
+#include <math.h>
+
+using geometry_msgs::Point;
+using nav_msgs::Path;
+
+inline bool ThetaStar::walkable(int x, int y, const nav_msgs::OccupancyGrid &oGrid, int threshold, int endIndex)
+{
+  if (x < 0 || y < 0 || x >= (int)oGrid.info.width || y >= (int)oGrid.info.height)
+    return false;
+
+  int index = y * oGrid.info.width + x;
+  return oGrid.data[index] < threshold || index == endIndex;
+}
+
+bool ThetaStar::lineOfSight(int ind1, int ind2, const nav_msgs::OccupancyGrid &oGrid, int threshold, int endIndex)
+{
+  int width = oGrid.info.width;
+  int x = ind1 % width, y = ind1 / width;
+  int x1 = ind2 % width, y1 = ind2 / width;
+
+  int dx = abs(x1 - x), dy = abs(y1 - y);
+  int sx = x < x1 ? 1 : -1, sy = y < y1 ? 1 : -1;
+  int err = dx - dy;
+
+  while (true)
+  {
+    if (!walkable(x, y, oGrid, threshold, endIndex))
+      return false;
+
+    if (x == x1 && y == y1)
+      return true;
+
+    int e2 = 2 * err;
+    bool stepX = e2 > -dy;
+    bool stepY = e2 < dx;
+
+    // Same rule as the grid moves, a diagonal step can't squeeze between two obstacles
+    if (stepX && stepY && (!walkable(x + sx, y, oGrid, threshold, endIndex) || !walkable(x, y + sy, oGrid, threshold, endIndex)))
+      return false;
+
+    if (stepX)
+    {
+      err -= dy;
+      x += sx;
+    }
+    if (stepY)
+    {
+      err += dx;
+      y += sy;
+    }
+  }
+}
+
+Path ThetaStar::reconstructPath(int current, const SearchSpace &space, const nav_msgs::OccupancyGrid &oGrid)
+{
+  // Same layout as AStar::reconstructPath, target first and the robot last
+  Path p;
+  p.header = pathHeader(oGrid);
+
+  for (; current != -1; current = space.cameFrom(current))
+    p.poses.push_back(poseStampedFromIndex(current, oGrid));
+
+  return p;
+}
+
+Path ThetaStar::findPathOccGrid(const nav_msgs::OccupancyGrid &oGrid, const Point target, int threshold)
+{
+  static thread_local SearchSpace space;
+  return findPathOccGrid(oGrid, target, space, threshold);
+}
+
+Path ThetaStar::findPathOccGrid(const nav_msgs::OccupancyGrid &oGrid, const Point target, SearchSpace &space, int threshold)
+{
+  if (oGrid.data.size() == 0)
+  {
+    ROS_WARN("Occupancy Grid is Empty.");
+    return Path();
+  }
+
+  int width = oGrid.info.width;
+  int endIndex = getTargetIndex(oGrid, target, threshold);
+  int centerIndex = (oGrid.info.height / 2) * width + width / 2;
+
+  // Check if the final destination is occupied.
+  if (oGrid.data[endIndex] > threshold)
+  {
+    ROS_WARN("TARGET IN OCCUPIED SPACE, UNREACHABLE");
+    return Path();
+  }
+
+  space.reset(oGrid.data.size());
+  space.setScore(centerIndex, 0, -1);
+  space.open.push(centerIndex, distance(centerIndex, endIndex, width));
+
+  while (!space.open.empty())
+  {
+    int current = space.open.pop();
+    int x = current % width;
+    int y = current / width;
+
+    // The parent was assumed to be visible when the cell was queued. If it isn't, settle for the best expanded neighbor.
+    int parent = space.cameFrom(current);
+    if (parent != -1 && !lineOfSight(parent, current, oGrid, threshold, endIndex))
+    {
+      double best_gscore = INFINITY;
+      int best = -1;
+      for (int dy = -1; dy <= 1; ++dy)
+      {
+        for (int dx = -1; dx <= 1; ++dx)
+        {
+          if ((dx == 0 && dy == 0) || !walkable(x + dx, y + dy, oGrid, threshold, endIndex))
+            continue;
+          if (dx != 0 && dy != 0 && (!walkable(x + dx, y, oGrid, threshold, endIndex) || !walkable(x, y + dy, oGrid, threshold, endIndex)))
+            continue;
+
+          int neighbor = current + dy * width + dx;
+          if (!space.isClosed(neighbor))
+            continue;
+
+          double gscore = space.gScore(neighbor) + distance(neighbor, current, width);
+          if (gscore < best_gscore)
+          {
+            best_gscore = gscore;
+            best = neighbor;
+          }
+        }
+      }
+      space.setScore(current, best_gscore, best);
+    }
+
+    space.close(current);
+
+    // Check if we hit the target
+    if (current == endIndex)
+      return reconstructPath(current, space, oGrid);
+
+    // If the node is occupied, we can't travel through it so skip it
+    if (oGrid.data[current] >= threshold)
+      continue;
+
+    // Neighbors are queued as if they could see the parent of the current cell, the check happens when they come out
+    int from = space.cameFrom(current) == -1 ? current : space.cameFrom(current);
+    double from_gscore = space.gScore(from);
+
+    for (int dy = -1; dy <= 1; ++dy)
+    {
+      for (int dx = -1; dx <= 1; ++dx)
+      {
+        if ((dx == 0 && dy == 0) || !walkable(x + dx, y + dy, oGrid, threshold, endIndex))
+          continue;
+        if (dx != 0 && dy != 0 && (!walkable(x + dx, y, oGrid, threshold, endIndex) || !walkable(x, y + dy, oGrid, threshold, endIndex)))
+          continue;
+
+        int neighbor = current + dy * width + dx;
+        if (space.isClosed(neighbor))
+          continue;
+
+        double tentative_gscore = from_gscore + distance(from, neighbor, width);
+        if (tentative_gscore < space.gScore(neighbor))
+        {
+          space.setScore(neighbor, tentative_gscore, from);
+          space.open.push(neighbor, tentative_gscore + distance(neighbor, endIndex, width));
+        }
+      }
+    }
+  }
+
+  ROS_WARN("[WARNING] Call to navigation failed to find valid path.\n");
+  return Path();
+}
@@ -2,12 +2,75 @@
 
 #include <cspace.h>
 #include <astar.h>
+#include <jps.h>
+#include <theta_star.h>
+#include <hybrid_astar.h>
+#include <cooperative_planner.h>
+#include <multi_goal.h>
+#include <path_smoother.h>
+#include <costmap.h>
+#include <terrain_astar.h>
+#include <ara_star.h>
+#include <bidirectional_astar.h>
 #include "planning/TrajectoryWithVelocities.h"
 #include <geometry_msgs/Point.h>
+#include <boost/make_shared.hpp>
+#include <diagnostic_msgs/DiagnosticArray.h>
+#include <algorithm>
+#include <memory>
 
 //Setting the node's update rate
 #define UPDATE_HZ 10
 
+// Threads serving requests, 0 for one per core
+#define SPINNER_THREADS 0
+
+// Padding for the CSpace, in cells
+#define CSPACE_THRESHOLD 50
+#define CSPACE_RADIUS 8
+
+// Padding for the arena map used by the batch and cooperative services, in coarse cells
+#define ARENA_CSPACE_RADIUS 1
+
+// Cooperative planning: robots are kept more than this many arena cells apart, over this many steps
+#define COOPERATIVE_SEPARATION 3
+#define COOPERATIVE_WINDOW 64
+
+// Driving speed used to time the cooperative paths, in m/s (NavigationServer's base drive speed)
+#define ROBOT_SPEED 0.6
+
+// Costmap for TERRAIN_ASTAR: the cost next to the padding, how far from the obstacles it fades out (in meters), and
+// how many times longer a step at LETHAL_COST would take than one on free ground
+#define INFLATION_COST 60
+#define COST_INFLATION_RADIUS 1.0
+#define TERRAIN_COST_WEIGHT 3
+
+// ARASTAR: the bound on the first path and how much it drops each time, the default time limit for a request and how
+// long the search keeps improving in the background afterwards, in slices (seconds)
+#define ARASTAR_EPSILON 3.0
+#define ARASTAR_EPSILON_STEP 0.5
+#define ARASTAR_TIME_LIMIT 0.2
+#define ARASTAR_BACKGROUND_TIME 5.0
+#define ARASTAR_SLICE 0.02
+
+// Smoothing of the grid planners' paths, in meters
+#define TURN_RADIUS 1.5
+#define WAYPOINT_SPACING 0.5
+
+// Speed profile, in m/s and m/s^2. The speed drops to the minimum next to the padding and is back to the maximum
+// SLOW_CLEARANCE meters from the closest obstacle.
+#define MAX_DRIVE_SPEED 1.0
+#define MIN_DRIVE_SPEED 0.3
+#define MAX_ACCELERATION 0.5
+#define MAX_LATERAL_ACCELERATION 0.4
+#define SLOW_CLEARANCE 1.5
+
+// How often the inflation statistics are published
+#define DIAGNOSTICS_HZ 1
+
+// If more than this fraction of the map changed, D* Lite plans from scratch instead of repairing its search
+#define MAX_CHANGED_FRACTION 0.25
+
 #define DEBUG_INSTRUMENTATION
 
 #ifdef DEBUG_INSTRUMENTATION
@@ -15,19 +78,318 @@ ros::Publisher debug_oGridPublisher;
 ros::Publisher debug_pathPublisher;
 #endif
 
+std::vector<int> PathServer::padChangedCells(const std::vector<int> &changed, const nav_msgs::OccupancyGrid &paddedGrid, int radius)
+{
+  int width = paddedGrid.info.width;
+  int size = paddedGrid.data.size();
+  std::vector<bool> marked(size, false);
+  std::vector<int> padded;
+
+  // The square around each changed cell covers the circle the CSpace padding can reach
+  for (int cell : changed)
+  {
+    for (int dy = -radius; dy <= radius; ++dy)
+    {
+      for (int dx = -radius; dx <= radius; ++dx)
+      {
+        int index = cell + dy * width + dx;
+        if (index < 0 || index >= size || marked[index])
+          continue;
+
+        marked[index] = true;
+        padded.push_back(index);
+      }
+    }
+  }
+
+  return padded;
+}
+
+PathServer::PathServer(ros::NodeHandle &nh, const std::string &robot_name, ThreadPool &pool, const std::vector<std::unique_ptr<PathServer>> &team)
+    : robot_name_(robot_name), planning_pool_(pool), team_(team)
+{
+  inflation_thread_ = std::thread(&PathServer::inflationLoop, this);
+
+  //ROS Topic names
+  std::string oGrid_topic_ = "/capricorn/" + robot_name + "/object_detection_map";
+  std::string odom_topic_ = "/" + robot_name + "/camera/odom";
+
+  inflated_oGrid_publisher_ = nh.advertise<nav_msgs::OccupancyGrid>("inflated_map", 1, true);
+  diagnostics_publisher_ = nh.advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", 10);
+  diagnostics_timer_ = nh.createWallTimer(ros::WallDuration(1.0 / DIAGNOSTICS_HZ), &PathServer::publishDiagnostics, this);
+
+  // Subscribe last, maps can only be inflated once the publishers exist
+  oGrid_subscriber_ = nh.subscribe(oGrid_topic_, 1000, &PathServer::oGridCallback, this);
+  odom_subscriber_ = nh.subscribe(odom_topic_, 10, &PathServer::locationCallback, this);
+
+  //Instantiating ROS server for generating trajectory
+  trajectory_service_ = nh.advertiseService("trajectoryGenerator", &PathServer::trajectoryGeneration, this);
+  batch_service_ = nh.advertiseService("batchTrajectoryGenerator", &PathServer::batchTrajectoryGeneration, this);
+  cooperative_service_ = nh.advertiseService("cooperativeTrajectoryGenerator", &PathServer::cooperativeTrajectoryGeneration, this);
+}
+
+PathServer::~PathServer()
+{
+  // Stop the callbacks before the state they use goes away
+  oGrid_subscriber_.shutdown();
+  odom_subscriber_.shutdown();
+  diagnostics_timer_.stop();
+  trajectory_service_.shutdown();
+  batch_service_.shutdown();
+  cooperative_service_.shutdown();
+
+  {
+    std::lock_guard<std::mutex> lock(inflation_signal_mutex_);
+    shutdown_ = true;
+  }
+  inflation_signal_.notify_one();
+  inflation_thread_.join();
+}
+
+InflatedMap::ConstPtr PathServer::getInflatedMap(const nav_msgs::OccupancyGrid::ConstPtr &oGrid, bool fromRequest)
+{
+  InflatedMap::ConstPtr cached = boost::atomic_load(&inflated_map_);
+  if (cached && cached->source == oGrid)
+  {
+    if (fromRequest)
+      ++cache_hits_;
+    return cached;
+  }
+
+  if (fromRequest)
+    ++cache_misses_;
+
+  std::lock_guard<std::mutex> lock(inflation_mutex_);
+
+  // Whoever held the lock before us may have just inflated this snapshot
+  cached = boost::atomic_load(&inflated_map_);
+  if (cached && cached->source == oGrid)
+    return cached;
+
+  ros::WallTime start = ros::WallTime::now();
+
+  boost::shared_ptr<InflatedMap> inflated = boost::make_shared<InflatedMap>();
+  inflated->version = ++inflation_count_;
+  inflated->source = oGrid;
+
+  if (cached)
+  {
+    // Start from the last inflated map and only redo the areas that changed since. The cached snapshot is shared,
+    // so the update works on a copy.
+    nav_msgs::OccupancyGridPtr padded = boost::make_shared<nav_msgs::OccupancyGrid>(*cached->padded);
+    inflated->distance_field = cached->distance_field;
+    // Distances are kept exact as far out as the speed profile looks
+    int recomputed = CSpace::updateCSpace(*cached->source, *oGrid, CSPACE_THRESHOLD, CSPACE_RADIUS, *padded, inflated->distance_field,
+                                          ceil(SLOW_CLEARANCE / oGrid->info.resolution));
+    inflated->padded = padded;
+
+    if (recomputed < (int)oGrid->data.size())
+      ++incremental_count_;
+    cells_recomputed_ += recomputed;
+  }
+  else
+  {
+    inflated->padded = boost::make_shared<nav_msgs::OccupancyGrid>(CSpace::getCSpace(*oGrid, CSPACE_THRESHOLD, CSPACE_RADIUS, inflated->distance_field));
+    cells_recomputed_ += oGrid->data.size();
+  }
+
+  // No height map is published yet, so the costmap only has the obstacle and inflation layers
+  nav_msgs::OccupancyGridPtr costmap = boost::make_shared<nav_msgs::OccupancyGrid>(Costmap::obstacleLayer(*inflated->padded, CSPACE_THRESHOLD));
+  Costmap::combine(*costmap, Costmap::inflationLayer(*oGrid, inflated->distance_field, CSPACE_RADIUS, COST_INFLATION_RADIUS / oGrid->info.resolution,
+                                                     INFLATION_COST));
+  inflated->costmap = costmap;
+
+  double inflation_ms = (ros::WallTime::now() - start).toSec() * 1000;
+  last_inflation_ms_ = inflation_ms;
+  total_inflation_ms_ = total_inflation_ms_ + inflation_ms;
+
+  // A request can be working on an older snapshot than the latest one, don't let it replace a newer map
+  if (oGrid == boost::atomic_load(&global_oGrid_))
+  {
+    boost::atomic_store(&inflated_map_, InflatedMap::ConstPtr(inflated));
+    inflated_oGrid_publisher_.publish(inflated->padded);
+
+    #ifdef DEBUG_INSTRUMENTATION
+    debug_oGridPublisher.publish(inflated->padded);
+    #endif
+  }
+
+  return inflated;
+}
+
+void PathServer::inflationLoop()
+{
+  std::unique_lock<std::mutex> lock(inflation_signal_mutex_);
+  while (true)
+  {
+    inflation_signal_.wait(lock, [this]() { return shutdown_ || inflation_pending_; });
+    if (shutdown_)
+      return;
+
+    inflation_pending_ = false;
+    lock.unlock();
+
+    // Only the latest map matters, any maps that arrived while we were busy are skipped
+    nav_msgs::OccupancyGrid::ConstPtr oGrid = boost::atomic_load(&global_oGrid_);
+    if (oGrid)
+    {
+      getInflatedMap(oGrid, false);
+      updateArenaMap(oGrid);
+    }
+
+    lock.lock();
+  }
+}
+
+void PathServer::updateArenaMap(const nav_msgs::OccupancyGrid::ConstPtr &oGrid)
+{
+  geometry_msgs::Pose pose;
+  {
+    std::lock_guard<std::mutex> lock(pose_mutex_);
+    if (!pose_received_)
+      return;
+    pose = robot_pose_;
+  }
+
+  std::lock_guard<std::mutex> lock(hpa_mutex_);
+  hpa_star_.updateGlobalMap(*oGrid, pose);
+}
+
+void PathServer::locationCallback(const nav_msgs::Odometry::ConstPtr &location)
+{
+  std::lock_guard<std::mutex> lock(pose_mutex_);
+  robot_pose_ = location->pose.pose;
+  pose_received_ = true;
+}
+
+void PathServer::publishDiagnostics(const ros::WallTimerEvent &event)
+{
+  InflatedMap::ConstPtr cached = boost::atomic_load(&inflated_map_);
+  uint64_t inflations = inflation_count_;
+
+  diagnostic_msgs::DiagnosticStatus status;
+  status.level = diagnostic_msgs::DiagnosticStatus::OK;
+  status.name = ros::this_node::getName() + ": " + robot_name_ + " map inflation";
+  status.hardware_id = robot_name_;
+  status.message = cached ? "Inflated map ready" : "No map received yet";
+
+  auto addValue = [&status](const std::string &key, const std::string &value) {
+    diagnostic_msgs::KeyValue kv;
+    kv.key = key;
+    kv.value = value;
+    status.values.push_back(kv);
+  };
+
+  addValue("inflated_version", std::to_string(cached ? cached->version : 0));
+  addValue("inflations", std::to_string(inflations));
+  addValue("cache_hits", std::to_string(cache_hits_));
+  addValue("cache_misses", std::to_string(cache_misses_));
+  addValue("last_inflation_ms", std::to_string(last_inflation_ms_));
+  addValue("incremental_inflations", std::to_string(incremental_count_));
+  addValue("mean_cells_recomputed", std::to_string(inflations > 0 ? cells_recomputed_ / inflations : 0));
+  addValue("mean_inflation_ms", std::to_string(inflations > 0 ? total_inflation_ms_ / inflations : 0.0));
+
+  diagnostic_msgs::DiagnosticArray array;
+  array.header.stamp = ros::Time::now();
+  array.status.push_back(status);
+  diagnostics_publisher_.publish(array);
+}
+
 bool PathServer::trajectoryGeneration(planning::trajectory::Request &req, planning::trajectory::Response &res)
 {
+  // The snapshot and the changes that lead up to it are taken together, so D* Lite never misses a change
   std::unique_lock<std::mutex> locationLock(oGrid_mutex_);
-  auto global_oGrid_CPY = global_oGrid_;
+  nav_msgs::OccupancyGrid::ConstPtr oGrid = boost::atomic_load(&global_oGrid_);
+
+  std::vector<int> changed_cells;
+  bool map_replaced = map_replaced_;
+  if (req.planner == planning::trajectory::Request::DSTAR_LITE)
+  {
+    changed_cells.swap(changed_cells_);
+    map_replaced_ = false;
+  }
   locationLock.unlock();
 
-  auto paddedGrid = CSpace::getCSpace(global_oGrid_CPY, 50, 8);
+  if (!oGrid)
+  {
+    ROS_WARN("No occupancy grid received yet.");
+    return true;
+  }
 
-  #ifdef DEBUG_INSTRUMENTATION
-  debug_oGridPublisher.publish(paddedGrid);
-  #endif
+  InflatedMap::ConstPtr inflated = getInflatedMap(oGrid, true);
+  const nav_msgs::OccupancyGrid &paddedGrid = *inflated->padded;
+
+  nav_msgs::Path path;
+  switch (req.planner)
+  {
+  case planning::trajectory::Request::JPS:
+    path = JPS::findPathOccGrid(paddedGrid, req.targetPose.pose.position);
+    break;
+  case planning::trajectory::Request::LAZY_THETA_STAR:
+    path = ThetaStar::findPathOccGrid(paddedGrid, req.targetPose.pose.position);
+    break;
+  case planning::trajectory::Request::HYBRID_ASTAR:
+    path = HybridAStar::findPathOccGrid(paddedGrid, req.targetPose.pose);
+    break;
+  case planning::trajectory::Request::ARASTAR:
+    path = anytimePath(inflated, req.targetPose.pose.position, req.timeLimit > 0 ? req.timeLimit : ARASTAR_TIME_LIMIT);
+    break;
+  case planning::trajectory::Request::BIDIRECTIONAL_ASTAR:
+    path = BidirectionalAStar::findPathOccGrid(paddedGrid, req.targetPose.pose.position);
+    break;
+  case planning::trajectory::Request::TERRAIN_ASTAR:
+    path = TerrainAStar::findPathOccGrid(*inflated->costmap, req.targetPose.pose.position, TERRAIN_COST_WEIGHT);
+    break;
+  case planning::trajectory::Request::DSTAR_LITE:
+  {
+    std::lock_guard<std::mutex> lock(dstar_mutex_);
+    if (map_replaced)
+      dstar_lite_.reset();
+    path = dstar_lite_.findPathOccGrid(paddedGrid, req.targetPose.pose.position, padChangedCells(changed_cells, paddedGrid, CSPACE_RADIUS + 1));
+    break;
+  }
+  case planning::trajectory::Request::HPASTAR:
+  {
+    geometry_msgs::Pose pose;
+    bool pose_received;
+    {
+      std::lock_guard<std::mutex> lock(pose_mutex_);
+      pose = robot_pose_;
+      pose_received = pose_received_;
+    }
 
-  auto path = AStar::findPathOccGrid(paddedGrid, req.targetPose.pose.position);
+    if (pose_received)
+    {
+      std::lock_guard<std::mutex> lock(hpa_mutex_);
+      path = hpa_star_.findPathOccGrid(paddedGrid, req.targetPose.pose.position, pose);
+      break;
+    }
+
+    ROS_WARN("No odometry received yet, planning on the local map only.");
+    path = AStar::findPathOccGrid(paddedGrid, req.targetPose.pose.position);
+    break;
+  }
+  case planning::trajectory::Request::ASTAR:
+  default:
+    path = AStar::findPathOccGrid(paddedGrid, req.targetPose.pose.position);
+    break;
+  }
+
+  // Hybrid A* paths can already be driven as they are and may reverse, and HPA* paths leave the local map where
+  // their corners can't be checked, so those only get speeds. Shortcuts only look at obstacles, so they would undo the
+  // detours TERRAIN_ASTAR takes around costly ground. Rounded corners and evenly spaced waypoints only help a caller
+  // that follows the path continuously, one that stops at every waypoint is better off with just the corners.
+  if (req.planner == planning::trajectory::Request::TERRAIN_ASTAR)
+  {
+    if (req.continuous)
+      path = PathSmoother::smooth(path, paddedGrid, TURN_RADIUS, WAYPOINT_SPACING, CSPACE_THRESHOLD);
+  }
+  else if (req.planner != planning::trajectory::Request::HYBRID_ASTAR && req.planner != planning::trajectory::Request::HPASTAR)
+  {
+    path = PathSmoother::shortcut(path, paddedGrid, CSPACE_THRESHOLD);
+    if (req.continuous)
+      path = PathSmoother::smooth(path, paddedGrid, TURN_RADIUS, WAYPOINT_SPACING, CSPACE_THRESHOLD);
+  }
 
   #ifdef DEBUG_INSTRUMENTATION
   debug_pathPublisher.publish(path);
@@ -38,6 +400,21 @@ bool PathServer::trajectoryGeneration(planning::trajectory::Request &req, planni
 
     trajectory.waypoints = path.poses;
 
+    PathSmoother::Limits limits;
+    limits.max_speed = MAX_DRIVE_SPEED;
+    limits.min_speed = MIN_DRIVE_SPEED;
+    limits.max_acceleration = MAX_ACCELERATION;
+    limits.max_lateral_acceleration = MAX_LATERAL_ACCELERATION;
+    limits.min_clearance = CSPACE_RADIUS * paddedGrid.info.resolution;
+    limits.slow_clearance = SLOW_CLEARANCE;
+
+    for (double speed : PathSmoother::velocityProfile(path, paddedGrid, inflated->distance_field, limits))
+    {
+      std_msgs::Float64 velocity;
+      velocity.data = speed;
+      trajectory.velocities.push_back(velocity);
+    }
+
     res.trajectory = trajectory;
   } else {
     ROS_WARN("No Poses Set.");
@@ -46,10 +423,215 @@ bool PathServer::trajectoryGeneration(planning::trajectory::Request &req, planni
   return true;
 }
 
-void PathServer::oGridCallback(nav_msgs::OccupancyGrid oGrid)
+nav_msgs::Path PathServer::anytimePath(const InflatedMap::ConstPtr &inflated, const geometry_msgs::Point &target, double timeLimit)
+{
+  ros::WallTime deadline = ros::WallTime::now() + ros::WallDuration(timeLimit);
+  std::lock_guard<std::mutex> lock(ara_mutex_);
+
+  // A follow up for the same target on the same map carries on from whatever the background search got to
+  bool newSearch = ara_map_ != inflated || ara_star_.target().x != target.x || ara_star_.target().y != target.y;
+  if (newSearch)
+  {
+    ara_star_.start(*inflated->padded, target, ARASTAR_EPSILON, ARASTAR_EPSILON_STEP, CSPACE_THRESHOLD);
+    ara_map_ = inflated;
+    ++ara_search_;
+  }
+
+  if (!ara_star_.improve(*inflated->padded, deadline) && newSearch)
+  {
+    uint64_t search = ara_search_;
+    ros::WallTime until = ros::WallTime::now() + ros::WallDuration(ARASTAR_BACKGROUND_TIME);
+    planning_pool_.submit([this, search, until]() { improveInBackground(search, until); });
+  }
+
+  if (ara_star_.path().poses.empty() && !ara_star_.done())
+    ROS_WARN("No path within the time limit yet, still searching.");
+
+  return ara_star_.path();
+}
+
+void PathServer::improveInBackground(uint64_t search, const ros::WallTime &until)
+{
+  std::lock_guard<std::mutex> lock(ara_mutex_);
+  if (search != ara_search_ || ara_star_.done() || until < ros::WallTime::now())
+    return;
+
+  if (!ara_star_.improve(*ara_map_->padded, ros::WallTime::now() + ros::WallDuration(ARASTAR_SLICE)))
+    planning_pool_.submit([this, search, until]() { improveInBackground(search, until); });
+}
+
+nav_msgs::OccupancyGrid PathServer::paddedArenaMap()
+{
+  nav_msgs::OccupancyGrid arena;
+  {
+    std::lock_guard<std::mutex> lock(hpa_mutex_);
+    arena = hpa_star_.globalMap();
+  }
+  return CSpace::getCSpace(arena, CSPACE_THRESHOLD, ARENA_CSPACE_RADIUS);
+}
+
+nav_msgs::OccupancyGrid PathServer::paddedTeamArenaMap()
+{
+  nav_msgs::OccupancyGrid team;
+  {
+    std::lock_guard<std::mutex> lock(hpa_mutex_);
+    team = hpa_star_.globalMap();
+  }
+
+  for (const std::unique_ptr<PathServer> &server : team_)
+  {
+    if (server.get() == this)
+      continue;
+
+    std::lock_guard<std::mutex> lock(server->hpa_mutex_);
+    const nav_msgs::OccupancyGrid &arena = server->hpa_star_.globalMap();
+    if (arena.data.empty())
+      continue;
+
+    if (team.data.empty())
+    {
+      team = arena;
+      continue;
+    }
+
+    if (arena.info.width != team.info.width || arena.info.height != team.info.height || arena.info.resolution != team.info.resolution ||
+        arena.info.origin.position.x != team.info.origin.position.x || arena.info.origin.position.y != team.info.origin.position.y)
+    {
+      ROS_WARN_STREAM("The arena map of " << server->robot_name_ << " doesn't line up with the others, leaving it out.");
+      continue;
+    }
+
+    // Unknown cells are -1, so any robot that saw a cell wins over the ones that didn't
+    for (int i = 0; i < (int)team.data.size(); ++i)
+      team.data[i] = std::max(team.data[i], arena.data[i]);
+  }
+
+  return CSpace::getCSpace(team, CSPACE_THRESHOLD, ARENA_CSPACE_RADIUS);
+}
+
+int PathServer::arenaIndex(const nav_msgs::OccupancyGrid &arena, const geometry_msgs::PoseStamped &pose)
+{
+  int x = floor((pose.pose.position.x - arena.info.origin.position.x) / arena.info.resolution);
+  int y = floor((pose.pose.position.y - arena.info.origin.position.y) / arena.info.resolution);
+  return (x < 0 || y < 0 || x >= (int)arena.info.width || y >= (int)arena.info.height) ? -1 : y * arena.info.width + x;
+}
+
+nav_msgs::Path PathServer::arenaPath(const std::vector<int> &cells, const nav_msgs::OccupancyGrid &arena, double stepTime)
+{
+  int width = arena.info.width;
+  double resolution = arena.info.resolution;
+  const geometry_msgs::Point &origin = arena.info.origin.position;
+
+  nav_msgs::Path path;
+  path.header.stamp = ros::Time::now();
+  path.header.frame_id = "odom";
+
+  // Goal first and start last, without the points in between that lie on a straight line
+  for (int i = cells.size() - 1; i >= 0; --i)
+  {
+    if (i > 0 && i < (int)cells.size() - 1)
+    {
+      int dx1 = cells[i + 1] % width - cells[i] % width, dy1 = cells[i + 1] / width - cells[i] / width;
+      int dx2 = cells[i] % width - cells[i - 1] % width, dy2 = cells[i] / width - cells[i - 1] / width;
+      if (dx1 == dx2 && dy1 == dy2)
+        continue;
+    }
+
+    geometry_msgs::PoseStamped pose;
+    pose.header = path.header;
+    pose.header.stamp += ros::Duration(i * stepTime);
+    pose.pose.position.x = origin.x + (cells[i] % width + 0.5) * resolution;
+    pose.pose.position.y = origin.y + (cells[i] / width + 0.5) * resolution;
+    pose.pose.orientation.w = 1;
+    path.poses.push_back(pose);
+  }
+
+  return path;
+}
+
+bool PathServer::batchTrajectoryGeneration(planning::batch_trajectory::Request &req, planning::batch_trajectory::Response &res)
+{
+  nav_msgs::OccupancyGrid paddedArena = paddedArenaMap();
+
+  std::vector<int> starts, goals;
+  for (const geometry_msgs::PoseStamped &pose : req.starts)
+    starts.push_back(arenaIndex(paddedArena, pose));
+  for (const geometry_msgs::PoseStamped &pose : req.goals)
+    goals.push_back(arenaIndex(paddedArena, pose));
+
+  std::vector<std::vector<int>> paths;
+  std::vector<double> costs = MultiGoal::costMatrix(paddedArena, starts, goals, req.return_paths ? &paths : nullptr, CSPACE_THRESHOLD);
+
+  for (double cost : costs)
+    res.costs.push_back(cost == INFINITY ? -1 : cost * paddedArena.info.resolution);
+
+  for (const std::vector<int> &cells : paths)
+    res.paths.push_back(arenaPath(cells, paddedArena));
+
+  return true;
+}
+
+bool PathServer::cooperativeTrajectoryGeneration(planning::cooperative_trajectory::Request &req, planning::cooperative_trajectory::Response &res)
+{
+  // The robots share the arena, so they are planned on what all of them have seen
+  nav_msgs::OccupancyGrid paddedArena = paddedTeamArenaMap();
+
+  std::vector<int> starts, goals;
+  for (const geometry_msgs::PoseStamped &pose : req.starts)
+    starts.push_back(arenaIndex(paddedArena, pose));
+  for (const geometry_msgs::PoseStamped &pose : req.goals)
+    goals.push_back(arenaIndex(paddedArena, pose));
+
+  if (starts.size() != goals.size())
+  {
+    ROS_WARN("Cooperative planning needs one goal per robot.");
+    return false;
+  }
+
+  std::vector<std::vector<int>> paths = CooperativePlanner::planPaths(paddedArena, starts, goals, planning_pool_, COOPERATIVE_SEPARATION,
+                                                                      COOPERATIVE_WINDOW, CSPACE_THRESHOLD);
+
+  double stepTime = paddedArena.info.resolution / ROBOT_SPEED;
+  for (const std::vector<int> &cells : paths)
+    res.paths.push_back(arenaPath(cells, paddedArena, stepTime));
+
+  return true;
+}
+
+void PathServer::oGridCallback(const nav_msgs::OccupancyGrid::ConstPtr &oGrid)
 {
   std::lock_guard<std::mutex> lock(oGrid_mutex_);
-  global_oGrid_ = oGrid;
+  nav_msgs::OccupancyGrid::ConstPtr previous = boost::atomic_exchange(&global_oGrid_, oGrid);
+
+  // Keep track of what changed for D* Lite, unless the map changed shape or most of it changed anyway
+  if (!map_replaced_)
+  {
+    if (!previous || oGrid->data.size() != previous->data.size() || oGrid->info.width != previous->info.width)
+    {
+      map_replaced_ = true;
+    }
+    else
+    {
+      for (int i = 0; i < oGrid->data.size(); ++i)
+      {
+        if (oGrid->data[i] != previous->data[i])
+          changed_cells_.push_back(i);
+      }
+
+      if (changed_cells_.size() > MAX_CHANGED_FRACTION * oGrid->data.size())
+        map_replaced_ = true;
+    }
+
+    if (map_replaced_)
+      changed_cells_.clear();
+  }
+
+  // Wake up the inflation stage
+  {
+    std::lock_guard<std::mutex> signal_lock(inflation_signal_mutex_);
+    inflation_pending_ = true;
+  }
+  inflation_signal_.notify_one();
 }
 
 int main(int argc, char *argv[])
@@ -57,27 +639,35 @@ int main(int argc, char *argv[])
   //initialize node
   ros::init(argc, argv, "path_planner_server");
 
-  std::string robot_name(argv[1]);
-
-  //ROS Topic names
-  std::string oGrid_topic_ = "/capricorn/small_scout_1/object_detection_map";
+  if (argc < 2)
+  {
+    ROS_ERROR("Usage: path_planner_server <robot_name> [<robot_name> ...]");
+    return 1;
+  }
 
   //create a nodehandle
   ros::NodeHandle nh;
 
-  PathServer server;
-
-  server.oGrid_subscriber = nh.subscribe(oGrid_topic_, 1000, &PathServer::oGridCallback, &server);
-
   #ifdef DEBUG_INSTRUMENTATION
   debug_oGridPublisher = nh.advertise<nav_msgs::OccupancyGrid>("/galaga/debug_oGrid", 1000);
   debug_pathPublisher = nh.advertise<nav_msgs::Path>("/galaga/debug_path", 1000);
   #endif
 
-  //Instantiating ROS server for generating trajectory
-  ros::ServiceServer service = nh.advertiseService("trajectoryGenerator", &PathServer::trajectoryGeneration, &server);
+  // One planner per robot, all sharing the workers. Each robot's services live in its own namespace, as if it had a
+  // node of its own.
+  // The pool is destroyed first, so the work it still has queued runs while the servers are alive
+  std::vector<std::unique_ptr<PathServer>> servers;
+  ThreadPool pool;
+  for (int i = 1; i < argc; ++i)
+  {
+    ros::NodeHandle robot_nh("/capricorn/" + std::string(argv[i]));
+    servers.emplace_back(new PathServer(robot_nh, argv[i], pool, servers));
+  }
 
-  ros::spin();
+  // Requests are served in parallel, requests for the same robot only wait on each other where they share a planner
+  ros::AsyncSpinner spinner(SPINNER_THREADS);
+  spinner.start();
+  ros::waitForShutdown();
 
   return 0;
 }
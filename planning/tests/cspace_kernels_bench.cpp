@@ -0,0 +1,82 @@
+#include <cspace_kernels.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Microbenchmark for the CSpace kernels.
+//
+// Usage: rosrun planning cspace_kernels_bench
+//
+// Runs every kernel with each instruction set the CPU supports on 200x200, 400x400 and 1000x1000 grids
+// and prints the time per full grid pass.
+
+// Number of full grid passes timed per kernel
+#define REPETITIONS 200
+
+// Radius used for the padding and the dilation, same as the path planner server
+#define RADIUS 8
+
+template <typename F>
+double timeMicroseconds(F kernel)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < REPETITIONS; ++i)
+    kernel();
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / REPETITIONS;
+}
+
+int main(int argc, char **argv)
+{
+  std::mt19937 rng(0);
+
+  printf("%-10s %-8s %12s %12s %12s\n", "grid", "isa", "mask (us)", "pad (us)", "dilate (us)");
+  for (int side : {200, 400, 1000})
+  {
+    int n = side * side;
+
+    // Mostly free space with a few obstacles and unknown cells, like object_detection_map
+    std::vector<int8_t> grid(n);
+    std::vector<float> distance(n);
+    for (int i = 0; i < n; ++i)
+    {
+      int roll = rng() % 100;
+      grid[i] = roll < 3 ? 100 : (roll < 10 ? -1 : 0);
+      distance[i] = (rng() % 400) / 10.0f;
+    }
+
+    std::vector<uint8_t> mask(n);
+    std::vector<int8_t> out(n), rows(n);
+
+    for (CSpaceKernels::Isa isa : {CSpaceKernels::SCALAR, CSpaceKernels::SSE41, CSpaceKernels::AVX2})
+    {
+      const CSpaceKernels::Table &kernels = CSpaceKernels::get(isa);
+
+      // Skip instruction sets the CPU doesn't have, get() would have fallen back to another one
+      if (kernels.isa != isa)
+        continue;
+
+      double mask_us = timeMicroseconds([&]() { kernels.obstacleMask(grid.data(), mask.data(), n, 50); });
+      double pad_us = timeMicroseconds([&]() { kernels.padFromDistance(grid.data(), distance.data(), out.data(), n, 50, RADIUS); });
+      double dilate_us = timeMicroseconds([&]() {
+        for (int y = 0; y < side; ++y)
+          kernels.maxFilterRow(&grid[y * side], &rows[y * side], side, RADIUS);
+        for (int y = RADIUS; y < side - RADIUS; ++y)
+        {
+          int8_t *dst = &out[y * side];
+          kernels.maxRows(&rows[(y - RADIUS) * side], &rows[(y - RADIUS + 1) * side], dst, side);
+          for (int k = y - RADIUS + 2; k <= y + RADIUS; ++k)
+            kernels.maxRows(dst, &rows[k * side], dst, side);
+        }
+      });
+
+      char label[32];
+      snprintf(label, sizeof(label), "%dx%d", side, side);
+      printf("%-10s %-8s %12.1f %12.1f %12.1f\n", label, CSpaceKernels::name(isa), mask_us, pad_us, dilate_us);
+    }
+  }
+
+  return 0;
+}
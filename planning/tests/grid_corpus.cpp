@@ -0,0 +1,112 @@
+#include "grid_corpus.h"
+
+#include <ros/serialization.h>
+
+#include <algorithm>
+#include <dirent.h>
+#include <fstream>
+#include <random>
+
+using nav_msgs::OccupancyGrid;
+
+const std::string GridCorpus::EXTENSION = ".grid";
+
+OccupancyGrid GridCorpus::makeCraterField(int width, int height, int craters, unsigned int seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> x_dist(0, width - 1), y_dist(0, height - 1), r_dist(2, 12);
+
+  OccupancyGrid grid;
+  grid.info.width = width;
+  grid.info.height = height;
+  grid.info.resolution = 0.05;
+  grid.header.frame_id = "odom";
+  grid.data.assign(width * height, 0);
+
+  for (int c = 0; c < craters; ++c)
+  {
+    int cx = x_dist(rng), cy = y_dist(rng), r = r_dist(rng);
+    for (int y = std::max(0, cy - r); y < std::min(height, cy + r + 1); ++y)
+      for (int x = std::max(0, cx - r); x < std::min(width, cx + r + 1); ++x)
+        if ((x - cx) * (x - cx) + (y - cy) * (y - cy) <= r * r)
+          grid.data[y * width + x] = 100;
+  }
+
+  // Keep the robot's own cell free, like the real maps
+  for (int y = height / 2 - 3; y <= height / 2 + 3; ++y)
+    for (int x = width / 2 - 3; x <= width / 2 + 3; ++x)
+      grid.data[y * width + x] = 0;
+
+  return grid;
+}
+
+bool GridCorpus::save(const std::string &file, const OccupancyGrid &grid)
+{
+  uint32_t length = ros::serialization::serializationLength(grid);
+  std::vector<uint8_t> buffer(length);
+  ros::serialization::OStream stream(buffer.data(), length);
+  ros::serialization::serialize(stream, grid);
+
+  std::ofstream out(file, std::ios::binary);
+  out.write((const char *)buffer.data(), length);
+  return out.good();
+}
+
+bool GridCorpus::load(const std::string &file, OccupancyGrid &grid)
+{
+  std::ifstream in(file, std::ios::binary);
+  std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  if (!in.eof() && !in.good())
+    return false;
+
+  try
+  {
+    ros::serialization::IStream stream(buffer.data(), buffer.size());
+    ros::serialization::deserialize(stream, grid);
+  }
+  catch (const std::exception &e)
+  {
+    // Truncated or not a grid at all
+    return false;
+  }
+
+  return grid.data.size() == grid.info.width * grid.info.height;
+}
+
+std::vector<std::pair<std::string, OccupancyGrid>> GridCorpus::loadDirectory(const std::string &directory)
+{
+  std::vector<std::string> names;
+  DIR *dir = opendir(directory.c_str());
+  if (dir == nullptr)
+    return {};
+
+  while (dirent *entry = readdir(dir))
+  {
+    std::string name = entry->d_name;
+    if (name.size() > EXTENSION.size() && name.compare(name.size() - EXTENSION.size(), EXTENSION.size(), EXTENSION) == 0)
+      names.push_back(name);
+  }
+  closedir(dir);
+  std::sort(names.begin(), names.end());
+
+  std::vector<std::pair<std::string, OccupancyGrid>> grids;
+  for (const std::string &name : names)
+  {
+    OccupancyGrid grid;
+    if (load(directory + "/" + name, grid) && grid.data.size() > 0)
+      grids.emplace_back(name.substr(0, name.size() - EXTENSION.size()), grid);
+    else
+      fprintf(stderr, "Skipping %s, not a valid grid file\n", name.c_str());
+  }
+
+  return grids;
+}
+
+std::vector<std::pair<std::string, OccupancyGrid>> GridCorpus::generated()
+{
+  return {
+      {"craters_200_sparse", makeCraterField(200, 200, 60, 1)},
+      {"craters_400_sparse", makeCraterField(400, 400, 250, 2)},
+      {"craters_400_dense", makeCraterField(400, 400, 600, 3)},
+  };
+}
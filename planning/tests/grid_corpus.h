@@ -0,0 +1,60 @@
+#pragma once
+
+#include <nav_msgs/OccupancyGrid.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Set of occupancy grids for the offline benchmarks, stored as one serialized nav_msgs/OccupancyGrid per file.
+ *
+ * The files use the ROS message serialization, so they can be read without a ROS master or rosbag. make_grid_corpus
+ * writes them, from generated crater fields and from the grids recorded in rosbags.
+ */
+class GridCorpus
+{
+public:
+  // Extension of the grid files in a corpus directory
+  static const std::string EXTENSION;
+
+  /**
+   * @brief Generates a lunar looking grid, round craters of random size dropped at random, the robot's cell kept free
+   *
+   * @param width Width of the grid in cells
+   * @param height Height of the grid in cells
+   * @param craters Number of craters
+   * @param seed Random seed, the same seed always gives the same grid
+   * @return The generated grid, at the resolution of the real maps
+   */
+  static nav_msgs::OccupancyGrid makeCraterField(int width, int height, int craters, unsigned int seed);
+
+  /**
+   * @brief Writes a grid to a file
+   *
+   * @return Whether the file could be written
+   */
+  static bool save(const std::string &file, const nav_msgs::OccupancyGrid &grid);
+
+  /**
+   * @brief Reads a grid written by save
+   *
+   * @return Whether the file could be read
+   */
+  static bool load(const std::string &file, nav_msgs::OccupancyGrid &grid);
+
+  /**
+   * @brief Reads every grid file in a directory, sorted by file name
+   *
+   * @param directory The corpus directory
+   * @return The name (file name without the extension) and contents of each grid
+   */
+  static std::vector<std::pair<std::string, nav_msgs::OccupancyGrid>> loadDirectory(const std::string &directory);
+
+  /**
+   * @brief The generated crater fields used when no corpus is given, from sparse to dense
+   *
+   * @return The name and contents of each grid
+   */
+  static std::vector<std::pair<std::string, nav_msgs::OccupancyGrid>> generated();
+};
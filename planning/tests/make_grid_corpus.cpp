@@ -0,0 +1,69 @@
+#include <ros/ros.h>
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+
+#include "grid_corpus.h"
+
+#include <cstring>
+#include <sys/stat.h>
+
+// Builds a grid corpus for planning_bench.
+//
+// Usage: rosrun planning make_grid_corpus <output directory> [--every N] [bag files...]
+//
+// Writes the generated crater fields, then every Nth nav_msgs/OccupancyGrid found in the given bags (e.g. a recording
+// of object_detection_map), default every 10th. Grids from a bag are named after the bag and their position in it.
+
+using nav_msgs::OccupancyGrid;
+
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    printf("Usage: make_grid_corpus <output directory> [--every N] [bag files...]\n");
+    return 1;
+  }
+
+  ros::Time::init();
+
+  std::string directory = argv[1];
+  mkdir(directory.c_str(), 0755);
+
+  int written = 0;
+  for (const auto &grid : GridCorpus::generated())
+    written += GridCorpus::save(directory + "/" + grid.first + GridCorpus::EXTENSION, grid.second);
+
+  int every = 10;
+  for (int i = 2; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "--every") == 0 && i + 1 < argc)
+    {
+      every = std::max(1, atoi(argv[++i]));
+      continue;
+    }
+
+    std::string bagName = argv[i];
+    bagName = bagName.substr(bagName.find_last_of('/') + 1);
+    bagName = bagName.substr(0, bagName.find_last_of('.'));
+
+    rosbag::Bag bag;
+    bag.open(argv[i], rosbag::bagmode::Read);
+    rosbag::View view(bag);
+
+    int index = 0;
+    for (const rosbag::MessageInstance &m : view)
+    {
+      nav_msgs::OccupancyGrid::ConstPtr grid = m.instantiate<nav_msgs::OccupancyGrid>();
+      if (grid == nullptr || grid->data.size() == 0 || index++ % every != 0)
+        continue;
+
+      char name[32];
+      snprintf(name, sizeof(name), "_%05d", index - 1);
+      written += GridCorpus::save(directory + "/" + bagName + name + GridCorpus::EXTENSION, *grid);
+    }
+    bag.close();
+  }
+
+  printf("Wrote %d grids to %s\n", written, directory.c_str());
+  return 0;
+}
@@ -0,0 +1,343 @@
+#include <ros/ros.h>
+#include <benchmark/benchmark.h>
+#include <astar.h>
+#include <jps.h>
+#include <theta_star.h>
+#include <hybrid_astar.h>
+#include <dstar_lite.h>
+#include <bidirectional_astar.h>
+#include <cspace.h>
+
+#include "grid_corpus.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <set>
+#include <unordered_map>
+
+// Benchmarks for the planners and the CSpace, on recorded or generated occupancy grids. No ROS master needed.
+//
+// Usage: rosrun planning planning_bench [--corpus=<directory>] [Google Benchmark flags...]
+//
+// Every grid in the corpus directory (written by make_grid_corpus) gets its own set of cases, or a few generated crater
+// fields if no corpus is given. The planner cases plan to a fixed set of free targets, one per iteration. On top of
+// the usual timings every case reports:
+//   expansions/s (or cells/s)  search nodes expanded (or grid cells processed) per second
+//   p50_us, p90_us, p99_us      latency percentiles of a single call
+//   allocs/call                 heap allocations per call, counted by the operator new below
+// Use e.g. --benchmark_filter=AStar or --benchmark_format=json to pick cases or compare runs.
+
+using geometry_msgs::Point;
+using nav_msgs::OccupancyGrid;
+
+// Number of targets planned to on each grid
+#define TARGETS_PER_GRID 20
+
+// Same as the path planner server
+#define CSPACE_THRESHOLD 50
+#define CSPACE_RADIUS 8
+
+// Every heap allocation in the process goes through here
+static std::atomic<long> g_allocations{0};
+
+void *operator new(size_t size)
+{
+  ++g_allocations;
+  if (void *p = malloc(size))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+  free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+  free(p);
+}
+
+namespace legacy
+{
+  // The original open list implementation, kept as a reference point for the benchmark.
+  // Only the search itself is reproduced, path reconstruction is left out since it is the same in both versions.
+  int distanceSq(int ind1, int ind2, int width)
+  {
+    int dx = ind1 % width - ind2 % width;
+    int dy = ind1 / width - ind2 / width;
+    return dx * dx + dy * dy;
+  }
+
+  bool collinear(int pt1, int pt2, int pt3, int width)
+  {
+    return (pt2 / width - pt1 / width) * (pt3 % width - pt2 % width) == (pt3 / width - pt2 / width) * (pt2 % width - pt1 % width);
+  }
+
+  // Returns the number of nodes expanded
+  int findPathOccGrid(const OccupancyGrid &oGrid, int endIndex, int threshold = 50)
+  {
+    int width = oGrid.info.width;
+    int size = oGrid.data.size();
+    int centerIndex = (oGrid.info.height / 2) * width + width / 2;
+
+    std::vector<double> gScores(size, INFINITY);
+    std::set<std::pair<double, int>> open_set;
+    open_set.insert(std::make_pair(0.0, centerIndex));
+
+    std::unordered_map<int, int> came_from;
+    came_from[centerIndex] = -1;
+    gScores[centerIndex] = 0;
+
+    int expansions = 0;
+    while (!open_set.empty())
+    {
+      auto current = *open_set.begin();
+      open_set.erase(open_set.begin());
+      ++expansions;
+
+      if (current.second == endIndex)
+        return expansions;
+
+      if (oGrid.data[current.second] >= threshold)
+        continue;
+
+      int pt = current.second;
+      for (int neighbor : {pt + 1, pt - 1, pt + width, pt + width + 1, pt + width - 1, pt - width, pt - width + 1, pt - width - 1})
+      {
+        if (neighbor < 0 || neighbor >= size)
+          continue;
+
+        double tentative_gscore = gScores[pt] + sqrt(distanceSq(pt, neighbor, width));
+        if (collinear(neighbor, pt, came_from[pt], width)) tentative_gscore -= .95;
+        if (tentative_gscore < gScores[neighbor])
+        {
+          gScores[neighbor] = tentative_gscore;
+          came_from[neighbor] = pt;
+          open_set.insert(std::make_pair(tentative_gscore + sqrt(distanceSq(neighbor, endIndex, width)), neighbor));
+        }
+      }
+    }
+
+    return expansions;
+  }
+}
+
+
+struct GridCase
+{
+  std::string name;
+  OccupancyGrid grid;
+
+  // Free cells relative to the center of the grid, the same for every planner
+  std::vector<Point> targets;
+};
+
+std::vector<Point> pickTargets(const OccupancyGrid &grid, unsigned int seed)
+{
+  int width = grid.info.width, height = grid.info.height;
+  std::mt19937 rng(seed);
+  std::vector<Point> targets;
+  for (int tries = 0; targets.size() < TARGETS_PER_GRID && tries < 100 * TARGETS_PER_GRID; ++tries)
+  {
+    Point p;
+    p.x = (int)(rng() % width) - width / 2;
+    p.y = (int)(rng() % height) - height / 2;
+    int index = (p.y + height / 2) * width + (p.x + width / 2);
+    if (grid.data[index] >= 0 && grid.data[index] < CSPACE_THRESHOLD)
+      targets.push_back(p);
+  }
+  return targets;
+}
+
+/**
+ * @brief Times op once per iteration and sets the latency percentiles, throughput and allocation counters
+ *
+ * @param op Runs one call, gets the iteration number and returns the work done (expansions or cells)
+ * @param workName Name of the throughput counter
+ */
+template <typename Op>
+void measure(benchmark::State &state, Op op, const char *workName)
+{
+  std::vector<double> latencies;
+  latencies.reserve(state.max_iterations);
+
+  long work = 0;
+  long iteration = 0;
+  long allocations = g_allocations;
+  for (auto _ : state)
+  {
+    auto start = std::chrono::steady_clock::now();
+    work += op(iteration++);
+    latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+  }
+  allocations = g_allocations - allocations;
+
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&latencies](double q) { return latencies.empty() ? 0.0 : latencies[(size_t)(q * (latencies.size() - 1))]; };
+
+  state.counters[workName] = benchmark::Counter(work, benchmark::Counter::kIsRate);
+  state.counters["p50_us"] = percentile(0.5);
+  state.counters["p90_us"] = percentile(0.9);
+  state.counters["p99_us"] = percentile(0.99);
+  state.counters["allocs/call"] = benchmark::Counter(allocations, benchmark::Counter::kAvgIterations);
+}
+
+void registerCases(const std::shared_ptr<const GridCase> &c)
+{
+  auto add = [&c](const char *planner, void (*fn)(benchmark::State &, const GridCase &)) {
+    benchmark::RegisterBenchmark((std::string(planner) + "/" + c->name).c_str(), [c, fn](benchmark::State &state) { fn(state, *c); })
+        ->Unit(benchmark::kMicrosecond);
+  };
+
+  add("LegacyAStar", [](benchmark::State &state, const GridCase &c) {
+    int width = c.grid.info.width, height = c.grid.info.height;
+    measure(state, [&](long i) {
+      const Point &p = c.targets[i % c.targets.size()];
+      return legacy::findPathOccGrid(c.grid, (p.y + height / 2) * width + (p.x + width / 2));
+    }, "expansions/s");
+  });
+
+  add("AStar", [](benchmark::State &state, const GridCase &c) {
+    SearchSpace space;
+    measure(state, [&](long i) {
+      AStar::findPathOccGrid(c.grid, c.targets[i % c.targets.size()], space);
+      return space.expansions();
+    }, "expansions/s");
+  });
+
+  add("BidirectionalAStar", [](benchmark::State &state, const GridCase &c) {
+    SearchSpace forward, backward;
+    measure(state, [&](long i) {
+      BidirectionalAStar::findPathOccGrid(c.grid, c.targets[i % c.targets.size()], forward, backward);
+      return forward.expansions() + backward.expansions();
+    }, "expansions/s");
+  });
+
+  add("JPS", [](benchmark::State &state, const GridCase &c) {
+    SearchSpace space;
+    measure(state, [&](long i) {
+      JPS::findPathOccGrid(c.grid, c.targets[i % c.targets.size()], space);
+      return space.expansions();
+    }, "expansions/s");
+  });
+
+  add("LazyThetaStar", [](benchmark::State &state, const GridCase &c) {
+    SearchSpace space;
+    measure(state, [&](long i) {
+      ThetaStar::findPathOccGrid(c.grid, c.targets[i % c.targets.size()], space);
+      return space.expansions();
+    }, "expansions/s");
+  });
+
+  add("HybridAStar", [](benchmark::State &state, const GridCase &c) {
+    SearchSpace space;
+    measure(state, [&](long i) {
+      geometry_msgs::Pose target;
+      target.position = c.targets[i % c.targets.size()];
+      HybridAStar::findPathOccGrid(c.grid, target, space);
+      return space.expansions();
+    }, "expansions/s");
+  });
+
+  // Replanning to the same target while a few cells keep appearing and disappearing
+  add("DStarLiteReplan", [](benchmark::State &state, const GridCase &c) {
+    OccupancyGrid changed = c.grid;
+    std::vector<int> cells;
+    std::mt19937 rng(7);
+    while (cells.size() < 20)
+    {
+      int cell = rng() % changed.data.size();
+      if (changed.data[cell] == 0 && abs((int)(cell % changed.info.width) - (int)changed.info.width / 2) > 5)
+      {
+        changed.data[cell] = 100;
+        cells.push_back(cell);
+      }
+    }
+
+    DStarLite dstar;
+    dstar.findPathOccGrid(c.grid, c.targets[0], {});
+    measure(state, [&](long i) {
+      dstar.findPathOccGrid(i % 2 == 0 ? changed : c.grid, c.targets[0], cells);
+      return dstar.expansions();
+    }, "expansions/s");
+  });
+
+  add("CSpace", [](benchmark::State &state, const GridCase &c) {
+    std::vector<float> field;
+    measure(state, [&](long) {
+      benchmark::DoNotOptimize(CSpace::getCSpace(c.grid, CSPACE_THRESHOLD, CSPACE_RADIUS, field));
+      return (long)c.grid.data.size();
+    }, "cells/s");
+  });
+
+  // A handful of new obstacles per map, the common case for the object detection map
+  add("CSpaceUpdate", [](benchmark::State &state, const GridCase &c) {
+    OccupancyGrid changed = c.grid;
+    std::mt19937 rng(11);
+    for (int i = 0; i < 5; ++i)
+      changed.data[rng() % changed.data.size()] = 100;
+
+    std::vector<float> field;
+    OccupancyGrid cspace = CSpace::getCSpace(c.grid, CSPACE_THRESHOLD, CSPACE_RADIUS, field);
+    measure(state, [&](long i) {
+      const OccupancyGrid &from = i % 2 == 0 ? c.grid : changed;
+      const OccupancyGrid &to = i % 2 == 0 ? changed : c.grid;
+      return (long)CSpace::updateCSpace(from, to, CSPACE_THRESHOLD, CSPACE_RADIUS, cspace, field);
+    }, "cells/s");
+  });
+}
+
+int main(int argc, char **argv)
+{
+  ros::Time::init();
+
+  // The planners warn on every call, which would end up in the timings
+  if (ros::console::set_logger_level(ROSCONSOLE_DEFAULT_NAME, ros::console::levels::Error))
+    ros::console::notifyLoggerLevelsChanged();
+
+  // Take our own flag out before Google Benchmark sees the arguments
+  std::string corpus;
+  int kept = 1;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (strncmp(argv[i], "--corpus=", 9) == 0)
+      corpus = argv[i] + 9;
+    else
+      argv[kept++] = argv[i];
+  }
+  argc = kept;
+
+  std::vector<std::pair<std::string, OccupancyGrid>> grids = corpus.empty() ? GridCorpus::generated() : GridCorpus::loadDirectory(corpus);
+  if (grids.empty())
+  {
+    fprintf(stderr, "No grids found in %s\n", corpus.c_str());
+    return 1;
+  }
+
+  for (int g = 0; g < grids.size(); ++g)
+  {
+    auto c = std::make_shared<GridCase>();
+    c->name = grids[g].first;
+    c->grid = grids[g].second;
+    c->targets = pickTargets(c->grid, g);
+    if (c->targets.empty())
+    {
+      fprintf(stderr, "Skipping %s, no free cells to plan to\n", c->name.c_str());
+      continue;
+    }
+    registerCases(c);
+  }
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -1,6 +1,29 @@
 #include <gtest/gtest.h>
 #include <ros/ros.h>
+#include <astar.h>
 #include <cspace.h>
+#include <cspace_kernels.h>
+#include <indexed_heap.h>
+#include <jps.h>
+#include <dstar_lite.h>
+#include <hpa_star.h>
+#include <theta_star.h>
+#include <multi_goal.h>
+#include <hybrid_astar.h>
+#include <cooperative_planner.h>
+#include <path_smoother.h>
+#include <terrain_astar.h>
+#include <ara_star.h>
+#include <bidirectional_astar.h>
+
+#include <random>
+
+// Exposes the protected helpers of AStar to the tests
+class AStarTestAccess : public AStar
+{
+public:
+  using AStar::getNeighborsIndiciesArray;
+};
 
 // grid index, width, size, expectedSize, std::vector with neighbor indexes
 class NeighborTests : public ::testing::TestWithParam<std::tuple<int, int, int, int, std::vector<int>>>
@@ -22,7 +45,13 @@ TEST_P(NeighborTests, GetsAllNeighborsTest)
   int gridSize = std::get<2>(GetParam());
   int expectedSize = std::get<3>(GetParam());
   std::vector<int> expectedNeighbors = std::get<4>(GetParam());
-  std::vector<int> actualNeighbors = CSpace::get_neighbors_indicies(gridIndex, gridWidth, gridSize);
+  std::array<int, 8> neighborArray = AStarTestAccess::getNeighborsIndiciesArray(gridIndex, gridWidth, gridSize);
+  std::vector<int> actualNeighbors;
+  for (int neighbor : neighborArray)
+  {
+    if (neighbor != -1)
+      actualNeighbors.push_back(neighbor);
+  }
   // This is where we assert everthing                This seems to be how you output messages
   ASSERT_EQ(expectedSize, actualNeighbors.size()) << "Number of Neighbors is not as is expected";
 
@@ -40,7 +69,752 @@ INSTANTIATE_TEST_CASE_P(
     // TESTING VALUES
     ::testing::Values(
         std::make_tuple(12, 5, 25, 8, std::vector<int>{13, 11, 17, 18, 16, 7, 8, 6}),
-        std::make_tuple(12, 5, 40, 8, std::vector<int>{13, 11, 17, 18, 16, 7, 8, 6})));
+        std::make_tuple(12, 5, 40, 8, std::vector<int>{13, 11, 17, 18, 16, 7, 8, 6}),
+        // Cells on the first and last column must not wrap around to the other side of the grid
+        std::make_tuple(4, 5, 25, 3, std::vector<int>{3, 9, 8}),
+        std::make_tuple(5, 5, 25, 5, std::vector<int>{6, 10, 11, 0, 1})));
+
+TEST(IndexedHeapTests, PopsInKeyOrderWithDecreaseKey)
+{
+  IndexedHeap heap;
+  heap.reset(10);
+
+  heap.push(3, 5.0);
+  heap.push(7, 2.0);
+  heap.push(1, 9.0);
+  heap.push(4, 4.0);
+
+  // Pushing a queued index again must update it, not duplicate it
+  heap.push(1, 1.0);
+  ASSERT_EQ(4, heap.size());
+
+  heap.remove(4);
+  ASSERT_FALSE(heap.contains(4));
+
+  std::vector<int> expectedOrder{1, 7, 3};
+  for (int expected : expectedOrder)
+  {
+    ASSERT_EQ(expected, heap.pop()) << "Heap returned indexes out of key order";
+  }
+  ASSERT_TRUE(heap.empty());
+
+  // Reset must forget anything left over from the last search
+  heap.push(2, 1.0);
+  heap.reset(10);
+  ASSERT_FALSE(heap.contains(2));
+}
+
+TEST(JPSTests, FindsPathAroundWall)
+{
+  // 21x21 empty grid with a wall across the middle row, open on the far left
+  nav_msgs::OccupancyGrid grid;
+  grid.info.width = 21;
+  grid.info.height = 21;
+  grid.info.resolution = 1;
+  grid.data.assign(21 * 21, 0);
+  for (int x = 3; x < 21; ++x)
+    grid.data[14 * 21 + x] = 100;
+
+  geometry_msgs::Point target;
+  target.x = 0;
+  target.y = 8;
+
+  SearchSpace space;
+  nav_msgs::Path path = JPS::findPathOccGrid(grid, target, space);
+  ASSERT_GT(path.poses.size(), 0) << "No path found around the wall";
+
+  // The path starts at the target and ends at the robot, same as A*
+  ASSERT_EQ(0, path.poses.front().pose.position.x);
+  ASSERT_EQ(8, path.poses.front().pose.position.y);
+  ASSERT_EQ(0, path.poses.back().pose.position.x);
+  ASSERT_EQ(0, path.poses.back().pose.position.y);
+
+  // No waypoint may be inside the wall
+  for (auto &pose : path.poses)
+  {
+    int index = (pose.pose.position.y + 10) * 21 + (pose.pose.position.x + 10);
+    ASSERT_LT(grid.data[index], 50);
+  }
+
+  // Open terrain should only need a handful of jump points
+  ASSERT_LT(space.expansions(), 30);
+}
+
+TEST(DStarLiteTests, RepairsPathWhenMapChanges)
+{
+  nav_msgs::OccupancyGrid grid;
+  grid.info.width = 21;
+  grid.info.height = 21;
+  grid.info.resolution = 1;
+  grid.data.assign(21 * 21, 0);
+
+  geometry_msgs::Point target;
+  target.x = 0;
+  target.y = 8;
+
+  DStarLite planner;
+  nav_msgs::Path straight = planner.findPathOccGrid(grid, target, {});
+  ASSERT_EQ(2, straight.poses.size()) << "A path across an empty map should be a single straight line";
+
+  // Drop a wall across the straight line path and tell the planner about it
+  std::vector<int> changed;
+  for (int x = 3; x < 21; ++x)
+  {
+    grid.data[14 * 21 + x] = 100;
+    changed.push_back(14 * 21 + x);
+  }
+
+  nav_msgs::Path repaired = planner.findPathOccGrid(grid, target, changed);
+  int repairExpansions = planner.expansions();
+
+  DStarLite fresh;
+  nav_msgs::Path replanned = fresh.findPathOccGrid(grid, target, {});
+
+  // Ties can be broken differently, but the repaired path has to be as short as planning from scratch
+  auto length = [](const nav_msgs::Path &path) {
+    double total = 0;
+    for (int i = 1; i < path.poses.size(); ++i)
+      total += hypot(path.poses[i].pose.position.x - path.poses[i - 1].pose.position.x, path.poses[i].pose.position.y - path.poses[i - 1].pose.position.y);
+    return total;
+  };
+  ASSERT_NEAR(length(replanned), length(repaired), 1e-6);
+
+  for (auto &pose : repaired.poses)
+  {
+    int index = (pose.pose.position.y + 10) * 21 + (pose.pose.position.x + 10);
+    ASSERT_LT(grid.data[index], 50) << "Repaired path goes through the new wall";
+  }
+
+  ASSERT_LE(repairExpansions, fresh.expansions());
+}
+
+TEST(CSpaceTests, DistanceFieldIsExactEuclidean)
+{
+  nav_msgs::OccupancyGrid grid;
+  grid.info.width = 30;
+  grid.info.height = 20;
+  grid.data.assign(30 * 20, 0);
+
+  std::vector<int> obstacles{0, 47, 212, 213, 419, 599};
+  for (int i : obstacles)
+    grid.data[i] = 100;
+  grid.data[300] = -1;
+
+  std::vector<float> field = CSpace::getDistanceField(grid, 50);
+  for (int i = 0; i < grid.data.size(); ++i)
+  {
+    double expected = INFINITY;
+    for (int o : obstacles)
+      expected = std::min(expected, hypot(i % 30 - o % 30, i / 30 - o / 30));
+
+    ASSERT_NEAR(expected, field[i], 1e-4) << "Wrong distance at index " << i;
+  }
+
+  nav_msgs::OccupancyGrid padded = CSpace::getCSpace(grid, 50, 3);
+  for (int i = 0; i < grid.data.size(); ++i)
+  {
+    if (field[i] <= 3)
+      ASSERT_EQ(100, padded.data[i]);
+    else
+      ASSERT_EQ(0, padded.data[i]) << "Unknown cells outside the padding should be free";
+  }
+}
+
+TEST(CSpaceTests, VectorKernelsMatchScalar)
+{
+  // Odd length so the scalar tail of the vector kernels runs too
+  const int n = 1001;
+  std::vector<int8_t> src(n), other(n);
+  std::vector<float> distance(n);
+  for (int i = 0; i < n; ++i)
+  {
+    src[i] = (i % 7 == 0) ? -1 : (i * 37) % 101;
+    other[i] = (i * 13) % 101;
+    distance[i] = (i % 11 == 0) ? INFINITY : (i % 23) * 0.5f;
+  }
+
+  const CSpaceKernels::Table &scalar = CSpaceKernels::get(CSpaceKernels::SCALAR);
+  for (CSpaceKernels::Isa isa : {CSpaceKernels::SSE41, CSpaceKernels::AVX2})
+  {
+    const CSpaceKernels::Table &kernels = CSpaceKernels::get(isa);
+    std::vector<uint8_t> expectedMask(n), actualMask(n);
+    std::vector<int8_t> expected(n), actual(n);
+
+    scalar.obstacleMask(src.data(), expectedMask.data(), n, 50);
+    kernels.obstacleMask(src.data(), actualMask.data(), n, 50);
+    ASSERT_EQ(expectedMask, actualMask) << CSpaceKernels::name(kernels.isa) << " obstacleMask differs";
+
+    scalar.padFromDistance(src.data(), distance.data(), expected.data(), n, 50, 8);
+    kernels.padFromDistance(src.data(), distance.data(), actual.data(), n, 50, 8);
+    ASSERT_EQ(expected, actual) << CSpaceKernels::name(kernels.isa) << " padFromDistance differs";
+
+    scalar.maxFilterRow(src.data(), expected.data(), n, 8);
+    kernels.maxFilterRow(src.data(), actual.data(), n, 8);
+    ASSERT_EQ(expected, actual) << CSpaceKernels::name(kernels.isa) << " maxFilterRow differs";
+
+    scalar.maxRows(src.data(), other.data(), expected.data(), n);
+    kernels.maxRows(src.data(), other.data(), actual.data(), n);
+    ASSERT_EQ(expected, actual) << CSpaceKernels::name(kernels.isa) << " maxRows differs";
+  }
+}
+
+TEST(CSpaceTests, IncrementalUpdateMatchesFullInflation)
+{
+  nav_msgs::OccupancyGrid before;
+  before.info.width = 100;
+  before.info.height = 80;
+  before.data.assign(100 * 80, 0);
+  for (int i = 0; i < before.data.size(); i += 97)
+    before.data[i] = 100;
+
+  std::vector<float> field;
+  nav_msgs::OccupancyGrid cspace = CSpace::getCSpace(before, 50, 4, field);
+
+  // A new obstacle, a removed one, and an unknown cell that doesn't change the obstacles at all
+  nav_msgs::OccupancyGrid after = before;
+  after.data[40 * 100 + 60] = 100;
+  after.data[97 * 30] = 0;
+  after.data[5] = -1;
+
+  int recomputed = CSpace::updateCSpace(before, after, 50, 4, cspace, field);
+  EXPECT_LT(recomputed, after.data.size());
+
+  std::vector<float> expectedField;
+  nav_msgs::OccupancyGrid expected = CSpace::getCSpace(after, 50, 4, expectedField);
+  ASSERT_EQ(expected.data, cspace.data);
+  for (int i = 0; i < field.size(); ++i)
+  {
+    if (expectedField[i] <= 4)
+      ASSERT_FLOAT_EQ(expectedField[i], field[i]) << "Wrong distance at index " << i;
+    else
+      ASSERT_GT(field[i], 4) << "Wrong distance at index " << i;
+  }
+}
+
+TEST(CSpaceTests, DilatedGridMatchesSquareMax)
+{
+  const int width = 37, height = 23;
+  nav_msgs::OccupancyGrid grid;
+  grid.info.width = width;
+  grid.info.height = height;
+
+  // Fixed seed, so a failure can be reproduced
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int> value(-1, 100);
+  for (int i = 0; i < width * height; ++i)
+    grid.data.push_back(value(generator));
+
+  // 0 leaves the grid as it is, and 15 is wider than the grid is high, so windows get cut off on both sides
+  for (int radius : {0, 1, 3, 15})
+  {
+    nav_msgs::OccupancyGrid dilated = CSpace::getDilatedGrid(grid, radius);
+    ASSERT_EQ(grid.data.size(), dilated.data.size());
+
+    for (int y = 0; y < height; ++y)
+    {
+      for (int x = 0; x < width; ++x)
+      {
+        int expected = -128;
+        for (int wy = std::max(0, y - radius); wy <= std::min(height - 1, y + radius); ++wy)
+          for (int wx = std::max(0, x - radius); wx <= std::min(width - 1, x + radius); ++wx)
+            expected = std::max<int>(expected, grid.data[wy * width + wx]);
+
+        ASSERT_EQ(expected, dilated.data[y * width + x]) << "Wrong value at (" << x << ", " << y << ") with radius " << radius;
+      }
+    }
+  }
+}
+
+TEST(HPAStarTests, RoutesAroundWallOutsideLocalGrid)
+{
+  // 40 m arena with a wall at x = 5 m, only open at the top
+  HPAStar hpa(40, 0.5, 10);
+  nav_msgs::OccupancyGrid arena;
+  arena.info.width = 800;
+  arena.info.height = 800;
+  arena.info.resolution = 0.05;
+  arena.data.assign(800 * 800, 0);
+  for (int y = 0; y < 700; ++y)
+    for (int x = 500; x < 510; ++x)
+      arena.data[y * 800 + x] = 100;
+
+  geometry_msgs::Pose robot;
+  robot.orientation.w = 1;
+  hpa.updateGlobalMap(arena, robot);
+
+  // 5 m local grid around the robot, the target is 10 m away on the other side of the wall
+  nav_msgs::OccupancyGrid local;
+  local.info.width = 100;
+  local.info.height = 100;
+  local.info.resolution = 0.05;
+  local.data.assign(100 * 100, 0);
+
+  geometry_msgs::Point target;
+  target.x = 200;
+  target.y = 0;
+  nav_msgs::Path path = hpa.findPathOccGrid(local, target, robot);
+
+  ASSERT_GT(path.poses.size(), 2);
+  EXPECT_NEAR(10, path.poses.front().pose.position.x, 1e-6);
+  EXPECT_NEAR(0, path.poses.front().pose.position.y, 1e-6);
+
+  // The route has to go through the gap above the wall
+  double highest = -INFINITY;
+  for (const geometry_msgs::PoseStamped &pose : path.poses)
+    highest = std::max(highest, pose.pose.position.y);
+  EXPECT_GT(highest, 15);
+}
+
+TEST(ThetaStarTests, CutsStraightAcrossOpenSpace)
+{
+  nav_msgs::OccupancyGrid grid;
+  grid.info.width = 60;
+  grid.info.height = 60;
+  grid.info.resolution = 1;
+  grid.data.assign(60 * 60, 0);
+
+  // Any angle, so open space is a single straight line from the robot to the target
+  geometry_msgs::Point target;
+  target.x = 20;
+  target.y = 7;
+  nav_msgs::Path path = ThetaStar::findPathOccGrid(grid, target);
+  ASSERT_EQ(2, path.poses.size());
+
+  // A wall in the way only adds the turns around its end
+  for (int y = 10; y < 50; ++y)
+    grid.data[y * 60 + 40] = 100;
+  target.y = 0;
+  path = ThetaStar::findPathOccGrid(grid, target);
+  ASSERT_EQ(4, path.poses.size());
+  EXPECT_EQ(20, path.poses.front().pose.position.x);
+  EXPECT_EQ(0, path.poses.back().pose.position.x);
+  for (const geometry_msgs::PoseStamped &pose : path.poses)
+    EXPECT_NE(10, pose.pose.position.x) << "Waypoint inside the wall";
+}
+
+TEST(MultiGoalTests, CostMatrixMatchesSingleSweeps)
+{
+  nav_msgs::OccupancyGrid grid;
+  grid.info.width = 50;
+  grid.info.height = 50;
+  grid.info.resolution = 1;
+  grid.data.assign(50 * 50, 0);
+  for (int y = 0; y < 40; ++y)
+    grid.data[y * 50 + 25] = 100;
+
+  // The last start and goal are walled in together
+  std::vector<int> starts = {5 * 50 + 5, 30 * 50 + 10, 44 * 50 + 43};
+  std::vector<int> goals = {5 * 50 + 45, 20 * 50 + 5, 0 * 50 + 26, 44 * 50 + 44};
+  for (int x = 42; x <= 46; ++x)
+    grid.data[42 * 50 + x] = grid.data[46 * 50 + x] = grid.data[x * 50 + 42] = grid.data[x * 50 + 46] = 100;
+
+  std::vector<std::vector<int>> paths;
+  std::vector<double> costs = MultiGoal::costMatrix(grid, starts, goals, &paths);
+  ASSERT_EQ(starts.size() * goals.size(), costs.size());
+
+  for (int i = 0; i < (int)starts.size(); ++i)
+  {
+    for (int j = 0; j < (int)goals.size(); ++j)
+    {
+      // Same as planning each pair on its own, both ways
+      std::vector<double> single = MultiGoal::costMatrix(grid, {starts[i]}, {goals[j]}, nullptr);
+      EXPECT_DOUBLE_EQ(single[0], costs[i * goals.size() + j]);
+      std::vector<double> reverse = MultiGoal::costMatrix(grid, {goals[j]}, {starts[i]}, nullptr);
+      EXPECT_DOUBLE_EQ(reverse[0], costs[i * goals.size() + j]);
+
+      const std::vector<int> &path = paths[i * goals.size() + j];
+      if (costs[i * goals.size() + j] == INFINITY)
+      {
+        EXPECT_TRUE(path.empty());
+        continue;
+      }
+      ASSERT_FALSE(path.empty());
+      EXPECT_EQ(starts[i], path.front());
+      EXPECT_EQ(goals[j], path.back());
+    }
+  }
+
+  EXPECT_EQ(INFINITY, costs[0 * goals.size() + 3]);
+  EXPECT_EQ(INFINITY, costs[2 * goals.size() + 0]);
+  EXPECT_DOUBLE_EQ(1, costs[2 * goals.size() + 3]);
+}
+
+TEST(ReedsSheppTests, EndsOnTheGoalPose)
+{
+  double poses[][6] = {{0, 0, 0, 5, 0, 0}, {0, 0, 0, 0, 0, M_PI}, {0, 0, 0, -3, 1, 0.5}, {1, 2, -2, -4, 3, 2.5}};
+  for (const auto &p : poses)
+  {
+    ReedsShepp::Path path = ReedsShepp::shortestPath(p[0], p[1], p[2], p[3], p[4], p[5], 1.5);
+    ASSERT_LT(path.length(), INFINITY);
+    EXPECT_GE(path.length() * 1.5, hypot(p[3] - p[0], p[4] - p[1]) - 1e-9);
+
+    std::vector<ReedsShepp::Sample> samples;
+    ReedsShepp::sample(path, p[0], p[1], p[2], 1.5, 0.1, samples);
+    EXPECT_NEAR(p[3], samples.back().x, 1e-6);
+    EXPECT_NEAR(p[4], samples.back().y, 1e-6);
+    EXPECT_NEAR(0, remainder(p[5] - samples.back().yaw, 2 * M_PI), 1e-6);
+  }
+
+  // Straight ahead is just a straight line
+  ReedsShepp::Path straight = ReedsShepp::shortestPath(0, 0, 0, 5, 0, 0, 1.5);
+  EXPECT_NEAR(5, straight.length() * 1.5, 1e-9);
+}
+
+TEST(HybridAStarTests, TurnsAroundWithoutStopping)
+{
+  nav_msgs::OccupancyGrid grid;
+  grid.info.width = 200;
+  grid.info.height = 200;
+  grid.info.resolution = 0.05;
+  grid.data.assign(200 * 200, 0);
+
+  // A wall beside the robot, and a target behind it that has to be reached facing back towards the robot
+  for (int x = 60; x < 160; ++x)
+    grid.data[120 * 200 + x] = 100;
+  geometry_msgs::Pose target;
+  target.position.x = -40;
+  target.position.y = 40;
+  target.orientation.z = 1;
+
+  nav_msgs::Path path = HybridAStar::findPathOccGrid(grid, target);
+  ASSERT_GT(path.poses.size(), 2);
+  EXPECT_NEAR(-2, path.poses.front().pose.position.x, 1e-6);
+  EXPECT_NEAR(2, path.poses.front().pose.position.y, 1e-6);
+  EXPECT_NEAR(1, fabs(path.poses.front().pose.orientation.z), 1e-6);
+
+  for (int i = 1; i < (int)path.poses.size(); ++i)
+  {
+    const geometry_msgs::Point &a = path.poses[i - 1].pose.position, &b = path.poses[i].pose.position;
+    EXPECT_GT(hypot(a.x - b.x, a.y - b.y), 0.01) << "Turned in place at pose " << i;
+
+    int x = lround(a.x / 0.05) + 100, y = lround(a.y / 0.05) + 100;
+    EXPECT_LT(grid.data[y * 200 + x], 50) << "Pose " << i << " is inside the wall";
+  }
+}
+
+TEST(CooperativePlannerTests, CrossingRobotsKeepApart)
+{
+  nav_msgs::OccupancyGrid grid;
+  grid.info.width = 60;
+  grid.info.height = 60;
+  grid.info.resolution = 0.5;
+  grid.data.assign(60 * 60, 0);
+
+  // Two robots crossing in the middle at the same time, the first one has priority
+  std::vector<int> starts = {30 * 60 + 5, 5 * 60 + 30};
+  std::vector<int> goals = {30 * 60 + 55, 55 * 60 + 30};
+  ThreadPool pool(2);
+  std::vector<std::vector<int>> paths = CooperativePlanner::planPaths(grid, starts, goals, pool, 2, 64);
+  ASSERT_EQ(2, paths.size());
+
+  for (int r = 0; r < 2; ++r)
+  {
+    ASSERT_FALSE(paths[r].empty());
+    EXPECT_EQ(starts[r], paths[r].front());
+    EXPECT_EQ(goals[r], paths[r].back());
+    for (int t = 1; t < (int)paths[r].size(); ++t)
+    {
+      int a = paths[r][t - 1], b = paths[r][t];
+      EXPECT_LE(std::max(abs(a % 60 - b % 60), abs(a / 60 - b / 60)), 1) << "Robot " << r << " jumped at step " << t;
+    }
+  }
+
+  // The first robot keeps its straight path
+  EXPECT_EQ(51, paths[0].size());
+
+  int steps = std::max(paths[0].size(), paths[1].size());
+  for (int t = 0; t < steps; ++t)
+  {
+    int a = paths[0][std::min(t, (int)paths[0].size() - 1)], b = paths[1][std::min(t, (int)paths[1].size() - 1)];
+    EXPECT_GT(std::max(abs(a % 60 - b % 60), abs(a / 60 - b / 60)), 2) << "Robots too close at step " << t;
+  }
+}
+
+TEST(CooperativePlannerTests, LowerPrioritiesDontChangeTheHigherOnes)
+{
+  nav_msgs::OccupancyGrid grid;
+  grid.info.width = 40;
+  grid.info.height = 40;
+  grid.info.resolution = 0.5;
+  grid.data.assign(40 * 40, 0);
+
+  // Two robots head on, and two more driving alongside the second one, right where it would go around the first
+  std::vector<int> starts = {20 * 40 + 5, 20 * 40 + 33, 23 * 40 + 33, 17 * 40 + 33};
+  std::vector<int> goals = {20 * 40 + 30, 20 * 40 + 2, 23 * 40 + 2, 17 * 40 + 2};
+  ThreadPool pool(2);
+  std::vector<std::vector<int>> all = CooperativePlanner::planPaths(grid, starts, goals, pool, 1, 64);
+
+  starts.resize(2);
+  goals.resize(2);
+  std::vector<std::vector<int>> first = CooperativePlanner::planPaths(grid, starts, goals, pool, 1, 64);
+
+  // The robots alongside come later, so they have to make way, not the second robot
+  ASSERT_EQ(4, all.size());
+  EXPECT_EQ(first[0], all[0]);
+  EXPECT_EQ(first[1], all[1]);
+}
+
+TEST(PathSmootherTests, SmoothPathStaysFreeAndKeepsToTheLimits)
+{
+  nav_msgs::OccupancyGrid grid;
+  grid.info.width = 200;
+  grid.info.height = 200;
+  grid.info.resolution = 0.05;
+  grid.data.assign(200 * 200, 0);
+
+  // A wall across the map with a gap at one end, so the path has to turn twice
+  for (int x = 0; x < 170; ++x)
+    grid.data[120 * 200 + x] = 100;
+  geometry_msgs::Point target;
+  target.x = -60;
+  target.y = 60;
+
+  // Planned and smoothed on the padded map like the server does, the smoothed path has to keep clear of the wall itself
+  nav_msgs::OccupancyGrid padded = CSpace::getCSpace(grid, 50, 8);
+  nav_msgs::Path path = AStar::findPathOccGrid(padded, target);
+  ASSERT_GT(path.poses.size(), 2);
+
+  nav_msgs::Path smoothed = PathSmoother::smooth(PathSmoother::shortcut(path, padded), padded, 1.5, 0.5);
+  ASSERT_GT(smoothed.poses.size(), 2);
+  EXPECT_DOUBLE_EQ(path.poses.front().pose.position.x, smoothed.poses.front().pose.position.x);
+  EXPECT_DOUBLE_EQ(path.poses.front().pose.position.y, smoothed.poses.front().pose.position.y);
+  EXPECT_DOUBLE_EQ(path.poses.back().pose.position.x, smoothed.poses.back().pose.position.x);
+  EXPECT_DOUBLE_EQ(path.poses.back().pose.position.y, smoothed.poses.back().pose.position.y);
+
+  for (int i = 1; i < (int)smoothed.poses.size(); ++i)
+  {
+    const geometry_msgs::Point &a = smoothed.poses[i - 1].pose.position, &b = smoothed.poses[i].pose.position;
+    EXPECT_LE(hypot(a.x - b.x, a.y - b.y), 0.5 + 1e-6) << "Gap before pose " << i;
+
+    for (int k = 0; k <= 10; ++k)
+    {
+      int x = lround((a.x + (b.x - a.x) * k / 10) / 0.05) + 100, y = lround((a.y + (b.y - a.y) * k / 10) / 0.05) + 100;
+      EXPECT_LT(grid.data[y * 200 + x], 50) << "Pose " << i << " cuts through the wall";
+    }
+  }
+
+  PathSmoother::Limits limits;
+  limits.max_speed = 1.0;
+  limits.min_speed = 0.3;
+  limits.max_acceleration = 0.5;
+  limits.max_lateral_acceleration = 0.4;
+  limits.min_clearance = 0.4;
+  limits.slow_clearance = 1.5;
+  std::vector<double> speeds = PathSmoother::velocityProfile(smoothed, grid, CSpace::getDistanceField(grid, 50), limits);
+  ASSERT_EQ(smoothed.poses.size(), speeds.size());
+  EXPECT_DOUBLE_EQ(0.3, speeds.front());
+  EXPECT_DOUBLE_EQ(0.3, speeds.back());
+  EXPECT_GT(*std::max_element(speeds.begin(), speeds.end()), 0.3);
+
+  for (int i = 1; i < (int)speeds.size(); ++i)
+  {
+    const geometry_msgs::Point &a = smoothed.poses[i - 1].pose.position, &b = smoothed.poses[i].pose.position;
+    EXPECT_LE(speeds[i], 1.0);
+    EXPECT_LE(fabs(speeds[i] * speeds[i] - speeds[i - 1] * speeds[i - 1]), 2 * 0.5 * hypot(a.x - b.x, a.y - b.y) + 1e-9);
+  }
+}
+
+TEST(TerrainAStarTests, GoesAroundSteepGround)
+{
+  nav_msgs::OccupancyGrid grid;
+  grid.info.width = 100;
+  grid.info.height = 100;
+  grid.info.resolution = 0.1;
+  grid.data.assign(100 * 100, 0);
+
+  // A hill on the straight line to the target, steep on its sides but nowhere too steep to drive
+  std::vector<float> heights(100 * 100);
+  for (int y = 0; y < 100; ++y)
+    for (int x = 0; x < 100; ++x)
+      heights[y * 100 + x] = 0.5 * exp(-((x - 70) * (x - 70) + (y - 50) * (y - 50)) / 128.0);
+
+  nav_msgs::OccupancyGrid costmap = Costmap::obstacleLayer(grid, 50);
+  Costmap::combine(costmap, Costmap::slopeLayer(grid, heights, 0.52, 0.1, 99));
+  EXPECT_LT(*std::max_element(costmap.data.begin(), costmap.data.end()), Costmap::LETHAL_COST);
+
+  // Highest cost along the path and its length
+  auto walk = [&](const nav_msgs::Path &path, double &length) {
+    int highest = 0;
+    length = 0;
+    for (int i = 1; i < (int)path.poses.size(); ++i)
+    {
+      const geometry_msgs::Point &a = path.poses[i - 1].pose.position, &b = path.poses[i].pose.position;
+      length += hypot(a.x - b.x, a.y - b.y);
+      for (int k = 0; k <= 100; ++k)
+      {
+        int x = lround((a.x + (b.x - a.x) * k / 100) / 0.1) + 50, y = lround((a.y + (b.y - a.y) * k / 100) / 0.1) + 50;
+        highest = std::max<int>(highest, costmap.data[y * 100 + x]);
+      }
+    }
+    return highest;
+  };
+
+  geometry_msgs::Point target;
+  target.x = 40;
+  target.y = 0;
+  double straightLength, terrainLength;
+  int straightCost = walk(TerrainAStar::findPathOccGrid(costmap, target, 0), straightLength);
+  int terrainCost = walk(TerrainAStar::findPathOccGrid(costmap, target, 3), terrainLength);
+
+  EXPECT_NEAR(4, straightLength, 1e-6);
+  EXPECT_GT(straightCost, 50);
+  EXPECT_LT(terrainCost, 25);
+  EXPECT_LT(terrainLength, 2 * straightLength);
+}
+
+TEST(ARAStarTests, PathsStayWithinTheBoundUntilOptimal)
+{
+  nav_msgs::OccupancyGrid grid;
+  grid.info.width = 200;
+  grid.info.height = 200;
+  grid.info.resolution = 0.05;
+  grid.data.assign(200 * 200, 0);
+
+  // Scattered rocks, kept away from the robot
+  unsigned seed = 1;
+  for (int rock = 0; rock < 300; ++rock)
+  {
+    seed = seed * 1103515245 + 12345;
+    int x = (seed >> 8) % 200;
+    seed = seed * 1103515245 + 12345;
+    int y = (seed >> 8) % 200;
+    for (int dy = 0; dy < 6 && y + dy < 200; ++dy)
+      for (int dx = 0; dx < 6 && x + dx < 200; ++dx)
+        if (abs(x + dx - 100) >= 3 || abs(y + dy - 100) >= 3)
+          grid.data[(y + dy) * 200 + x + dx] = 100;
+  }
+  geometry_msgs::Point target;
+  target.x = 90;
+  target.y = 90;
+  grid.data[190 * 200 + 190] = 0;
+
+  ARAStar optimal;
+  optimal.start(grid, target, 1, 0);
+  ASSERT_TRUE(optimal.improve(grid, ros::WallTime::now() + ros::WallDuration(60)));
+  ASSERT_FALSE(optimal.path().poses.empty());
+  EXPECT_DOUBLE_EQ(1, optimal.epsilon());
+
+  // A deadline that has already passed still lets every call make some progress
+  ARAStar anytime;
+  anytime.start(grid, target, 3, 0.5);
+  double lastEpsilon = INFINITY;
+  int firstPathExpansions = -1;
+  while (!anytime.improve(grid, ros::WallTime::now()))
+  {
+    if (!anytime.path().poses.empty())
+    {
+      if (firstPathExpansions == -1)
+        firstPathExpansions = anytime.expansions();
+      EXPECT_LE(anytime.epsilon(), lastEpsilon);
+      EXPECT_LE(anytime.cost(), anytime.epsilon() * optimal.cost() + 1e-9);
+      lastEpsilon = anytime.epsilon();
+    }
+  }
+
+  // The first path comes much sooner than the shortest one
+  EXPECT_GT(firstPathExpansions, 0);
+  EXPECT_LT(firstPathExpansions, optimal.expansions() / 2);
+  EXPECT_DOUBLE_EQ(1, anytime.epsilon());
+  EXPECT_NEAR(optimal.cost(), anytime.cost(), 1e-9);
+}
+
+TEST(BidirectionalAStarTests, MatchesTheShortestPath)
+{
+  nav_msgs::OccupancyGrid grid;
+  grid.info.width = 200;
+  grid.info.height = 200;
+  grid.info.resolution = 0.05;
+  grid.data.assign(200 * 200, 0);
+
+  // Scattered rocks, kept away from the robot
+  unsigned seed = 7;
+  for (int rock = 0; rock < 300; ++rock)
+  {
+    seed = seed * 1103515245 + 12345;
+    int x = (seed >> 8) % 200;
+    seed = seed * 1103515245 + 12345;
+    int y = (seed >> 8) % 200;
+    for (int dy = 0; dy < 6 && y + dy < 200; ++dy)
+      for (int dx = 0; dx < 6 && x + dx < 200; ++dx)
+        if (abs(x + dx - 100) >= 3 || abs(y + dy - 100) >= 3)
+          grid.data[(y + dy) * 200 + x + dx] = 100;
+  }
+
+  for (int t = 0; t < 10; ++t)
+  {
+    seed = seed * 1103515245 + 12345;
+    geometry_msgs::Point target;
+    target.x = (int)((seed >> 8) % 200) - 100;
+    target.y = (int)((seed >> 16) % 200) - 100;
+    if (grid.data[(target.y + 100) * 200 + target.x + 100] != 0)
+      continue;
+
+    // ARA* with a bound of 1 is plain A* with the same moves and costs
+    ARAStar reference;
+    reference.start(grid, target, 1, 0);
+    reference.improve(grid, ros::WallTime::now() + ros::WallDuration(60));
+
+    nav_msgs::Path path = BidirectionalAStar::findPathOccGrid(grid, target);
+    if (reference.path().poses.empty())
+    {
+      EXPECT_TRUE(path.poses.empty());
+      continue;
+    }
+
+    ASSERT_GE(path.poses.size(), 2);
+    EXPECT_NEAR(target.x * 0.05, path.poses.front().pose.position.x, 1e-6);
+    EXPECT_NEAR(target.y * 0.05, path.poses.front().pose.position.y, 1e-6);
+    EXPECT_NEAR(0, path.poses.back().pose.position.x, 1e-6);
+    EXPECT_NEAR(0, path.poses.back().pose.position.y, 1e-6);
+
+    double length = 0;
+    for (int i = 1; i < (int)path.poses.size(); ++i)
+      length += hypot(path.poses[i].pose.position.x - path.poses[i - 1].pose.position.x, path.poses[i].pose.position.y - path.poses[i - 1].pose.position.y);
+    EXPECT_NEAR(reference.cost(), length / 0.05, 1e-4) << "Target " << target.x << ", " << target.y;
+  }
+}
+
+TEST(AStarTests, DoesNotWrapAroundTheGridEdges)
+{
+  // 21x21 grid with a wall down the second column, so the first column can only be reached across the grid edge
+  nav_msgs::OccupancyGrid grid;
+  grid.info.width = 21;
+  grid.info.height = 21;
+  grid.info.resolution = 1;
+  grid.data.assign(21 * 21, 0);
+  for (int y = 0; y < 21; ++y)
+    grid.data[y * 21 + 1] = 100;
+
+  geometry_msgs::Point target;
+  target.x = -10;
+  target.y = 0;
+  ASSERT_EQ(0, AStar::findPathOccGrid(grid, target).poses.size()) << "Path stepped across the edge of the grid";
+
+  // The last column is still reachable, and the path still starts at the target and ends at the robot
+  target.x = 10;
+  nav_msgs::Path path = AStar::findPathOccGrid(grid, target);
+  ASSERT_EQ(2, path.poses.size());
+  ASSERT_EQ(10, path.poses.front().pose.position.x);
+  ASSERT_EQ(0, path.poses.back().pose.position.x);
+}
+
+TEST(AStarTests, RoundsFractionalTargetsToTheNearestCell)
+{
+  nav_msgs::OccupancyGrid grid;
+  grid.info.width = 21;
+  grid.info.height = 21;
+  grid.info.resolution = 1;
+  grid.data.assign(21 * 21, 0);
+
+  // Half a row too many would put the target on the other side of the grid
+  geometry_msgs::Point target;
+  target.x = 3;
+  target.y = 2.4;
+  nav_msgs::Path path = AStar::findPathOccGrid(grid, target);
+  ASSERT_GT(path.poses.size(), 0);
+  ASSERT_EQ(3, path.poses.front().pose.position.x);
+  ASSERT_EQ(2, path.poses.front().pose.position.y);
+}
 
 // Run all the tests that were declared with TEST()
 int main(int argc, char **argv)
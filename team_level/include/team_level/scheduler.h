@@ -2,12 +2,14 @@
 
 #include <ros/ros.h>
 #include <utils/common_names.h>
-#include <mutex>
+#include <utils/pose_store.h>
 #include <vector>
 #include <state_machines/RobotStateMachineTaskAction.h>
 #include <actionlib/client/simple_action_client.h>
 #include <nav_msgs/Odometry.h>
 #include <operations/navigation_algorithm.h>
+#include <planning/batch_trajectory.h>
+#include <planning/cooperative_trajectory.h>
 
 using namespace COMMON_NAMES;
 
@@ -47,19 +49,27 @@ private:
   state_machines::RobotStateMachineTaskGoal excavator_goal_;
   state_machines::RobotStateMachineTaskGoal hauler_goal_;
 
-  // variables to keep track of each robot's pose in the team
-  geometry_msgs::PoseStamped scout_pose_;
-  geometry_msgs::PoseStamped excavator_pose_;
-  geometry_msgs::PoseStamped hauler_pose_;
+  // variables to keep track of each robot's pose in the team, written by the odom callbacks and read without locks
+  PoseStore scout_pose_;
+  PoseStore excavator_pose_;
+  PoseStore hauler_pose_;
 
   // robot odom subscribers
   ros::Subscriber scout_odom_sub_;
   ros::Subscriber excavator_odom_sub_;
   ros::Subscriber hauler_odom_sub_;
 
-  std::mutex scout_pose_mutex;
-  std::mutex excavator_pose_mutex;
-  std::mutex hauler_pose_mutex;
+  // batch planner of the robots sent to meeting points, to pick the meeting point they can reach the fastest
+  ros::ServiceClient excavator_planner_client_;
+  ros::ServiceClient hauler_planner_client_;
+
+  // plans the moving robots together, so the hauler isn't sent into the excavator's way
+  ros::ServiceClient cooperative_planner_client_;
+
+  // meeting point the hauler is held back from until hauler_start_time_, while the excavator goes first
+  geometry_msgs::PoseStamped hauler_held_goal_;
+  ros::Time hauler_start_time_;
+  bool hauler_held_ = false;
 
   // variables to hold the desired new tasks to be given to each robot
   STATE_MACHINE_TASK scout_desired_task;
@@ -163,6 +173,31 @@ private:
   void sendRobotGoal(std::string robot_name, RobotClient *robot_client, state_machines::RobotStateMachineTaskGoal &robot_goal, const STATE_MACHINE_TASK task, const geometry_msgs::PoseStamped& goal_loc);
 
 
+  /**
+   * @brief Picks where a robot should meet another one. The candidates are the point on the line between the two
+   *        robots (what getPointCloserToOrigin gives), and points on a circle around the reference robot at the same
+   *        distance. The robot's planner gives the cost of reaching all of them in one call, and the cheapest wins.
+   *        Falls back to the point on the line if the planner can't be reached or finds no path at all.
+   * 
+   * @param planner_client  Batch trajectory client of the robot to send
+   * @param ref_pose        Pose of the robot to meet
+   * @param self_pose       Pose of the robot to send
+   * @param closer_distance Distance to keep from the reference robot, same as getPointCloserToOrigin
+   * @return geometry_msgs::Pose The meeting point
+   */
+  geometry_msgs::Pose getMeetingPoint(ros::ServiceClient &planner_client, const geometry_msgs::PoseStamped &ref_pose, const geometry_msgs::PoseStamped &self_pose, const double closer_distance);
+
+  /**
+   * @brief How long the last robot should wait before it starts driving, so it keeps clear of the others.
+   *        The robots are planned together in priority order, and the wait is how long the last one stays on its
+   *        start in its cooperative path. No wait if the planner can't be reached or has no path for it.
+   * 
+   * @param starts  Pose of each robot, in priority order
+   * @param goals   Goal of each robot, its pose if it stays where it is
+   * @return ros::Duration The wait
+   */
+  ros::Duration getStartDelay(const std::vector<geometry_msgs::PoseStamped> &starts, const std::vector<geometry_msgs::PoseStamped> &goals);
+
   /**
    * @brief Sends the scout_desired_goal to scout state machine actionlib
    * 
@@ -22,6 +22,10 @@ void Scheduler::initTeam(const int team_number)
   excavator_odom_sub_ = nh_.subscribe(CAPRICORN_TOPIC + EXCAVATOR + CHEAT_ODOM_TOPIC, 1000, &Scheduler::updateExcavatorPose, this);
   hauler_odom_sub_ = nh_.subscribe(CAPRICORN_TOPIC + HAULER + CHEAT_ODOM_TOPIC, 1000, &Scheduler::updateHaulerPose, this);
 
+  excavator_planner_client_ = nh_.serviceClient<planning::batch_trajectory>(CAPRICORN_TOPIC + EXCAVATOR + "/" + BATCH_TRAJECTORY_SERVICE);
+  hauler_planner_client_ = nh_.serviceClient<planning::batch_trajectory>(CAPRICORN_TOPIC + HAULER + "/" + BATCH_TRAJECTORY_SERVICE);
+  cooperative_planner_client_ = nh_.serviceClient<planning::cooperative_trajectory>(CAPRICORN_TOPIC + HAULER + "/" + COOPERATIVE_TRAJECTORY_SERVICE);
+
   initClients();
 }
 
@@ -170,10 +174,9 @@ void Scheduler::sendExcavatorGoal(const STATE_MACHINE_TASK task)
 {
   if (task == EXCAVATOR_GO_TO_LOC)
   {
-    std::lock_guard<std::mutex> lock(scout_pose_mutex);
     geometry_msgs::PoseStamped excavator_goal_pose;
     excavator_goal_pose.header.frame_id = MAP;
-    excavator_goal_pose.pose =  NavigationAlgo::getPointCloserToOrigin(scout_pose_.pose, excavator_pose_.pose, 5.0);
+    excavator_goal_pose.pose = getMeetingPoint(excavator_planner_client_, scout_pose_.get(), excavator_pose_.get(), 5.0);
     
     sendRobotGoal(EXCAVATOR, excavator_client_, excavator_goal_, task, excavator_goal_pose);
   }
@@ -185,19 +188,122 @@ void Scheduler::sendHaulerGoal(const STATE_MACHINE_TASK task)
 {
   if (task == HAULER_GO_TO_LOC)
   {
-    std::lock_guard<std::mutex> lock(excavator_pose_mutex);
+    if (hauler_goal_.task == task)
+      return;
 
-    bool excavator_waiting = (excavator_goal_.task == EXCAVATOR_PARK_AND_PUB);
+    // the meeting point is planned once, then the hauler waits there until the excavator is out of its way
+    if (!hauler_held_)
+    {
+      bool excavator_waiting = (excavator_goal_.task == EXCAVATOR_PARK_AND_PUB);
 
-    geometry_msgs::PoseStamped hauler_goal_pose;
-    geometry_msgs::PoseStamped ref_pose = excavator_waiting ? excavator_pose_ : scout_pose_;
-    hauler_goal_pose.header.frame_id = MAP;
-    hauler_goal_pose.pose =  NavigationAlgo::getPointCloserToOrigin(ref_pose.pose, hauler_pose_.pose, -5.0);
-    
-    sendRobotGoal(HAULER, hauler_client_, hauler_goal_, task, hauler_goal_pose);
+      geometry_msgs::PoseStamped ref_pose = excavator_waiting ? excavator_pose_.get() : scout_pose_.get();
+      hauler_held_goal_.header.frame_id = MAP;
+      hauler_held_goal_.pose = getMeetingPoint(hauler_planner_client_, ref_pose, hauler_pose_.get(), -5.0);
+
+      // the scout stays where it is and the excavator has right of way, the hauler goes last
+      geometry_msgs::PoseStamped excavator_goal = excavator_pose_.get();
+      if (excavator_goal_.task == EXCAVATOR_GO_TO_LOC && !excavator_task_completed_)
+        excavator_goal = excavator_goal_.goal_loc;
+
+      hauler_start_time_ = ros::Time::now() + getStartDelay({scout_pose_.get(), excavator_pose_.get(), hauler_pose_.get()},
+                                                            {scout_pose_.get(), excavator_goal, hauler_held_goal_});
+      hauler_held_ = true;
+    }
+
+    if (ros::Time::now() < hauler_start_time_)
+      return;
+
+    hauler_held_ = false;
+    sendRobotGoal(HAULER, hauler_client_, hauler_goal_, task, hauler_held_goal_);
   }
   else
-  sendRobotGoal(HAULER, hauler_client_, hauler_goal_, task);
+  {
+    hauler_held_ = false;
+    sendRobotGoal(HAULER, hauler_client_, hauler_goal_, task);
+  }
+}
+
+ros::Duration Scheduler::getStartDelay(const std::vector<geometry_msgs::PoseStamped> &starts, const std::vector<geometry_msgs::PoseStamped> &goals)
+{
+  planning::cooperative_trajectory srv;
+  srv.request.starts = starts;
+  srv.request.goals = goals;
+
+  if (!cooperative_planner_client_.call(srv) || srv.response.paths.size() != starts.size())
+  {
+    ROS_WARN("SCHEDULER : Cooperative planner not available, not waiting for the other robots");
+    return ros::Duration(0);
+  }
+
+  // goal first and start last, a wait on the start shows up as the next pose at the same place
+  const std::vector<geometry_msgs::PoseStamped> &path = srv.response.paths.back().poses;
+  if (path.empty())
+  {
+    ROS_WARN("SCHEDULER : No cooperative path, not waiting for the other robots");
+    return ros::Duration(0);
+  }
+
+  const geometry_msgs::PoseStamped &start = path.back();
+  ros::Time leaves = start.header.stamp;
+  for (int i = path.size() - 2; i >= 0; i--)
+  {
+    if (path[i].pose.position.x != start.pose.position.x || path[i].pose.position.y != start.pose.position.y)
+      break;
+    leaves = path[i].header.stamp;
+  }
+
+  ROS_INFO_STREAM("SCHEDULER : Waiting " << (leaves - start.header.stamp).toSec() << "s for the other robots");
+  return leaves - start.header.stamp;
+}
+
+geometry_msgs::Pose Scheduler::getMeetingPoint(ros::ServiceClient &planner_client, const geometry_msgs::PoseStamped &ref_pose, const geometry_msgs::PoseStamped &self_pose, const double closer_distance)
+{
+  const int RING_POINTS = 8;
+
+  planning::batch_trajectory srv;
+  srv.request.starts.push_back(self_pose);
+  srv.request.return_paths = false;
+
+  geometry_msgs::PoseStamped candidate;
+  candidate.header = self_pose.header;
+  candidate.pose = NavigationAlgo::getPointCloserToOrigin(ref_pose.pose, self_pose.pose, closer_distance);
+  srv.request.goals.push_back(candidate);
+
+  for (int i = 0; i < RING_POINTS; i++)
+  {
+    double theta = 2 * M_PI * i / RING_POINTS;
+    candidate.pose.position.x = ref_pose.pose.position.x + fabs(closer_distance) * cos(theta);
+    candidate.pose.position.y = ref_pose.pose.position.y + fabs(closer_distance) * sin(theta);
+
+    // face the reference robot, like the point on the line
+    tf2::Quaternion quat;
+    quat.setRPY(0, 0, theta + M_PI);
+    tf2::convert(quat, candidate.pose.orientation);
+    srv.request.goals.push_back(candidate);
+  }
+
+  if (!planner_client.call(srv) || srv.response.costs.size() != srv.request.goals.size())
+  {
+    ROS_WARN("SCHEDULER : Batch planner not available, meeting on the line between the robots");
+    return srv.request.goals[0].pose;
+  }
+
+  // ties go to the point on the line, which was the only choice before
+  int best = -1;
+  for (int i = 0; i < (int)srv.response.costs.size(); i++)
+  {
+    if (srv.response.costs[i] >= 0 && (best == -1 || srv.response.costs[i] < srv.response.costs[best]))
+      best = i;
+  }
+
+  if (best == -1)
+  {
+    ROS_WARN("SCHEDULER : No meeting point is reachable, meeting on the line between the robots");
+    return srv.request.goals[0].pose;
+  }
+
+  ROS_INFO_STREAM("SCHEDULER : Meeting point " << best << " costs " << srv.response.costs[best] << "m");
+  return srv.request.goals[best].pose;
 }
 
 void Scheduler::sendRobotGoal(std::string robot_name, RobotClient *robot_client, state_machines::RobotStateMachineTaskGoal &robot_goal, const STATE_MACHINE_TASK task)
@@ -234,9 +340,7 @@ void Scheduler::sendRobotGoal(std::string robot_name, RobotClient *robot_client,
  */
 void Scheduler::updateScoutPose(const nav_msgs::Odometry::ConstPtr &msg)
 {
-  std::lock_guard<std::mutex> lock(scout_pose_mutex);
-  scout_pose_.header = msg->header;
-  scout_pose_.pose = msg->pose.pose;
+  scout_pose_.set(*msg);
 }
 
 
@@ -247,9 +351,7 @@ void Scheduler::updateScoutPose(const nav_msgs::Odometry::ConstPtr &msg)
  */
 void Scheduler::updateExcavatorPose(const nav_msgs::Odometry::ConstPtr &msg)
 {
-  std::lock_guard<std::mutex> lock(excavator_pose_mutex);
-  excavator_pose_.header = msg->header;
-  excavator_pose_.pose = msg->pose.pose;
+  excavator_pose_.set(*msg);
 }
 
 
@@ -260,8 +362,6 @@ void Scheduler::updateExcavatorPose(const nav_msgs::Odometry::ConstPtr &msg)
  */
 void Scheduler::updateHaulerPose(const nav_msgs::Odometry::ConstPtr &msg)
 {
-  std::lock_guard<std::mutex> lock(hauler_pose_mutex);
-  hauler_pose_.header = msg->header;
-  hauler_pose_.pose = msg->pose.pose;
+  hauler_pose_.set(*msg);
 }
 
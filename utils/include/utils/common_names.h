@@ -30,6 +30,8 @@ namespace COMMON_NAMES
   /****** VELOCITY ******/
   const std::string VELOCITY_TOPIC = "/drive/command/velocity";
   const std::string STEERING_TOPIC = "/steer/command/position";
+  // All wheel steering angles and velocities in one message, fanned out to the two topics above by wheel_command_relay
+  const std::string WHEEL_COMMAND_TOPIC = "/wheel_command";
   const std::string DESIRED_VELOCITY = "/desired_velocity";
   const std::string CURRENT_SPEED = "/current_speed";
   const std::string BRAKE_ROVER = "/brake_rover";
@@ -46,6 +48,9 @@ namespace COMMON_NAMES
 
   /****** SERVICES ******/
   const std::string SCOUT_SEARCH_SERVICE = "scout_search";
+  const std::string TRAJECTORY_SERVICE = "trajectoryGenerator";
+  const std::string BATCH_TRAJECTORY_SERVICE = "batchTrajectoryGenerator";
+  const std::string COOPERATIVE_TRAJECTORY_SERVICE = "cooperativeTrajectoryGenerator";
 
   /****** GAZEBO ******/
   const std::string HEIGHTMAP = "heightmap";
@@ -153,6 +158,7 @@ namespace COMMON_NAMES
     REVOLVE, // Revolve the robot around a fixed point
     SPIRAL,  // Archimedean spiral (scout finding volatiles)
     FOLLOW,  // Follow an object in frame
+    PURSUIT, // Trajectory from the planner, tracked continuously with pure pursuit
   };
 
   /****** COMMON RESULTS ENUMS (This is used by every actionlibrary)******/
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <geometry_msgs/Pose.h>
+#include <geometry_msgs/PoseStamped.h>
+#include <nav_msgs/Odometry.h>
+#include <ros/time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+/**
+ * @brief Single writer, many reader sequence lock around a trivially copyable value.
+ *
+ * The writer never waits: it bumps the sequence number to an odd value, writes the value and bumps it back to even.
+ * Readers copy the value and retry if the sequence number was odd or changed while they copied, so they always get a
+ * value from a single write. The value is kept as atomic words, so the concurrent copies are not data races.
+ * Only one thread may call set() at a time, e.g. a subscriber callback.
+ */
+template <typename T>
+class SeqLock
+{
+  static_assert(std::is_trivially_copyable<T>::value, "SeqLock can only hold trivially copyable values");
+
+private:
+  static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+  std::atomic<uint64_t> sequence_{0};
+  std::atomic<uint64_t> words_[WORDS] = {};
+
+public:
+  void set(const T &value)
+  {
+    uint64_t buffer[WORDS] = {};
+    std::memcpy(buffer, &value, sizeof(T));
+
+    uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t i = 0; i < WORDS; ++i)
+      words_[i].store(buffer[i], std::memory_order_relaxed);
+
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  T get() const
+  {
+    uint64_t buffer[WORDS];
+    while (true)
+    {
+      uint64_t before = sequence_.load(std::memory_order_acquire);
+      if (before & 1)
+        continue;
+
+      for (size_t i = 0; i < WORDS; ++i)
+        buffer[i] = words_[i].load(std::memory_order_relaxed);
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence_.load(std::memory_order_relaxed) == before)
+        break;
+    }
+
+    T value;
+    std::memcpy(&value, buffer, sizeof(T));
+    return value;
+  }
+
+  /**
+   * @brief Number of times set() was called
+   */
+  uint64_t count() const
+  {
+    return sequence_.load(std::memory_order_acquire) / 2;
+  }
+};
+
+/**
+ * @brief The latest pose of a robot, written by its odometry callback and read from any thread without locks.
+ *
+ * A PoseStamped holds its frame id in a std::string, which can't be copied by a SeqLock, so the frame id is kept in a
+ * fixed size buffer next to the pose. Frame ids longer than MAX_FRAME_ID characters are cut short.
+ */
+class PoseStore
+{
+public:
+  static constexpr size_t MAX_FRAME_ID = 63;
+
+private:
+  struct Snapshot
+  {
+    geometry_msgs::Pose pose;
+    ros::Time stamp;
+    uint32_t seq;
+    char frame_id[MAX_FRAME_ID + 1];
+  };
+
+  SeqLock<Snapshot> snapshot_;
+
+public:
+  void set(const std_msgs::Header &header, const geometry_msgs::Pose &pose)
+  {
+    Snapshot snapshot;
+    snapshot.pose = pose;
+    snapshot.stamp = header.stamp;
+    snapshot.seq = header.seq;
+
+    size_t length = std::min(header.frame_id.size(), MAX_FRAME_ID);
+    std::memcpy(snapshot.frame_id, header.frame_id.data(), length);
+    snapshot.frame_id[length] = '\0';
+
+    snapshot_.set(snapshot);
+  }
+
+  void set(const geometry_msgs::PoseStamped &pose)
+  {
+    set(pose.header, pose.pose);
+  }
+
+  /**
+   * @brief Stores the pose of an odometry message
+   */
+  void set(const nav_msgs::Odometry &odometry)
+  {
+    set(odometry.header, odometry.pose.pose);
+  }
+
+  /**
+   * @brief A copy of the latest pose, all zeros with an empty frame id before the first one is set
+   */
+  geometry_msgs::PoseStamped get() const
+  {
+    Snapshot snapshot = snapshot_.get();
+
+    geometry_msgs::PoseStamped pose;
+    pose.pose = snapshot.pose;
+    pose.header.stamp = snapshot.stamp;
+    pose.header.seq = snapshot.seq;
+    pose.header.frame_id = snapshot.frame_id;
+    return pose;
+  }
+
+  /**
+   * @brief Number of poses stored so far, to tell whether a new one arrived
+   */
+  uint64_t count() const
+  {
+    return snapshot_.count();
+  }
+};